@@ -44,6 +44,7 @@
 // Datamodel for OUTPUT products
 #include "LE3_2D_MASS_WL_UTILITIES/DmOutput.h"
 #include "LE3_2D_MASS_WL_UTILITIES/DmInput.h"
+#include "LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h"
 #include "ST_DataModelBindings/dpd/le3/wl/twodmass/out/euc-test-le3-wl-twodmass-ConvergencePatch.h"
 
 namespace Euclid {
@@ -74,6 +75,31 @@ public:
    */
     bool extractShearMap(const std::string& shearMap, std::vector<std::vector<double> >& Data,
                          LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+   /**
+    * @brief     It extracts the shear Map from a column-wise catalog, without copying it
+    * @param     <shearMap>, <string> name of the output shearMap
+    * @param     <Data>, <ShearCatalogView<double>> view on the catalog rows
+    * @return    <bool> true if shear map well extracted/created
+   */
+    bool extractShearMap(const std::string& shearMap, const ShearCatalogView<double>& Data,
+                         LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+   /**
+    * @brief     It extracts the shear Map from a column-wise catalog and hands it to the
+    *            background writer, the map being written while the next one is computed
+    * @param     <shearMap>, <string> name of the output shearMap
+    * @param     <Data>, <ShearCatalogView<double>> view on the catalog rows
+    * @param     <writer>, <AsyncWriter> background writer taking the ownership of the map
+    * @return    <bool> true if shear map well extracted/created
+   */
+    bool extractShearMap(const std::string& shearMap, const ShearCatalogView<double>& Data,
+                         LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB, AsyncWriter& writer);
+   /**
+    * @brief     It creates the pixelated shear Map of a column-wise catalog, without writing it
+    * @param     <Data>, <ShearCatalogView<double>> view on the catalog rows
+    * @return    <ShearMap*> the shear map, to be deleted by the caller
+   */
+    LE3_2D_MASS_WL_CARTESIAN::ShearMap* getShearMap(const ShearCatalogView<double>& Data,
+                                                    LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
    /**
     * @brief     It extracts the convergence Map from catalog
     * @param     <convergenceMap>, <string> name of the output convergenceMap
@@ -82,6 +108,23 @@ public:
    */
     bool extractConvergnceMap (const std::string& convergenceMap, std::vector<std::vector<double> >& Data,
                                LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+   /**
+    * @brief     It extracts the convergence Map from catalog and hands it to the background
+    *            writer, so that all the FITS writes of the map maker run in the writer thread
+    * @param     <convergenceMap>, <string> name of the output convergenceMap
+    * @param     <Data>, <std::vector<std::vector<double> >> Catalog data
+    * @param     <writer>, <AsyncWriter> background writer taking the ownership of the map
+    * @return    <bool> true if map is well extracted/created
+   */
+    bool extractConvergnceMap (const std::string& convergenceMap, std::vector<std::vector<double> >& Data,
+                               LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB, AsyncWriter& writer);
+   /**
+    * @brief     It creates the pixelated convergence Map of a catalog, without writing it
+    * @param     <Data>, <std::vector<std::vector<double> >> Catalog data
+    * @return    <ConvergenceMap*> the convergence map, to be deleted by the caller
+   */
+    LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap* getConvergenceMap(std::vector<std::vector<double> >& Data,
+                                                                LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
    /**
     * @brief     This function performs KS mass mapping
     * @param     <shearMap>, <string> name of the shearMap
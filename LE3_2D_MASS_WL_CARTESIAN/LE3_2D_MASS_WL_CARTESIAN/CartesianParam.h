@@ -38,6 +38,12 @@
 
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
+/**
+ * @brief Tile compression of the maps written by GetMap::writeMap:
+ * RICE quantizes the floats before compression, GZIP is lossless
+ */
+enum class MapCompression { NONE = 0, RICE = 1, GZIP = 2 };
+
 /**
  * @class CartesianParam
  * @brief
@@ -284,6 +290,17 @@ public:
   */
   std::string getParaFileType();
 
+  /**
+   * @brief   function to return the tile compression of the output maps
+   * @return  MapCompression::NONE, MapCompression::RICE or MapCompression::GZIP
+  */
+  MapCompression getMapCompression();
+
+  /**
+   * @brief   function to select the tile compression of the output maps
+  */
+  void setMapCompression(MapCompression mapCompression);
+
   /**
   * @brief Returns the value of the RaMax
   */
@@ -324,6 +341,7 @@ std::vector<double> m_zMin;
 int m_nbZBins, m_NInpaint, m_nbScales, m_NItReducedShear, m_nbPatches, m_nbSamples, xbin, ybin, m_Nside;
 long m_removeOffset, m_add_borders, m_ForceBMode, m_EqualVarPerScale, m_balancedBin;
 bool squareMap;
+MapCompression m_mapCompression;
 std::string ExtName, m_ParaFileType;
 
 };  // End of CartesianParam class
@@ -39,6 +39,7 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <memory>
 
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
@@ -69,6 +70,21 @@ public:
   FilterMR(LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap &convMap, bool PositiveCons, bool KillLastScale, bool KillIsol,
               int niter, int FirstScale, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam);
 
+  /**
+  * @brief Constructor of class FilterMR sharing the multiscale entropy lookup tables
+  * @param[in] convMap the input convergence map
+  * @param[in] PositiveCons Apply the positivty constraint
+  * @param[in] KillLastScale Remove the smoothed plane
+  * @param[in] KillIsol suppress isolated pixels
+  * @param[in] niter number of loops in reconstruction iterative process (default is 10)
+  * @param[in] FirstScale used for detection (default is 0)
+  * @param[in] CartesianParam object with input parameters from input parameter file
+  * @param[in] restore ReconstructMR tables built once and shared by all the filtered maps
+  */
+  FilterMR(LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap &convMap, bool PositiveCons, bool KillLastScale, bool KillIsol,
+              int niter, int FirstScale, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam,
+              std::shared_ptr<const LE3_2D_MASS_WL_CARTESIAN::ReconstructMR> restore);
+
   //FilterMR(LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap &convMap,
   //           LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam);
 
@@ -114,7 +130,7 @@ public:
    * @brief Apply the multiscale entropy to correct the wavelet coefficients
    */
   void fixedAlphaFilter(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix> & band, std::vector<double>& TabAlpha,
-                         std::vector<double>& NSigma, LE3_2D_MASS_WL_CARTESIAN::ReconstructMR & restore);
+                         std::vector<double>& NSigma, const LE3_2D_MASS_WL_CARTESIAN::ReconstructMR & restore);
 
   /**
    * @brief perform wavelet reconstruction
@@ -209,6 +225,10 @@ private:
    *  @brief <m_MP>, MatrixProcess object to perfom opertions on image matrix
   */
   LE3_2D_MASS_WL_CARTESIAN::MatrixProcess m_MP;
+  /**
+   *  @brief <m_restore>, lookup tables of the multiscale entropy filter (read only, may be shared)
+  */
+  std::shared_ptr<const LE3_2D_MASS_WL_CARTESIAN::ReconstructMR> m_restore;
 };  // End of FilterMR class
 
 }  // namespace LE3_2D_MASS_WL_CARTESIAN
@@ -86,11 +86,29 @@ public:
  * @brief Constructor of a Map
  * @param[in] filename name of a FITS input file
  * This constructor builds a generic Map from provided FITS input file filename.
- * The provided FITS file should have the image as Primary Header in order to be
- * read properly.
+ * The last image HDU of the file is read, with all its planes.
  */
  GetMap(const std::string& filename);
 
+ /**
+ * @brief Constructor of a Map from a selected image HDU of a FITS file
+ * @param[in] filename name of a FITS input file
+ * @param[in] hduName name (EXTNAME) of the image HDU to read
+ * @param[in] firstPlane index of the first plane to load
+ * @param[in] nbPlanes number of planes to load, 0 to load all the planes from firstPlane
+ * The selected planes are read directly into the map buffer.
+ */
+ GetMap(const std::string& filename, const std::string& hduName, int firstPlane = 0, int nbPlanes = 0);
+
+ /**
+ * @brief Constructor of a Map from a selected image HDU of a FITS file
+ * @param[in] filename name of a FITS input file
+ * @param[in] hduIndex index of the image HDU to read (0 for the Primary)
+ * @param[in] firstPlane index of the first plane to load
+ * @param[in] nbPlanes number of planes to load, 0 to load all the planes from firstPlane
+ */
+ GetMap(const std::string& filename, int hduIndex, int firstPlane = 0, int nbPlanes = 0);
+
  /**
  * @brief Copy constructor of a Map
  * @param[in] copyMap the Map to copy
@@ -235,9 +253,14 @@ public:
  * @brief Saves the map as a FITS file
  * @param[in] filename name of the file where to save the map
  * @param[in] cartesianParam input parameters that used to create map
- * This method saves the map as a FITS file into the provided filename
+ * @param[in] firstPlane first plane of the map to save
+ * @param[in] nbPlanes number of planes to save, 0 for all the planes from firstPlane
+ * This method saves the map as a FITS file into the provided filename. The planes are
+ * written straight from the map buffer, tile compressed as selected by
+ * cartesianParam.getMapCompression()
  **/
- void writeMap(const std::string& filename, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam);
+ void writeMap(const std::string& filename, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam,
+               int firstPlane = 0, int nbPlanes = 0);
 
  /**
  * @brief   writes records to the given header
@@ -260,6 +283,27 @@ public:
  VecRaster<float, 3> createRaster();
 
 protected:
+  /**
+   * @brief applies the Kaiser & Squires kernel on the two first planes of the map
+   * @param[out] array array of dimension sizeXaxis*sizeYaxis*sizeZaxis, planes 0 and 1 are overwritten
+   * @param[in] inverse false to go from convergence to shear, true to go from shear to convergence
+   */
+  void applyKSKernel(double *array, bool inverse) const;
+
+private:
+  /**
+   * @brief reads the image of a FITS file into the map buffer
+   * @param[in] filename name of a FITS input file
+   * @param[in] hduName name of the image HDU, or empty to use hduIndex
+   * @param[in] hduIndex index of the image HDU, or -1 to use the last image HDU of the file
+   * @param[in] firstPlane index of the first plane to load
+   * @param[in] nbPlanes number of planes to load, 0 to load all the planes from firstPlane
+   */
+  void readMap(const std::string& filename, const std::string& hduName, int hduIndex,
+               int firstPlane, int nbPlanes);
+
+protected:
+
   /**
    *  @brief <m_mapValues>, map values
   */
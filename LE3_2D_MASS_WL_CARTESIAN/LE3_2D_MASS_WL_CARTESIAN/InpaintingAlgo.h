@@ -112,9 +112,9 @@ private:
    *  @brief <m_MP>, MatrixProcess object to perfom opertions on image matrix
   */
  MatrixProcess m_MP;
- Matrix applyBoundariesOnWavelets(Matrix input);
+ Matrix applyBoundariesOnWavelets(const Matrix& input);
 
- ConvergenceMap performInversionMask(Matrix kappaE, Matrix kappaB, bool bModeZeros);
+ ConvergenceMap performInversionMask(const Matrix& kappaE, const Matrix& kappaB, bool bModeZeros);
 
 };  // End of InpaintingAlgo class
 
@@ -29,6 +29,8 @@
 #include "LE3_2D_MASS_WL_CARTESIAN/ConvergenceMap.h"
 #include "LE3_2D_MASS_WL_CARTESIAN/ShearMap.h"
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
+#include "LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h"
 #include <utility>
 #include <vector>
 
@@ -54,6 +56,11 @@ public:
  MapMaker(std::vector<std::vector<double> >& inData,
           LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam);
 
+ /**
+  * @brief constructor for a catalog binned chunk by chunk (see startBinning and addCatalogChunk)
+  */
+ MapMaker(LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam);
+
  /**
  * @brief  extract Shear Map
  * @param  Catalog Data
@@ -75,29 +82,96 @@ public:
 
  ConvergenceMap* getConvMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
 
+ /**
+ * @brief  extract Shear Map from a column-wise catalog
+ * @param  data view on the catalog rows
+ * @param  CB bounds of the map
+ */
+ template <typename T>
+ ShearMap* getShearMap(const Euclid::WeakLensing::TwoDMass::ShearCatalogView<T>& data,
+                       LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+
+ /**
+ * @brief  starts the binning of a catalog read by chunks
+ * @param  CB bounds of the map
+ * This method resets the shear, convergence and galaxy count sums
+ */
+ void startBinning(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+
+ /**
+ * @brief  bins a chunk of catalog rows
+ * @param  chunk catalog rows in vectors column-wise (as returned by ReadCatalog)
+ * The rows are added to both the shear and the convergence sums, so that a single
+ * pass over the catalog gives both maps with a memory independent of its size
+ * (a map whose columns were not read is left empty)
+ */
+ void addCatalogChunk(const std::vector<std::vector<double> >& chunk);
+
+ /**
+ * @brief  bins a chunk of rows of a column-wise catalog
+ * @param  chunk view on the catalog rows, the convergence being binned only if kappa is present
+ */
+ template <typename T>
+ void addCatalogChunk(const Euclid::WeakLensing::TwoDMass::ShearCatalogView<T>& chunk);
+
+ /**
+ * @brief  returns the catalog columns (ShearColumns flags) needed to extract a map
+ * @param  type i.e. shear or Convergence
+ * To be given to ReadCatalog::setColumns so that the other columns are not read
+ */
+ static unsigned int getCatalogColumns(const Euclid::WeakLensing::TwoDMass::mapType type);
+
+ /**
+ * @brief  returns the Shear Map of the chunks binned since startBinning
+ */
+ ShearMap* getBinnedShearMap();
+
+ /**
+ * @brief  returns the Convergence Map of the chunks binned since startBinning
+ */
+ ConvergenceMap* getBinnedConvMap();
+
 private:
 
  /**
- * @brief   extract Map (either shear or convergence)
+ * @brief   adds the rows of the catalog data to the sums of the current binning
+ * @param   data view on the catalog rows
+ * @param   shear true to bin the shear columns
+ * @param   convergence true to bin the convergence column
+ */
+ template <typename T>
+ void binRows(const Euclid::WeakLensing::TwoDMass::ShearCatalogView<T>& data, bool shear, bool convergence);
+
+ /**
+ * @brief   normalises the sums of the current binning
  * @param   mapType i.e. shear or Convergece
- * @param   Catalog Data
- * @param   respective Parameters from Parameter file
  * @return  it returns number of galaxies in the map and array of map
- * This method extract the Map from catalog
- * using parameters like min Ra, min Dec, max Ra, max Dec, Pixels values
- * or using parameters like mapSize, mapCenter, pixelSize
  */
-std::pair<long, double*> getMap(const Euclid::WeakLensing::TwoDMass::mapType type,
-                                              LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB);
+ std::pair<long, double*> getBinnedMap(const Euclid::WeakLensing::TwoDMass::mapType type);
+
   /**
-   *  @brief <m_inData>, Catalog Data
+   *  @brief <inputData>, Catalog Data (not copied, nullptr when the catalog is binned by chunks)
   */
-std::vector<std::vector<double> > inputData;
+const std::vector<std::vector<double> >* inputData;
   /**
    *  @brief <cartesianParam>, CartesianParam object with catalog parameters
   */
 LE3_2D_MASS_WL_CARTESIAN::CartesianParam cartesianParam;
 
+  /**
+   *  @brief bounds and projection of the current binning
+  */
+LE3_2D_MASS_WL_CARTESIAN::CoordinateBound m_CB;
+double m_ra0, m_dec0, m_raRange, m_decRange, m_raMin, m_raMax, m_decMin, m_decMax;
+double m_binXSize, m_binYSize;
+std::pair<double, double> m_xyMin;
+
+  /**
+   *  @brief weighted sums of gamma1, gamma2 and kappa, and sum of the weights of each pixel
+  */
+std::vector<double> m_shearSum, m_convSum, m_countSum;
+unsigned int m_galCount, m_selGalCount; //count for galaxies watched and selected
+
 };  // End of MapMaker class
 
 }  // namespace LE3_2D_MASS_WL_CARTESIAN
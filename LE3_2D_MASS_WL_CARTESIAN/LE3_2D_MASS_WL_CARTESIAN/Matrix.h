@@ -35,6 +35,40 @@
 #include <map>
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
+/**
+ * @struct MatrixStatistics
+ * @brief min, max, sum, sum of squares and number of the pixels, computed in a single pass
+ */
+struct MatrixStatistics {
+  double min;
+  double max;
+  double sum;
+  double sumSquare;
+  size_t count;
+
+  /**
+   * @brief get the mean value of the pixels
+   */
+  double getMean() const;
+
+  /**
+   * @brief get the standard deviation of the pixels
+   */
+  double getStandardDeviation() const;
+};
+
+/**
+ * @brief computes min/max/sum/sum of squares/count over an array in one vectorized, OpenMP parallel pass
+ * @param[in] values the input array
+ * @param[in] n the number of values to process
+ * @param[in] stride the distance between two consecutive values in the array (e.g. number of map planes)
+ * @param[in] mask (optional) only values where mask is not zero are used
+ * @param[in] maskStride the distance between two consecutive values in the mask
+ * @return the statistics of the values, sums are compensated (Neumaier) over blocks of pixels
+ */
+MatrixStatistics computeStatistics(const double *values, size_t n, size_t stride = 1,
+                                   const double *mask = nullptr, size_t maskStride = 1);
+
 /**
  * @class Matrix
  * @brief
@@ -63,12 +97,25 @@ public:
  */
   Matrix(const Matrix& copy);
 
+ /**
+  * @brief Move constructor, takes over the pixel buffer of the input Matrix
+  * @param[in] copy the Matrix to move from, left empty (0x0)
+ */
+  Matrix(Matrix&& copy) noexcept;
+
  /**
   * @brief Operator = method
   * @param[in] copy the Image to assign
   * @return a copy of the input image
  */
   Matrix& operator= (const Matrix& copy);
+
+ /**
+  * @brief Move assignment, takes over the pixel buffer of the input Matrix
+  * @param[in] copy the Matrix to move from, left empty (0x0)
+  * @return this Matrix
+ */
+  Matrix& operator= (Matrix&& copy) noexcept;
   /**
     * @brief get the number of pixels on X axis
     * @return the number of pixels on X axis
@@ -85,19 +132,48 @@ public:
    * @brief returns Matrix which is the addition of this and the input image Matrix
    * @param[in] image Matrix the image to add to this
    */
-  Matrix add(Matrix image);
+  Matrix add(const Matrix& image) const;
 
   /**
    * @brief returns an matrix which is the substraction of this and the input image matrix
    * @param[in] image matrix the image to substract to this
    */
-  Matrix substract(Matrix image);
+  Matrix substract(const Matrix& image) const;
 
   /**
    * @brief returns an matrix which is the multiplicator of this and the input factor
    * @param[in] factor the factor to multiply to the image matrix
    */
-  Matrix multiply(double factor);
+  Matrix multiply(double factor) const;
+
+  /**
+   * @brief adds the input image matrix to this one in place
+   * @param[in] image matrix to add, this is left unchanged if the sizes differ
+   * @return this matrix
+   */
+  Matrix& operator+= (const Matrix& image);
+
+  /**
+   * @brief substracts the input image matrix to this one in place
+   * @param[in] image matrix to substract, this is left unchanged if the sizes differ
+   * @return this matrix
+   */
+  Matrix& operator-= (const Matrix& image);
+
+  /**
+   * @brief multiplies this matrix by the input factor in place
+   * @param[in] factor the factor to multiply to the image matrix
+   * @return this matrix
+   */
+  Matrix& operator*= (double factor);
+
+  /**
+   * @brief adds factor*image to this matrix in place in a single pass (this = this + factor*image)
+   * @param[in] image matrix to add, this is left unchanged if the sizes differ
+   * @param[in] factor the factor applied to the image matrix
+   * @return this matrix
+   */
+  Matrix& addMultiply(const Matrix& image, double factor);
 
   /**
    * @brief get the image value at position (x, y)
@@ -127,6 +203,17 @@ public:
    */
   double getStandardDeviation() const;
 
+  /**
+   * @brief get min, max, flux, sum of squares and number of pixels of the image in a single pass
+   */
+  MatrixStatistics getStatistics() const;
+
+  /**
+   * @brief get the statistics of the pixels where the mask is not zero in a single pass
+   * @param[in] mask Matrix of the same size, pixels with mask value 0 are ignored
+   */
+  MatrixStatistics getStatistics(const Matrix& mask) const;
+
   /**
    * @brief set the image value at position (x, y) to value
    * @param[in] x the pixel position on X axis
@@ -154,13 +241,18 @@ public:
   void reset();
   /**
    * @brief returns the double* array containing values of the pixels
-   * @return a double* array of dimension sizeXaxis*sizeYaxis
+   * @return a double* array of dimension sizeXaxis*sizeYaxis, aligned for SIMD (fftw_malloc)
    */
   double* getArray() const;
 
+  /**
+   * @brief returns the number of pixels in the matrix
+   */
+  size_t size() const;
+
 private:
   /**
-   *  @brief <m_values>, matrix values
+   *  @brief <m_values>, matrix values (allocated with fftw_malloc)
   */
  double *m_values;
   /**
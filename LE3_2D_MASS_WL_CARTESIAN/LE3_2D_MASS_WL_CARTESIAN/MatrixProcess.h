@@ -75,7 +75,7 @@ public:
    * @param[in] nbScales the number of scales
    * @return a vector containing the Image of the b spline transformations for each scale
    */
-  std::vector<Matrix> transformBspline(Matrix input, unsigned int nbScales);
+  std::vector<Matrix> transformBspline(const Matrix& input, unsigned int nbScales);
 
   /**
    * @brief applies b spline transformation on a given input image and a given step for holes (algorithm a trous)
@@ -83,14 +83,14 @@ public:
    * @param[in] stepTrou the step defining the hole size for the algorithm
    * @return an image after transformation
    */
-  Matrix smoothBspline(Matrix input, unsigned int stepTrou);
+  Matrix smoothBspline(const Matrix& input, unsigned int stepTrou);
 
   /**
    * @brief reconstructs an image from the vector of images for each scales (returned by the transformBspline method)
    * @param[in] band the input vector of Images for each scales
    * @return an image after reconstruction
    */
-  Matrix reconsBspline(std::vector<Matrix> band);
+  Matrix reconsBspline(const std::vector<Matrix>& band);
 private:
   /**
    *  @brief <m_sizeXaxis>, Xaxis of matrix
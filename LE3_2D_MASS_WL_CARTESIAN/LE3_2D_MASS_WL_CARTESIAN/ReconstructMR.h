@@ -53,13 +53,18 @@ public:
    */
   ReconstructMR(const ReconstructMR& copy);
 
+  /**
+   * @brief assignment disabled, each object owns its lookup tables
+   */
+  ReconstructMR& operator= (const ReconstructMR& copy) = delete;
+
   /**
    * @brief       calculate the derivative of hn in case of Gaussian noise (sigma=1)
    *              hn = x/Sigma^2*erfc(x/(sqrt(2)sigma)) + sqrt(2/PI)/sigma[1-exp(-x^2/(2sigma^2))]
    * @param[in]   the input value
    * @return      derivative of hn
    */
-  double grad_hn_sig1(double Val);
+  double grad_hn_sig1(double Val) const;
 
   /**
    * @brief       calculate the derivative of hs in case of Gaussian noise (sigma=1)
@@ -67,27 +72,28 @@ public:
    * @param[in]   the input value
    * @return      derivative of hs
    */
-  double grad_hs_sig1(double Val);
+  double grad_hs_sig1(double Val) const;
 
   /**
    * @brief       calculate the derivative of hs at input Val
    * @param[in]   the input value
    * @return      derivative of hs
    */
-   double grad_hs(double Val);
+   double grad_hs(double Val) const;
 
   /**
    * @brief       calculate the derivative of hn at input Val
    * @param[in]   the input value
    * @return      derivative of hn
    */
-   double grad_hn(double Val);
+   double grad_hn(double Val) const;
 
   /**
    * @brief       calculate by the dichotomy method the solution wich minimize:
    *              J = hs(y-x) + Alpha hn(x), It is obtained when:  grad_hs(y-x) = Alpha grad_hn(x)
+   *              Only reads the lookup tables, so one object can be shared between threads
    */
-   double filter (double CoefDat, double Alpha, double Sigma=1.);
+   double filter (double CoefDat, double Alpha, double Sigma=1.) const;
 
 private:
   /**
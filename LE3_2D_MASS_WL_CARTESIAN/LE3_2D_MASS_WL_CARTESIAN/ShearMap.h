@@ -86,6 +86,24 @@ public:
  */
  ShearMap(const std::string& filename);
 
+ /**
+ * @brief Constructor of a shear Map from a selected image HDU of a FITS file
+ * @param[in] filename name of a FITS input file
+ * @param[in] hduName name (EXTNAME) of the image HDU to read
+ * @param[in] firstPlane index of the first plane to load
+ * @param[in] nbPlanes number of planes to load, 0 to load all the planes from firstPlane
+ */
+ ShearMap(const std::string& filename, const std::string& hduName, int firstPlane = 0, int nbPlanes = 0);
+
+ /**
+ * @brief Constructor of a shear Map from a selected image HDU of a FITS file
+ * @param[in] filename name of a FITS input file
+ * @param[in] hduIndex index of the image HDU to read (0 for the Primary)
+ * @param[in] firstPlane index of the first plane to load
+ * @param[in] nbPlanes number of planes to load, 0 to load all the planes from firstPlane
+ */
+ ShearMap(const std::string& filename, int hduIndex, int firstPlane = 0, int nbPlanes = 0);
+
  /**
  * @brief Copy constructor of a Shear Map
  * @param[in] copyMap the Map to copy
@@ -27,8 +27,10 @@
 #include "LE3_2D_MASS_WL_CARTESIAN/CartesianParam.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
 
 #include <vector>
+#include <array>
 #include <cstdio>
 #include <iostream>
 #include <iterator>
@@ -71,6 +73,12 @@ public:
    */
   virtual ~SplitCatalog() = default;
 
+  /**
+   *  @brief    returns the catalog columns (ShearColumns flags) written in the sub-catalogs,
+   *            to be given to ReadCatalog::setColumns
+  */
+  static unsigned int getCatalogColumns();
+
   /**
    *  @brief    Private method to split catalog into sub-catalogs based on the need
    *            and writes the sub_catalogs into FITS format file
@@ -95,21 +103,40 @@ public:
  void getEqualBinSplittedCatalogs(fs::path& datadir, std::vector<std::string>& Filenames);
 
   /**
-   *  @brief    write sub catalogs
-   *  @param    Filenames <vector<string> >, name of the subcatalog
-   *  @param    Data <vector<double> >, data to write
-   *  @param    colname <string>, column name of the respective data
-   *  @return   true if column is written successfully in the respective catalog
+   *  @brief    write a sub catalog with all its columns in a single table write
+   *  @param    filename <string>, name of the subcatalog, overwritten if it exists
+   *  @param    binData <vector<vector<double> > >, rows of the sub catalog column-wise, in the order of
+   *            the catalog data (ra, dec, kappa, g1, g2, z, weight, correction)
+   *  @param    columnNames <vector<string> >, column names of the subcatalog as given by getcolumnNames,
+   *            paired with the columns of outColumns
+   *  @return   true if the catalog is written successfully
+  */
+ bool saveSubCatalog (const std::string& filename, const std::vector<std::vector<double> >& binData,
+                      const std::vector<std::string>& columnNames);
+
+  /**
+   *  @brief    partitions the catalog rows into redshift bins in two passes over the catalog
+   *            (counting sort): bin of each row and counts per bin, then scatter of the columns
+   *            into buffers allocated once per bin
+   *  @param    edges <vector<double> >, increasing bin edges, bin k being [edges[k], edges[k+1])
+   *  @param    columns <unsigned int>, catalog columns (ShearColumns flags) to copy in the bins
+   *  @return   for each bin, its rows column-wise (the other columns being empty),
+   *            in the order of the input catalog
   */
- bool saveSubCatalogs (const std::string& filename, std::vector<double>& Data, const std::string &colname);
+ std::vector<std::vector<std::vector<double> > > partitionByRedshift(const std::vector<double>& edges,
+                                                                     unsigned int columns = Euclid::WeakLensing::TwoDMass::ALL_COLUMNS) const;
 
   /**
-   *  @brief    returns indices of selected galaxies according to z bin
-   *  @param    indices <vector<int> >, indices of selected galaxies
-   *  @param    t_zmin <double>, min z value
-   *  @param    t_zmax <double>, max z value
+   *  @brief    partitions the catalog rows into redshift bins of equal population, as the equal split of
+   *            the catalog sorted by redshift would, without sorting it: the redshift quantiles are found
+   *            by selection (nth_element), then the rows are scattered to their bins in the input order
+   *  @param    nBins <size_t>, number of bins
+   *  @param    columns <unsigned int>, catalog columns (ShearColumns flags) to copy in the bins
+   *  @return   for each bin, its rows column-wise (the other columns being empty),
+   *            in the order of the input catalog
   */
- void getIndices(std::vector < int >& Indices, double t_zmin, double t_zmax);
+ std::vector<std::vector<std::vector<double> > > partitionBalanced(size_t nBins,
+                                                   unsigned int columns = Euclid::WeakLensing::TwoDMass::ALL_COLUMNS) const;
 
   /**
    *  @brief    returns column name as in Data model
@@ -119,6 +146,38 @@ public:
 
 private:
 
+  /**
+   *  @brief    copies the rows of the catalog in their bins, the blocks of rows being processed in parallel
+   *  @param    binOfRow <vector<unsigned int> >, bin of each row, nBins for the rows out of the bins
+   *  @param    blockCounts <vector<size_t> >, number of rows per bin (nBins+1 values) in each block of rows,
+   *            changed into the offsets of the blocks in the bins
+   *  @param    nBins <size_t>, number of bins
+   *  @param    columns <unsigned int>, catalog columns (ShearColumns flags) to copy in the bins
+   *  @return   for each bin, its rows column-wise
+  */
+ std::vector<std::vector<std::vector<double> > > scatterRows(const std::vector<unsigned int>& binOfRow,
+                                     std::vector<size_t>& blockCounts, size_t nBins, unsigned int columns) const;
+
+  /**
+   *  @brief    writes the partitioned bins in the sub-catalogs one after the other, releasing each bin once written
+  */
+ void writeBins(fs::path& datadir, std::vector<std::string>& Filenames,
+                std::vector<std::vector<std::vector<double> > >& binData);
+
+  /**
+   *  @brief    the catalog columns (ShearColumns flags) written in the sub-catalogs
+  */
+ static unsigned int subCatalogColumns();
+
+  /**
+   *  @brief <outColumns>, columns of the sub-catalogs, in the order of the column names of getcolumnNames
+  */
+ static const std::array<unsigned int, 7> outColumns;
+  /**
+   *  @brief <blockSize>, rows per block of the partition, fixed so that it does not depend on the number of threads
+  */
+ static const long blockSize = 65536;
+
   /**
    *  @brief <m_cartesianParam>, CartesianParam object with catalog parameters
   */
@@ -26,6 +26,7 @@
 #include "ElementsKernel/Temporary.h"
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <memory>
 
 using namespace Euclid::WeakLensing::TwoDMass;
 using namespace LE3_2D_MASS_WL_CARTESIAN;
@@ -48,16 +49,12 @@ CartesianAlgoKS::CartesianAlgoKS(LE3_2D_MASS_WL_CARTESIAN::CartesianParam &param
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 bool CartesianAlgoKS::extractShearMap(const std::string& shearMap, std::vector<std::vector<double> >& Data,
                                       LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB) {
- LE3_2D_MASS_WL_CARTESIAN::ShearMap *m_ShearMap = nullptr;
- MapMaker map(Data, m_cartesianParam);
- m_ShearMap = map.getShearMap(CB);
- // Pixelate X and Y axis
- if ((m_ShearMap->getXdim()) == 2048 && (m_ShearMap->getYdim()) == 2048) {
-  m_ShearMap->pixelate(1, 1);
- }
- if ((m_ShearMap->getXdim()) == 4096 && (m_ShearMap->getYdim()) == 4096) {
-  m_ShearMap->pixelate(2, 2);
- }
+ return extractShearMap(shearMap, makeShearCatalogView(Data), CB);
+}
+
+bool CartesianAlgoKS::extractShearMap(const std::string& shearMap, const ShearCatalogView<double>& Data,
+                                      LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB) {
+ LE3_2D_MASS_WL_CARTESIAN::ShearMap *m_ShearMap = getShearMap(Data, CB);
  // Writing Shear Map
  if (m_ShearMap != nullptr) {
   std::string name="SHEAR_PATCH";
@@ -72,22 +69,47 @@ bool CartesianAlgoKS::extractShearMap(const std::string& shearMap, std::vector<s
 
  return true;
 }
+
+bool CartesianAlgoKS::extractShearMap(const std::string& shearMap, const ShearCatalogView<double>& Data,
+                                      LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB, AsyncWriter& writer) {
+ std::shared_ptr<LE3_2D_MASS_WL_CARTESIAN::ShearMap> m_ShearMap(getShearMap(Data, CB));
+ if (m_ShearMap == nullptr) {
+  return false;
+ }
+ // The writer owns the map and a copy of the parameters, written in the header
+ std::string name="SHEAR_PATCH";
+ m_cartesianParam.setExtName(name);
+ LE3_2D_MASS_WL_CARTESIAN::CartesianParam params(m_cartesianParam);
+ writer.submit([m_ShearMap, params, shearMap] () mutable {
+  m_ShearMap->writeMap(shearMap, params);
+ });
+
+ return true;
+}
+
+LE3_2D_MASS_WL_CARTESIAN::ShearMap* CartesianAlgoKS::getShearMap(const ShearCatalogView<double>& Data,
+                                                                 LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB) {
+ MapMaker map(m_cartesianParam);
+ LE3_2D_MASS_WL_CARTESIAN::ShearMap *m_ShearMap = map.getShearMap(Data, CB);
+ if (m_ShearMap == nullptr) {
+  return nullptr;
+ }
+ // Pixelate X and Y axis
+ if ((m_ShearMap->getXdim()) == 2048 && (m_ShearMap->getYdim()) == 2048) {
+  m_ShearMap->pixelate(1, 1);
+ }
+ if ((m_ShearMap->getXdim()) == 4096 && (m_ShearMap->getYdim()) == 4096) {
+  m_ShearMap->pixelate(2, 2);
+ }
+ return m_ShearMap;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Extract ConvergenceMap function NOT REQUIRED (Delete)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 bool CartesianAlgoKS::extractConvergnceMap (const std::string& convergenceMap,
                       std::vector<std::vector<double> >& Data, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB) {
- LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *m_ConvergenceMap = nullptr;
- MapMaker map(Data, m_cartesianParam);
-
- m_ConvergenceMap = map.getConvMap(CB);
- // Pixelate X and Y axis
- if ((m_ConvergenceMap->getXdim()) == 2048 && (m_ConvergenceMap->getYdim()) == 2048) {
-  m_ConvergenceMap->pixelate(1, 1);
- }
- if ((m_ConvergenceMap->getXdim()) == 4096 && (m_ConvergenceMap->getYdim()) == 4096) {
-  m_ConvergenceMap->pixelate(2, 2);
- }
+ LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *m_ConvergenceMap = getConvergenceMap(Data, CB);
  // Writing convergence Map
  if (m_ConvergenceMap != nullptr) {
   std::string name="KAPPA_PATCH";
@@ -103,6 +125,42 @@ bool CartesianAlgoKS::extractConvergnceMap (const std::string& convergenceMap,
  return true;
 
 }
+
+bool CartesianAlgoKS::extractConvergnceMap (const std::string& convergenceMap,
+                      std::vector<std::vector<double> >& Data, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB,
+                      AsyncWriter& writer) {
+ std::shared_ptr<LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap> m_ConvergenceMap(getConvergenceMap(Data, CB));
+ if (m_ConvergenceMap == nullptr) {
+  return false;
+ }
+ // Written by the writer thread as the shear maps, CFITSIO being called from one thread only
+ std::string name="KAPPA_PATCH";
+ m_cartesianParam.setExtName(name);
+ LE3_2D_MASS_WL_CARTESIAN::CartesianParam params(m_cartesianParam);
+ writer.submit([m_ConvergenceMap, params, convergenceMap] () mutable {
+  m_ConvergenceMap->writeMap(convergenceMap, params);
+ });
+
+ return true;
+}
+
+LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap* CartesianAlgoKS::getConvergenceMap(
+                      std::vector<std::vector<double> >& Data, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB) {
+ MapMaker map(Data, m_cartesianParam);
+ LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *m_ConvergenceMap = map.getConvMap(CB);
+ if (m_ConvergenceMap == nullptr) {
+  return nullptr;
+ }
+ // Pixelate X and Y axis
+ if ((m_ConvergenceMap->getXdim()) == 2048 && (m_ConvergenceMap->getYdim()) == 2048) {
+  m_ConvergenceMap->pixelate(1, 1);
+ }
+ if ((m_ConvergenceMap->getXdim()) == 4096 && (m_ConvergenceMap->getYdim()) == 4096) {
+  m_ConvergenceMap->pixelate(2, 2);
+ }
+ return m_ConvergenceMap;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Perform KS Mass Mapping
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -437,36 +495,30 @@ void CartesianAlgoKS::getTildeConvergence(LE3_2D_MASS_WL_CARTESIAN::ConvergenceM
                                   boost::filesystem::path& outConvergenceMap) {
    std::vector<fs::path> filenames = read_filenames(workdir, NReMaps);
    logger.info () <<"number of sampled maps: " << filenames.size();
-   std::vector<LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap*> MapList;
+   // Maps are read one at a time and accumulated, so that only one sample is in memory
+   int xbin(0), ybin(0), zbin(0);
+   std::vector<double> squr, sample;
    for (size_t i = 0; i<filenames.size(); i++) {
     logger.info () <<"filenames: " << filenames[i];
-    LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *SampledMap = nullptr;
-    SampledMap = new ConvergenceMap((workdir/"data"/filenames[i]).native());
-    MapList.push_back(SampledMap);
-   }
-   int xbin = MapList[0]->getXdim();
-   int ybin = MapList[0]->getYdim();
-   int zbin = MapList[0]->getZdim();
-   double* squr = new double[xbin*ybin*zbin];
-   std::fill_n(squr, xbin*ybin*zbin, 0);
-   for (size_t i = 0; i< MapList.size(); i++) {
-    for (int z = 0; z < zbin; z++) {
-     for (int y = 0; y < ybin; y++) {
-      for (int x = 0; x < xbin; x++) {
-       squr[xbin*ybin*z+xbin*y+x] += 
-                  pow(MapList[i]->getBinValue(x, y, z), 2);
-      }
-     }
+    ConvergenceMap SampledMap((workdir/"data"/filenames[i]).native());
+    if (i == 0) {
+     xbin = SampledMap.getXdim();
+     ybin = SampledMap.getYdim();
+     zbin = SampledMap.getZdim();
+     squr.assign(xbin*ybin*zbin, 0.);
+     sample.resize(xbin*ybin*zbin);
+    }
+    SampledMap.getArray(sample.data());
+    for (int p = 0; p < xbin*ybin*zbin; p++) {
+     squr[p] += sample[p]*sample[p];
     }
    }
-   double* rms = new double[xbin*ybin*zbin];
-   std::fill_n(rms, xbin*ybin*zbin, 0);
+   std::vector<double> rms(xbin*ybin*zbin, 0.);
    for (int i = 0; i< xbin*ybin*zbin; i++) {
-     double mean = squr[i] / double (MapList.size());
+     double mean = squr[i] / double (filenames.size());
      rms[i] = sqrt (mean);
    }
-   delete [] squr;
-   LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *myConvergenceMap = new ConvergenceMap(rms, xbin, ybin, zbin);
+   LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *myConvergenceMap = new ConvergenceMap(rms.data(), xbin, ybin, zbin);
    if ((true == outConvergenceMap.string().empty())) {
     outConvergenceMap = fs::path("EUC_LE3_WL_SNRConvergenceMap_" + getDateTimeString() + ".fits");
    }
@@ -475,7 +527,6 @@ void CartesianAlgoKS::getTildeConvergence(LE3_2D_MASS_WL_CARTESIAN::ConvergenceM
     m_cartesianParam.setExtName(name);
     myConvergenceMap->writeMap((workdir/"data"/outConvergenceMap).native(), m_cartesianParam);
    }
-   delete [] rms;
    delete myConvergenceMap;
 
    return true;
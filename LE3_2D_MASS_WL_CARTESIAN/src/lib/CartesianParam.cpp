@@ -41,7 +41,8 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
            m_NInpaint(100), m_EqualVarPerScale(0), m_ForceBMode(1), m_nbScales(0), m_add_borders(0),
            m_sigmaGauss(0.), m_thresholdFDR(0.), m_nbSamples(0), m_removeOffset(0), squareMap(true),
            raMin(0.0), raMax(0.0), decMin(0.0), decMax(0.0), xbin(1024), ybin(1024), ExtName("KAPPA_PATCH"),
-           m_zMargin(0.), m_RSsigmaGauss(0.), m_massThreshold(0.), m_ParaFileType("Conv_Patch")
+           m_zMargin(0.), m_RSsigmaGauss(0.), m_massThreshold(0.), m_ParaFileType("Conv_Patch"),
+           m_mapCompression(MapCompression::NONE)
  { }
 
  CartesianParam::CartesianParam(int NItReducedShear, int NPatches, float PixelSize, float PatchWidth,
@@ -56,7 +57,8 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
            m_nbScales(nbScales), m_add_borders(add_borders), m_RSsigmaGauss(RSsigmaGauss), m_sigmaGauss(sigmaGauss),
            m_thresholdFDR(thresholdFDR), m_nbSamples(nbSamples),
            m_removeOffset(removeOffset), squareMap(squareMap), m_massThreshold(massThreshold), raMin(0.0), raMax(0.0),
-           decMin(0.0), decMax(0.0), xbin(1024), ybin(1024), ExtName(ExtensionName), m_ParaFileType(ParaFileType) { }
+           decMin(0.0), decMax(0.0), xbin(1024), ybin(1024), ExtName(ExtensionName), m_ParaFileType(ParaFileType),
+           m_mapCompression(MapCompression::NONE) { }
 
   /**
    * @brief   function to read Convergence Patches parameter XML file with respect to Data Model
@@ -373,6 +375,12 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
  }
  std::string CartesianParam::getParaFileType(){
   return m_ParaFileType;
+ }
+ MapCompression CartesianParam::getMapCompression(){
+  return m_mapCompression;
+ }
+ void CartesianParam::setMapCompression(MapCompression mapCompression) {
+  m_mapCompression = mapCompression;
  }
   /**
   * @brief Returns the value of the RaMax
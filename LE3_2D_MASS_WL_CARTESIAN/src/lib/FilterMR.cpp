@@ -38,8 +38,14 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
 
 FilterMR::FilterMR(ConvergenceMap &convMap, bool PositiveCons, bool KillLastScale, bool KillIsol,
               int niter, int FirstScale, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam):
+              FilterMR(convMap, PositiveCons, KillLastScale, KillIsol, niter, FirstScale, cartesianParam,
+                       std::make_shared<const ReconstructMR>()) {}
+
+FilterMR::FilterMR(ConvergenceMap &convMap, bool PositiveCons, bool KillLastScale, bool KillIsol,
+              int niter, int FirstScale, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam,
+              std::shared_ptr<const ReconstructMR> restore):
               m_cartesianParam(cartesianParam), convMap(convMap), m_MP(convMap.getXdim(), convMap.getYdim()),
-              m_KillLastScale(KillLastScale), m_KillIsol(KillIsol) {
+              m_KillLastScale(KillLastScale), m_KillIsol(KillIsol), m_restore(restore) {
 
  // Retrieve the size of the maps
  m_Xaxis = convMap.getXdim();
@@ -72,14 +78,11 @@ FilterMR::FilterMR(const FilterMR& copy): convMap(copy.convMap),
   m_MP(copy.m_MP), m_Xaxis(copy.m_Xaxis), m_Yaxis(copy.m_Yaxis), m_Zaxis(copy.m_Zaxis),
   m_FirstScale(copy.m_FirstScale), m_SigmaNoise(copy.m_SigmaNoise), nbScales(copy.nbScales), m_FDR(copy.m_FDR),
   m_PositveConstraint(copy.m_PositveConstraint), m_KillLastScale(copy.m_KillLastScale), m_KillIsol(copy.m_KillIsol),
-  m_niter(copy.m_niter), avar(copy.avar) {}
+  m_niter(copy.m_niter), avar(copy.avar), m_restore(copy.m_restore) {}
 
 
 double FilterMR::fdr_pv(std::vector<double> &PValue, double alpha) {
-   std::vector<double> input_pval;
-    for (size_t i=0; i < PValue.size(); i++){
-        input_pval.push_back( PValue[i]);
-    }
+   std::vector<double> input_pval(PValue);
     std::sort(input_pval.begin(), input_pval.end());
 //    input_pval[1] =0;
     int m = input_pval.size();
@@ -149,6 +152,7 @@ void FilterMR::get_fdr(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix>& myBand, st
  
  for (int kScale = 0; kScale<nbScales-1; kScale++){
    std::vector < double> PValue;
+   PValue.reserve(m_Xaxis*m_Yaxis);
   // logger.info()<< "Sig " << m_SigmaNoise * Euclid::WeakLensing::TwoDMass::NormB3Spline[kScale];
     for (int j=0; j<m_Yaxis; j++){
        for (int i=0; i<m_Xaxis; i++){
@@ -298,6 +302,7 @@ ConvergenceMap* FilterMR::performFiltering() {
  }
 
  ConvergenceMap kappaMap1(kappaArray, m_Xaxis, m_Yaxis, m_Zaxis);
+ delete [] kappaArray;
 
  kappaMap = new ConvergenceMap(kappaMap1);
  return kappaMap;
@@ -315,73 +320,49 @@ Matrix FilterMR::reconstruct_optimized(std::vector<LE3_2D_MASS_WL_CARTESIAN::Mat
           band[nbScales-1].reset();
    }
 
-  Matrix map (m_Xaxis, m_Yaxis);
-  map = reconstruct (band);
+  Matrix map = reconstruct (band);
+  const size_t nPix = map.size();
 
-  std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix> band_i;
   std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix> band_res;
 
   for (int it =0; it < m_niter; it++) {
     std::cout << "start iteration " << it+1 << std::endl;
-    band_i = m_MP.transformBspline(map, nbScales);
-    band_res = band_i;
+    band_res = m_MP.transformBspline(map, nbScales);
+    // Residuals band - band_i computed in place, outside the support only the last scale is kept
     for (int b = 0; b < nbScales; b++) {
-     for (int j=0; j<m_Yaxis; j++){
-      for (int i=0; i<m_Xaxis; i++){
-          double a0 = band[b].getValue(i, j);
-          double b0 = band_i[b].getValue(i, j);
-          band_res[b].setValue(i, j, (a0-b0));
-          double c0 = mr_band[b].getValue(i, j);
-          if (c0 == 0) {
-           band_res[b].setValue(i, j, 0.);
+      band_res[b] *= -1.;
+      band_res[b] += band[b];
+      if (b < nbScales-1) {
+        double *res = band_res[b].getArray();
+        const double *support = mr_band[b].getArray();
+        for (size_t p = 0; p < nPix; p++) {
+          if (support[p] == 0) {
+            res[p] = 0.;
           }
+        }
       }
-     }
     }
 
-    for (int j=0; j<m_Yaxis; j++){
-     for (int i=0; i<m_Xaxis; i++){
-          double a1 = band[nbScales-1].getValue(i, j);
-          double b1 = band_i[nbScales-1].getValue(i, j);
-          band_res[nbScales-1].setValue(i, j, a1-b1);
-     }
-    }
-    Matrix res(m_Xaxis, m_Yaxis);
-    res = reconstruct (band_res);
+    Matrix res = reconstruct (band_res);
 
-    for (int j=0; j<m_Yaxis; j++){
-     for (int i=0; i<m_Xaxis; i++){
-      double a2 = map.getValue(i, j);
-      double b2 = res.getValue(i, j);
-      if (b2>0) {
-        map.setValue(i, j, a2+b2);
+    double *mapArray = map.getArray();
+    const double *resArray = res.getArray();
+    for (size_t p = 0; p < nPix; p++) {
+      if (resArray[p]>0) {
+        mapArray[p] += resArray[p];
       }
-     }
     }
   }
  return map;
 }
 
 Matrix FilterMR::reconstruct(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix> & band) {
- Matrix Image (m_Xaxis, m_Yaxis);
- Matrix temp (m_Xaxis, m_Yaxis);
- for (int j=0; j<m_Yaxis; j++){
-   for (int i=0; i<m_Xaxis; i++){
-     Image.setValue(i, j, band[nbScales-1].getValue(i, j));
-   }
- }
+ Matrix Image (band[nbScales-1]);
 
  size_t s = nbScales-2;
  do {
-   temp = m_MP.smoothBspline(Image, s);
-  for (int j=0; j<m_Yaxis; j++){
-   for (int i=0; i<m_Xaxis; i++){
-        double aa = temp.getValue(i, j);
-        double bb = band[s].getValue(i, j);
-        Image.setValue(i, j, aa+bb);
-     }
-   }
-
+   Image = m_MP.smoothBspline(Image, s);
+   Image += band[s];
  } while ( s-- );
 
  return Image;
@@ -406,7 +387,7 @@ void FilterMR::applyfilter(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix>& band,
  std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix> copyBand;// = band;
   //copy(band.begin(), band.end()-1, back_inserter(copyBand))
 
- ReconstructMR restore;
+ const ReconstructMR &restore = *m_restore;
 
  do {
   iter++;
@@ -422,14 +403,12 @@ void FilterMR::applyfilter(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix>& band,
 
   //copyBand[nbScales-1].reset();
 
-  LE3_2D_MASS_WL_CARTESIAN::Matrix image (m_Xaxis, m_Yaxis);
-  image = m_MP.reconsBspline(copyBand);
+  LE3_2D_MASS_WL_CARTESIAN::Matrix image = m_MP.reconsBspline(copyBand);
 
-  double Flux=image.getFlux();
-  double Mean=Flux / (m_Yaxis*m_Xaxis);
+  LE3_2D_MASS_WL_CARTESIAN::MatrixStatistics stats = image.getStatistics();
 
-  logger.info() << " Min = " << image.getMin() << "    Max = " << image.getMax() << "    Flux = " << Flux;
-  logger.info() << "    Mean = " << Mean << "     Sigma = " << image.getStandardDeviation();
+  logger.info() << " Min = " << stats.min << "    Max = " << stats.max << "    Flux = " << stats.sum;
+  logger.info() << "    Mean = " << stats.getMean() << "     Sigma = " << stats.getStandardDeviation();
 
   if (true == m_PositveConstraint) {
    image.applyThreshold(0.);
@@ -484,7 +463,7 @@ void FilterMR::estimateNewAlphaParam(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matri
 }
 
 void FilterMR::fixedAlphaFilter(std::vector<LE3_2D_MASS_WL_CARTESIAN::Matrix>& band, std::vector<double>& TabAlpha,
-                 std::vector<double>& NSigma, LE3_2D_MASS_WL_CARTESIAN::ReconstructMR & restore) {
+                 std::vector<double>& NSigma, const LE3_2D_MASS_WL_CARTESIAN::ReconstructMR & restore) {
 
  double alphaP, val=0.;
  for (int b = 0; b < nbScales-1; b++) {
@@ -22,6 +22,10 @@
  */
 
 #include "LE3_2D_MASS_WL_CARTESIAN/GetMap.h"
+#include "LE3_2D_MASS_WL_CARTESIAN/Matrix.h"
+#include "ElementsKernel/Exception.h"
+#include "fitsio.h"
+#include <algorithm>
 
 using namespace Euclid::WeakLensing::TwoDMass;
 using Euclid::FitsIO::Record;
@@ -35,8 +39,132 @@ static Elements::Logging logger = Elements::Logging::getLogger("GetMap");
 using namespace Euclid::WeakLensing::TwoDMass;
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
+namespace {
+ // fftw_malloc based allocator so that the map buffers are SIMD aligned
+ template<typename T>
+ struct FftwAllocator {
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  template<typename U> struct rebind { typedef FftwAllocator<U> other; };
+
+  FftwAllocator() = default;
+  template<typename U> FftwAllocator(const FftwAllocator<U>&) {}
+
+  T* allocate(std::size_t n, const void* = nullptr) {
+   T* p = static_cast<T*>(fftw_malloc(n*sizeof(T)));
+   if (p == nullptr) {
+    throw std::bad_alloc();
+   }
+   return p;
+  }
+  void deallocate(T* p, std::size_t) { fftw_free(p); }
+  template<typename U, typename... Args>
+  void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+  template<typename U>
+  void destroy(U* p) { p->~U(); }
+  std::size_t max_size() const { return std::size_t(-1)/sizeof(T); }
+  bool operator==(const FftwAllocator&) const { return true; }
+  bool operator!=(const FftwAllocator&) const { return false; }
+ };
+
+ typedef boost::multi_array<double, 3, FftwAllocator<double> > MapArray;
+
+ // Maps are stored plane by plane with x running fastest, i.e. with the
+ // layout of FITS images and of the arrays given to/returned by GetMap
+ MapArray* newMapValues(int sizeXaxis, int sizeYaxis, int sizeZaxis) {
+  return new MapArray(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis], boost::fortran_storage_order());
+ }
+
+ void deleteMapValues(boost::multi_array_ref<double, 3> *mapValues) {
+  delete static_cast<MapArray*>(mapValues);
+ }
+
+ // Reads a keyword of the current HDU, returning the default value if it is missing
+ double readKeyOr(fitsfile *fptr, const std::string& key, double defaultValue) {
+  int status = 0;
+  double value = defaultValue;
+  fits_read_key(fptr, TDOUBLE, key.c_str(), &value, nullptr, &status);
+  return status == 0 ? value : defaultValue;
+ }
+
+ // Kaiser & Squires transform of the complex map (re, im), the kernel is computed on the fly
+ void kaiserSquires(const double *re, const double *im, double *outRe, double *outIm,
+                    int sizeXaxis, int sizeYaxis, bool inverse) {
+  const size_t nPix = size_t(sizeXaxis)*sizeYaxis;
+  const double fftFactor = 1.0/nPix;
+  const double sign = inverse ? -1. : 1.;
+
+  fftw_complex *map_complex = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*nPix);
+  fftw_complex *fft_complex = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*nPix);
+  fftw_plan plan_forward;
+  fftw_plan plan_backward;
+
+  #pragma omp critical
+  {
+    plan_forward = fftw_plan_dft_2d(sizeXaxis, sizeYaxis, map_complex, fft_complex,
+                                    FFTW_FORWARD, FFTW_MEASURE);
+    plan_backward = fftw_plan_dft_2d(sizeXaxis, sizeYaxis, fft_complex, map_complex,
+                                     FFTW_BACKWARD, FFTW_MEASURE);
+  }
+
+  // Fill the complex map (planning with FFTW_MEASURE overwrites the buffers)
+  for (size_t p = 0; p < nPix; p++) {
+    map_complex[p][0] = re[p];
+    map_complex[p][1] = im[p];
+  }
+
+  fftw_execute(plan_forward);
+
+  // Multiply by the P factor
+  for (int j = 0; j < sizeYaxis; j++) {
+    const int l2 = (double(j) <= double(sizeYaxis)/2. ? j : j - sizeYaxis);
+    for (int i = 0; i < sizeXaxis; i++) {
+      const int l1 = (double(i) <= double(sizeXaxis)/2. ? i : i - sizeXaxis);
+      const size_t p = size_t(j)*sizeXaxis + i;
+      if (l1 == 0 && l2 == 0) {
+        fft_complex[p][0] = 0;
+        fft_complex[p][1] = 0;
+        continue;
+      }
+      const double norm = 1./double(l1*l1 + l2*l2);
+      const double psiRe = double(l1*l1 - l2*l2)*norm;
+      const double psiIm = sign*double(2*l1*l2)*norm;
+      const double fftRe = fft_complex[p][0];
+      const double fftIm = fft_complex[p][1];
+      fft_complex[p][0] = psiRe*fftRe - psiIm*fftIm;
+      fft_complex[p][1] = psiRe*fftIm + psiIm*fftRe;
+    }
+  }
+
+  fftw_execute(plan_backward);
+
+  for (size_t p = 0; p < nPix; p++) {
+    outRe[p] = map_complex[p][0]*fftFactor;
+    outIm[p] = map_complex[p][1]*fftFactor;
+  }
+
+  fftw_destroy_plan(plan_forward);
+  fftw_destroy_plan(plan_backward);
+  fftw_free(map_complex);
+  fftw_free(fft_complex);
+  fftw_cleanup();
+ }
+}
+
+void GetMap::applyKSKernel(double *array, bool inverse) const {
+  // The two first planes are contiguous in the map buffer
+  const size_t nPix = size_t(sizeXaxis)*sizeYaxis;
+  const double *re = m_mapValues->data();
+  kaiserSquires(re, re + nPix, array, array + nPix, sizeXaxis, sizeYaxis, inverse);
+}
+
   GetMap::~GetMap() {
-   delete m_mapValues;
+   deleteMapValues(m_mapValues);
    m_mapValues = nullptr;
   }
 
@@ -45,19 +173,9 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
                      sizeYaxis(1024), sizeZaxis(3) {
   sizeXaxis = cartesianParam.getXaxis();
   sizeYaxis = cartesianParam.getYaxis();
-  typedef boost::multi_array<double, 3>::index index;
-
-  // Declare the map of data
-  m_mapValues = new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
-
-  // Assign values from the input array to the map
-  for (index k = 0; k != sizeZaxis; ++k){
-    for (index j = 0; j != sizeYaxis; ++j){
-      for (index i = 0; i != sizeXaxis; ++i){
-        (*m_mapValues)[i][j][k] = array[sizeXaxis*sizeYaxis*k+sizeXaxis*j+i];
-      }
-    }
-  }
+  // Declare the map of data and assign values from the input array (same layout)
+  m_mapValues = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
+  std::copy_n(array, m_mapValues->num_elements(), m_mapValues->data());
 }
 
  void GetMap::thresholding(double value){
@@ -74,120 +192,124 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
  }
 
 double GetMap::getSigma() const{
-  typedef boost::multi_array<double, 3>::index index;
-  double mean(0);
-  double squareMean(0);
-  unsigned int counts(0);
- // Loop over all values to find the max
-  for (index j = 0; j != sizeYaxis; ++j){
-   for (index i = 0; i != sizeXaxis; ++i){
-    mean += (*m_mapValues)[i][j][0];
-    squareMean += (*m_mapValues)[i][j][0]*(*m_mapValues)[i][j][0];
-    counts++;
-   }
-  }
-  double stdev = sqrt(squareMean/counts - mean*mean/counts/counts);
-  return stdev;
+  // Single pass over the first plane
+  return computeStatistics(m_mapValues->data(), size_t(sizeXaxis)*sizeYaxis).getStandardDeviation();
 }
 
  GetMap::GetMap(double* array, int Xaxis, int Yaxis, int Zaxis, int nbGalaxies):
                  sizeXaxis(Xaxis), sizeYaxis(Yaxis), sizeZaxis(Zaxis), nGalaxies(nbGalaxies),
                                   m_PixelSize(0.001), m_CB(0., 0., 0., 0., 0., 0.) {
-  typedef boost::multi_array<double, 3>::index index;
-
-  // Declare the map of data
-  m_mapValues = new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
-
-  // Assign values from the input array to the map
-  for (index k = 0; k != sizeZaxis; ++k){
-    for (index j = 0; j != sizeYaxis; ++j){
-      for (index i = 0; i != sizeXaxis; ++i){
-        (*m_mapValues)[i][j][k] = array[sizeXaxis*sizeYaxis*k+sizeXaxis*j+i];
-      }
-    }
-  }
+  // Declare the map of data and assign values from the input array (same layout)
+  m_mapValues = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
+  std::copy_n(array, m_mapValues->num_elements(), m_mapValues->data());
 }
 
  GetMap::GetMap(double* array, int Xaxis, int Yaxis, int Zaxis,
                 LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& coordBound, int nbGalaxies):
                  sizeXaxis(Xaxis), sizeYaxis(Yaxis), sizeZaxis(Zaxis), nGalaxies(nbGalaxies),
                  m_CB(coordBound), m_PixelSize(0.001) {
-  typedef boost::multi_array<double, 3>::index index;
+  // Declare the map of data and assign values from the input array (same layout)
+  m_mapValues = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
+  std::copy_n(array, m_mapValues->num_elements(), m_mapValues->data());
+ }
 
-  // Declare the map of data
-  m_mapValues = new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
+ GetMap::GetMap(const std::string& filename):nGalaxies(0), m_CB(0., 0., 0., 0., 0., 0.),
+                             m_PixelSize(0.001), sizeXaxis (1024), sizeYaxis(1024), sizeZaxis(3) {
+   readMap(filename, "", -1, 0, 0);
+ }
 
-  // Assign values from the input array to the map
-  for (index k = 0; k != sizeZaxis; ++k){
-    for (index j = 0; j != sizeYaxis; ++j){
-      for (index i = 0; i != sizeXaxis; ++i){
-        (*m_mapValues)[i][j][k] = array[sizeXaxis*sizeYaxis*k+sizeXaxis*j+i];
-      }
-    }
-  }
+ GetMap::GetMap(const std::string& filename, const std::string& hduName, int firstPlane, int nbPlanes):
+                             nGalaxies(0), m_CB(0., 0., 0., 0., 0., 0.),
+                             m_PixelSize(0.001), sizeXaxis (1024), sizeYaxis(1024), sizeZaxis(3) {
+   readMap(filename, hduName, -1, firstPlane, nbPlanes);
  }
 
- GetMap::GetMap(const std::string& filename):nGalaxies(0), m_CB(0., 0., 0., 0., 0., 0.),
+ GetMap::GetMap(const std::string& filename, int hduIndex, int firstPlane, int nbPlanes):
+                             nGalaxies(0), m_CB(0., 0., 0., 0., 0., 0.),
                              m_PixelSize(0.001), sizeXaxis (1024), sizeYaxis(1024), sizeZaxis(3) {
-  // Write the values into the object map
-   typedef boost::multi_array<double, 3> array_type;
-   typedef array_type::index index;
-
-   Euclid::FitsIO::MefFile fitsfile(filename, Euclid::FitsIO::MefFile::Permission::Edit);
-   std::vector<std::string> Hdu_names = fitsfile.readHduNames();
-   for (size_t i = 0; i < Hdu_names.size(); i++) {
-        //logger.info()<<"Name of HDUs in fits file: "<< Hdu_names[i];
-        //const auto &ext = fitsfile.accessFirst<Euclid::FitsIO::ImageHdu>("SHEAR_PATCH");
-        const auto &ext = fitsfile.accessFirst<Euclid::FitsIO::ImageHdu>(Hdu_names[i]);
-        /*const auto records = ext.parseAllRecords<boost::any>();
-        sizeXaxis = (records.as<int>("NAXIS1")).value;
-        sizeYaxis = (records.as<int>("NAXIS2")).value;
-        sizeZaxis = (records.as<int>("NAXIS3")).value;*/
-        const auto ramin = ext.parseRecordOr<double>({"RAMIN", 0});
-        const auto ramax = ext.parseRecordOr<double>({"RAMAX", 0});
-        const auto decmin = ext.parseRecordOr<double>({"DECMIN", 0});
-        const auto decmax = ext.parseRecordOr<double>({"DECMAX", 0});
-        const auto zmin = ext.parseRecordOr<double>({"ZMIN", 0});
-        const auto zmax = ext.parseRecordOr<double>({"ZMAX", 0});
-        nGalaxies = ext.parseRecordOr<int>({"NGAL", 0});
-        m_PixelSize = ext.parseRecordOr<double>({"PIXSIZE", 0});
-        logger.info()<<"Pixel Size found in input Map: "<< m_PixelSize;
-        //logger.info()<<"Number of galaxies found in input Map: "<<nGalaxies;
-        //logger.info()<<"raminmax: "<<ramin<<"\t"<<ramax << "xaxis: " << sizeXaxis;
-        //read Image
-        const auto image = ext.readRaster<double, 3>();
-        sizeXaxis = image.shape[0];
-        sizeYaxis = image.shape[1];
-        sizeZaxis = image.shape[2];
-
-        m_CB = CoordinateBound(ramin, ramax, decmin, decmax, zmin, zmax);
-        // Declare the map of data
-        m_mapValues = new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
-        // Assign values from the input array to the map
-        for (index k = 0; k != sizeZaxis; ++k) { // sizeZaxis = image.length<2>()
-          for (index j = 0; j != sizeYaxis; ++j) { //sizeYaxis = image.length<1>()
-            for (index i = 0; i != sizeXaxis; ++i){ //sizeXaxis = image.length<0>()
-              (*m_mapValues)[i][j][k] = image[{ i, j, k }];
-            }
-          }
-        }
+   readMap(filename, "", hduIndex, firstPlane, nbPlanes);
+ }
+
+ void GetMap::readMap(const std::string& filename, const std::string& hduName, int hduIndex,
+                      int firstPlane, int nbPlanes) {
+   fitsfile *fptr = nullptr;
+   int status = 0;
+   fits_open_file(&fptr, filename.c_str(), READONLY, &status);
+   if (status != 0) {
+     throw Elements::Exception() << "Input map " << filename << " cannot be opened";
+   }
+
+   // Select the image HDU by name, by index, or take the last image HDU of the file
+   int hduType = IMAGE_HDU;
+   if (hduName.empty() == false) {
+     fits_movnam_hdu(fptr, IMAGE_HDU, const_cast<char*>(hduName.c_str()), 0, &status);
+   } else if (hduIndex >= 0) {
+     fits_movabs_hdu(fptr, hduIndex+1, &hduType, &status);
+   } else {
+     int nbHdu = 0;
+     fits_get_num_hdus(fptr, &nbHdu, &status);
+     for (int hdu = nbHdu; hdu > 0 && status == 0; hdu--) {
+       int naxis = 0;
+       fits_movabs_hdu(fptr, hdu, &hduType, &status);
+       if (hduType == IMAGE_HDU && fits_get_img_dim(fptr, &naxis, &status) == 0 && naxis > 0) {
+         break;
+       }
+     }
+   }
+
+   int bitpix = 0, naxis = 0;
+   long naxes[3] = {1, 1, 1};
+   if (status == 0 && hduType == IMAGE_HDU) {
+     fits_get_img_param(fptr, 3, &bitpix, &naxis, naxes, &status);
+   }
+   if (status != 0 || hduType != IMAGE_HDU || naxis < 2) {
+     status = 0;
+     fits_close_file(fptr, &status);
+     throw Elements::Exception() << "No image HDU " << hduName << " found in input map " << filename;
+   }
+
+   // Only the requested planes are loaded
+   if (nbPlanes <= 0) {
+     nbPlanes = naxes[2] - firstPlane;
+   }
+   if (firstPlane < 0 || nbPlanes <= 0 || firstPlane + nbPlanes > naxes[2]) {
+     fits_close_file(fptr, &status);
+     throw Elements::Exception() << "Planes " << firstPlane << " to " << firstPlane + nbPlanes - 1
+                                 << " are not available in input map " << filename;
+   }
+   sizeXaxis = naxes[0];
+   sizeYaxis = naxes[1];
+   sizeZaxis = nbPlanes;
+
+   m_CB = CoordinateBound(readKeyOr(fptr, "RAMIN", 0), readKeyOr(fptr, "RAMAX", 0),
+                          readKeyOr(fptr, "DECMIN", 0), readKeyOr(fptr, "DECMAX", 0),
+                          readKeyOr(fptr, "ZMIN", 0), readKeyOr(fptr, "ZMAX", 0));
+   nGalaxies = int(readKeyOr(fptr, "NGAL", 0));
+   m_PixelSize = readKeyOr(fptr, "PIXSIZE", 0);
+   logger.info()<<"Pixel Size found in input Map: "<< m_PixelSize;
+
+   // Planes are contiguous both in the file and in the map buffer: read them in place
+   m_mapValues = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
+   long firstPixel[3] = {1, 1, firstPlane + 1};
+   long lastPixel[3] = {naxes[0], naxes[1], firstPlane + nbPlanes};
+   long increment[3] = {1, 1, 1};
+   int anyNull = 0;
+   fits_read_subset(fptr, TDOUBLE, firstPixel, lastPixel, increment, nullptr,
+                    m_mapValues->data(), &anyNull, &status);
+   int closeStatus = 0;
+   fits_close_file(fptr, &closeStatus);
+   if (status != 0) {
+     deleteMapValues(m_mapValues);
+     m_mapValues = nullptr;
+     throw Elements::Exception() << "Image data cannot be read from input map " << filename;
    }
  }
 
  GetMap::GetMap(GetMap const& copyMap):sizeXaxis(copyMap.sizeXaxis), sizeYaxis(copyMap.sizeYaxis),
       sizeZaxis(copyMap.sizeZaxis), nGalaxies(copyMap.nGalaxies), m_CB(copyMap.m_CB), m_PixelSize(copyMap.m_PixelSize){
-  typedef boost::multi_array<double, 3>::index index;
-  // Declare the map of data
-  m_mapValues = new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
-
-  // Assign values from the input array to the map
-  for (index k = 0; k != sizeZaxis; ++k){
-    for (index j = 0; j != sizeYaxis; ++j){
-      for (index i = 0; i != sizeXaxis; ++i) {
-        (*m_mapValues)[i][j][k] = (*copyMap.m_mapValues)[i][j][k];
-      }
-    }
-   }
+  // Declare the map of data and copy the buffer of the input map
+  m_mapValues = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
+  std::copy_n(copyMap.m_mapValues->data(), m_mapValues->num_elements(), m_mapValues->data());
  }
 
  std::vector<double> GetMap::getMeanValues(){
@@ -369,8 +491,7 @@ void GetMap::add_borders(){
  sizeYaxis *= 2;
  typedef boost::multi_array<double, 3>::index index;
  // Declare a new array with the right dimensions
- boost::multi_array<double, 3> *borderedMap =
-             new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
+ MapArray *borderedMap = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
  // Assign values from the old array to the new bordered one
  for (index k = 0; k != sizeZaxis; ++k){
   for (index j = 0; j != sizeYaxis; ++j){
@@ -384,7 +505,7 @@ void GetMap::add_borders(){
   }
  }
   // Delete the old map and assign the new one as a member
-  delete m_mapValues;
+  deleteMapValues(m_mapValues);
   m_mapValues = borderedMap;
 }
 
@@ -393,8 +514,7 @@ void GetMap::remove_borders(){
  sizeYaxis /= 2;
  typedef boost::multi_array<double, 3>::index index;
  // Declare a new array with the right dimensions
- boost::multi_array<double, 3> *borderedMap =
-             new boost::multi_array<double, 3>(boost::extents[sizeXaxis][sizeYaxis][sizeZaxis]);
+ MapArray *borderedMap = newMapValues(sizeXaxis, sizeYaxis, sizeZaxis);
  // Assign values from the old array to the new without borders
  for (index k = 0; k != sizeZaxis; ++k) {
   for (index j = 0; j != sizeYaxis; ++j){
@@ -404,7 +524,7 @@ void GetMap::remove_borders(){
   }
  }
  // Delete the old map and assign the new one as a member
- delete m_mapValues;
+ deleteMapValues(m_mapValues);
  m_mapValues = borderedMap;
 }
 
@@ -465,8 +585,7 @@ unsigned int GetMap::pixelate(float galaxiesPerBin) {
   }
 
  // Create a buffer array to reshape the member array
-  boost::multi_array<double, 3> *buffMapValues = new boost::multi_array<double, 3>
-    (boost::extents[sizeXaxis/int(sqrt(binning))][sizeYaxis/int(sqrt(binning))][sizeZaxis]);
+  MapArray *buffMapValues = newMapValues(sizeXaxis/int(sqrt(binning)), sizeYaxis/int(sqrt(binning)), sizeZaxis);
 
   typedef boost::multi_array<double, 3>::index index;
 
@@ -480,7 +599,7 @@ unsigned int GetMap::pixelate(float galaxiesPerBin) {
   }
 
   // Delete the old array
-  delete m_mapValues;
+  deleteMapValues(m_mapValues);
   m_mapValues = buffMapValues;
 
   // Update the axis dimensions of the map
@@ -493,25 +612,14 @@ unsigned int GetMap::pixelate(float galaxiesPerBin) {
 VecRaster<float, 3> GetMap::createRaster() {
   //! [Create and fill a raster]
   VecRaster<float, 3> raster({ sizeXaxis, sizeYaxis, sizeZaxis });
-  for (int z = 0; z < sizeZaxis; ++z) {
-    for (int y= 0; y < sizeYaxis; ++y) {
-      for (int x = 0; x < sizeXaxis; ++x) {
-        raster[{ x, y, z }] = (*m_mapValues)[x][y][z];
-      }
-    }
-  }
+  // The raster and the map buffer share the same layout
+  std::copy_n(m_mapValues->data(), m_mapValues->num_elements(), raster.data());
   return raster;
 }
 
 void GetMap::getArray(double *array){
-  // Assign values to the elements
-  for ( int k = 0; k != sizeZaxis; ++k) {
-    for ( int j = 0; j != sizeYaxis; ++j)  {
-      for ( int i = 0; i != sizeXaxis; ++i) {
-        array[sizeXaxis*sizeYaxis*k+sizeXaxis*j+i] = (*m_mapValues)[i][j][k];
-      }
-    }
-  }
+  // The map buffer has the same layout as the output array
+  std::copy_n(m_mapValues->data(), m_mapValues->num_elements(), array);
 }
 
 bool GetMap::pixelate(int xBinning, int yBinning)
@@ -532,8 +640,7 @@ bool GetMap::pixelate(int xBinning, int yBinning)
   }
 
 // Create a buffer array to reshape the member array
-  boost::multi_array<double, 3> *buffMapValues = new boost::multi_array<double, 3>
-    (boost::extents[sizeXaxis/xBinning][sizeYaxis/yBinning][sizeZaxis]);
+  MapArray *buffMapValues = newMapValues(sizeXaxis/xBinning, sizeYaxis/yBinning, sizeZaxis);
 
   typedef boost::multi_array<double, 3>::index index;
 
@@ -547,7 +654,7 @@ bool GetMap::pixelate(int xBinning, int yBinning)
   }
 
   // Delete the old array
-  delete m_mapValues;
+  deleteMapValues(m_mapValues);
   m_mapValues = buffMapValues;
 
   sizeXaxis /= xBinning;
@@ -622,27 +729,78 @@ std::vector<Record<boost::any>> records = {
 
 }
 
-void GetMap::writeMap(const std::string& filename, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam){
-  MefFile f(filename, MefFile::Permission::Overwrite);
-  const auto raster = createRaster();
-  const auto shape = raster.shape;
-  logger.info() << "writing records to primary HDU";
-  const auto &primary = f.accessPrimary<>();
-  writeImageHeader(primary, cartesianParam);
+void GetMap::writeMap(const std::string& filename, LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam,
+                      int firstPlane, int nbPlanes){
+  if (nbPlanes <= 0) {
+    nbPlanes = sizeZaxis - firstPlane;
+  }
+  if (firstPlane < 0 || nbPlanes <= 0 || firstPlane + nbPlanes > sizeZaxis) {
+    throw Elements::Exception() << "Planes " << firstPlane << " to " << firstPlane + nbPlanes - 1
+                                << " are not available in the map to write in " << filename;
+  }
+
+  {
+    MefFile f(filename, MefFile::Permission::Overwrite);
+    logger.info() << "writing records to primary HDU";
+    const auto &primary = f.accessPrimary<>();
+    writeImageHeader(primary, cartesianParam);
+  }
+
+  // The image extension is appended with CFITSIO so that the planes are streamed
+  // from the map buffer and the data can be tile compressed
+  fitsfile *fptr = nullptr;
+  int status = 0;
+  fits_open_file(&fptr, filename.c_str(), READWRITE, &status);
+  if (status != 0) {
+    throw Elements::Exception() << "Output map " << filename << " cannot be opened";
+  }
+
+  switch (cartesianParam.getMapCompression()) {
+    case MapCompression::RICE:
+      // Floats are quantized to 1/16 of the noise of each tile before compression
+      fits_set_compression_type(fptr, RICE_1, &status);
+      fits_set_quantize_level(fptr, 16., &status);
+      break;
+    case MapCompression::GZIP:
+      // No quantization: floats are compressed losslessly
+      fits_set_compression_type(fptr, GZIP_1, &status);
+      fits_set_quantize_level(fptr, 0., &status);
+      break;
+    default:
+      break;
+  }
+  if (cartesianParam.getMapCompression() != MapCompression::NONE) {
+    // One tile per plane
+    long tileDim[3] = {sizeXaxis, sizeYaxis, 1};
+    fits_set_tile_dim(fptr, 3, tileDim, &status);
+  }
+
   logger.info() << "Assigning new Image HDU";
-  //const auto &ext = f.initImageExt<float, 3>(cartesianParam.getExtName(), shape);
-  const auto &ext = f.assignImageExt(cartesianParam.getExtName(), raster);
+  long naxes[3] = {sizeXaxis, sizeYaxis, nbPlanes};
+  fits_create_img(fptr, FLOAT_IMG, 3, naxes, &status);
+  std::string extName = cartesianParam.getExtName();
+  fits_write_key(fptr, TSTRING, "EXTNAME", const_cast<char*>(extName.c_str()), nullptr, &status);
 
- // Image HDU
- //if (cartesianParam.getParaFileType() == "Conv_Patch" || cartesianParam.getExtName() == "SHEAR_PATCH") {
   //Adding extra keys to image header
-  ext.writeRecords<double, double>({ "ZMIN", m_CB.getZMin() }, { "ZMAX", m_CB.getZMax() });
- //}
- //if (cartesianParam.getExtName() == "SHEAR_PATCH") {
-  ext.writeRecords<double, double>({ "RAMIN", m_CB.getRaMin() }, { "RAMAX", m_CB.getRaMax() });
-  ext.writeRecords<double, double> ({ "DECMIN", m_CB.getDecMin() }, { "DECMAX", m_CB.getDecMax() });
-  ext.writeRecords<int, double>({ "NGAL",int(this->getNumberOfGalaxies()) },
-                                { "PIXSIZE", cartesianParam.getPixelsize() });
-// }
+  double keyValues[6] = {m_CB.getZMin(), m_CB.getZMax(), m_CB.getRaMin(), m_CB.getRaMax(),
+                         m_CB.getDecMin(), m_CB.getDecMax()};
+  const char* keyNames[6] = {"ZMIN", "ZMAX", "RAMIN", "RAMAX", "DECMIN", "DECMAX"};
+  for (int i = 0; i < 6; i++) {
+    fits_write_key(fptr, TDOUBLE, keyNames[i], &keyValues[i], nullptr, &status);
+  }
+  int nGal = int(this->getNumberOfGalaxies());
+  double pixelSize = cartesianParam.getPixelsize();
+  fits_write_key(fptr, TINT, "NGAL", &nGal, nullptr, &status);
+  fits_write_key(fptr, TDOUBLE, "PIXSIZE", &pixelSize, nullptr, &status);
+
+  // Planes are contiguous in the map buffer: CFITSIO converts them to float on the fly
+  long firstPixel[3] = {1, 1, 1};
+  fits_write_pix(fptr, TDOUBLE, firstPixel, long(sizeXaxis)*sizeYaxis*nbPlanes,
+                 m_mapValues->data() + long(sizeXaxis)*sizeYaxis*firstPlane, &status);
+  int closeStatus = 0;
+  fits_close_file(fptr, &closeStatus);
+  if (status != 0 || closeStatus != 0) {
+    throw Elements::Exception() << "Image data cannot be written in output map " << filename;
+  }
 }
 }  // namespace LE3_2D_MASS_WL_CARTESIAN
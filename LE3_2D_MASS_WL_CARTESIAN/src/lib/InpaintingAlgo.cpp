@@ -232,7 +232,7 @@ ConvergenceMap* InpaintingAlgo::performInPaintingAlgo() {
  return kappaMapIter;
 }
 
-Matrix InpaintingAlgo::applyBoundariesOnWavelets(Matrix input) {
+Matrix InpaintingAlgo::applyBoundariesOnWavelets(const Matrix& input) {
 
  std::vector<Matrix> myBand = m_MP.transformBspline(input, nbScales);
  for (int kScale=0; kScale<nbScales-1; kScale++) {
@@ -288,7 +288,8 @@ void InpaintingAlgo::multiplyWaveletCoeff (LE3_2D_MASS_WL_CARTESIAN::Matrix& Ima
    }
 }
 
-ConvergenceMap InpaintingAlgo::performInversionMask(Matrix kappaE, Matrix kappaB, bool bModeZeros){
+ConvergenceMap InpaintingAlgo::performInversionMask(const Matrix& kappaE, const Matrix& kappaB,
+                                                    bool bModeZeros){
  // Allocate memory for the kappa array
  double *kappaArray = new double[Xaxis*Yaxis*Zaxis];
  // Fill the convergence map array
@@ -25,6 +25,7 @@
 #include "LE3_2D_MASS_WL_CARTESIAN/Projection.h"
 
 #include <cmath>
+#include <algorithm>
 using namespace Euclid::WeakLensing::TwoDMass;
 using LE3_2D_MASS_WL_CARTESIAN::Projection;
 static Elements::Logging logger = Elements::Logging::getLogger("MapMaker");
@@ -32,12 +33,34 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
 
 MapMaker::MapMaker(std::vector<std::vector<double> >& inData,
           LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam):
-          inputData(inData), cartesianParam(cartesianParam)
+          inputData(&inData), cartesianParam(cartesianParam), m_CB(0., 0., 0., 0., 0., 0.),
+          m_galCount(0), m_selGalCount(0)
+{ }
+
+MapMaker::MapMaker(LE3_2D_MASS_WL_CARTESIAN::CartesianParam &cartesianParam):
+          inputData(nullptr), cartesianParam(cartesianParam), m_CB(0., 0., 0., 0., 0., 0.),
+          m_galCount(0), m_selGalCount(0)
 { }
 
 ShearMap* MapMaker::getShearMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
- std::pair<long, double*> arrayPair =
-           getMap(Euclid::WeakLensing::TwoDMass::mapType::shearMap, CB);
+ return getShearMap(makeShearCatalogView(*inputData), CB);
+}
+
+template <typename T>
+ShearMap* MapMaker::getShearMap(const ShearCatalogView<T>& data, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
+ startBinning(CB);
+ binRows(data, true, false);
+ return getBinnedShearMap();
+}
+
+ConvergenceMap* MapMaker::getConvMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
+ startBinning(CB);
+ binRows(makeShearCatalogView(*inputData), false, true);
+ return getBinnedConvMap();
+}
+
+ShearMap* MapMaker::getBinnedShearMap(){
+ std::pair<long, double*> arrayPair = getBinnedMap(Euclid::WeakLensing::TwoDMass::mapType::shearMap);
   // If there is no output return a nullptr
   if (arrayPair.second==nullptr) {
     return nullptr;
@@ -50,7 +73,7 @@ ShearMap* MapMaker::getShearMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
  int xbin = cartesianParam.getXaxis();
  int ybin = xbin;
   // Otherwise create the map
-  ShearMap *myShearMap = new ShearMap(arrayPair.second, xbin, ybin, 3, CB, arrayPair.first);
+  ShearMap *myShearMap = new ShearMap(arrayPair.second, xbin, ybin, 3, m_CB, arrayPair.first);
 
   // Destroy the memory of the array
   delete [] arrayPair.second;
@@ -60,9 +83,8 @@ ShearMap* MapMaker::getShearMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
   return myShearMap;
 }
 
-ConvergenceMap* MapMaker::getConvMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
- std::pair<long, double*> arrayPair =
-          getMap(Euclid::WeakLensing::TwoDMass::mapType::convMap, CB);
+ConvergenceMap* MapMaker::getBinnedConvMap(){
+ std::pair<long, double*> arrayPair = getBinnedMap(Euclid::WeakLensing::TwoDMass::mapType::convMap);
   // If there is no output return a nullptr
   if (arrayPair.second==nullptr) {
     return nullptr;
@@ -75,7 +97,7 @@ ConvergenceMap* MapMaker::getConvMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound&
  int xbin = cartesianParam.getXaxis();
  int ybin = xbin;
   // Otherwise create the map
-  ConvergenceMap *myConvMap = new ConvergenceMap(arrayPair.second, xbin, ybin, 3, CB, arrayPair.first);
+  ConvergenceMap *myConvMap = new ConvergenceMap(arrayPair.second, xbin, ybin, 3, m_CB, arrayPair.first);
 
   // Destroy the memory of the array
   delete [] arrayPair.second;
@@ -85,158 +107,166 @@ ConvergenceMap* MapMaker::getConvMap(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound&
   return myConvMap;
 }
 
-std::pair<long, double*> MapMaker::getMap(const Euclid::WeakLensing::TwoDMass::mapType type,
-         LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
- //int xbin, ybin;
+void MapMaker::startBinning(LE3_2D_MASS_WL_CARTESIAN::CoordinateBound& CB){
  int xbin =  cartesianParam.getXaxis();
  int ybin = cartesianParam.getYaxis();
  LE3_2D_MASS_WL_CARTESIAN::Projection Projection;
- double binXSize, binYSize;
- //double raMin, raMax, decMin, decMax;
-
- double raMin = CB.getRaMin();
- double raMax = CB.getRaMax();
- double decMin = CB.getDecMin();
- double decMax = CB.getDecMax();
- //logger.info()<<"ra min and max: "<<raMin<<" "<<raMax;
- //logger.info()<<"dec min and max: "<<decMin<<" "<<decMax;
- //logger.info()<<"z min and max: "<<CB.getZMin()<<" "<<CB.getZMax();
- //logger.info()<<"Param z min and max: "<<cartesianParam.getZMin()<<" "<<cartesianParam.getZMax();
- double ra0 = 0.5*(raMax + raMin);
- double dec0 = 0.5*(decMax + decMin);
- double raRange = (raMax - raMin);
- double decRange = (decMax - decMin);
-
- std::pair<double, double> xyMin = Projection.getGnomonicProjection(raMin, decMin, ra0, dec0);
- //xMin = xyMin.first; yMin = xyMin.second
+
+ m_CB = CB;
+ m_raMin = CB.getRaMin();
+ m_raMax = CB.getRaMax();
+ m_decMin = CB.getDecMin();
+ m_decMax = CB.getDecMax();
+ m_ra0 = 0.5*(m_raMax + m_raMin);
+ m_dec0 = 0.5*(m_decMax + m_decMin);
+ m_raRange = (m_raMax - m_raMin);
+ m_decRange = (m_decMax - m_decMin);
+
+ m_xyMin = Projection.getGnomonicProjection(m_raMin, m_decMin, m_ra0, m_dec0);
  // In case a square map is not expected, perform some basic radec projection ranges selection
  if (cartesianParam.getSquareMap() == false) {
-  std::pair<double, double> xyMax = Projection.getGnomonicProjection(raMax, decMax, ra0, dec0);
- //xMax = xyMax.first; yMin = xyMin.second
-  //logger.info()<<"xMin:"<<xyMin.first<<std::endl;
-  //logger.info()<<"xMax:"<<xyMax.first<<std::endl;
+  std::pair<double, double> xyMax = Projection.getGnomonicProjection(m_raMax, m_decMax, m_ra0, m_dec0);
   // Define the bins sizes
-  binXSize = (xyMax.first - xyMin.first)/xbin;
-  binYSize = (xyMax.second - xyMin.second)/ybin;
+  m_binXSize = (xyMax.first - m_xyMin.first)/xbin;
+  m_binYSize = (xyMax.second - m_xyMin.second)/ybin;
  } else {
-   std::pair<double, double> raDec1 =
-          Projection.getInverseGnomonicProjection(-0.5*raRange*M_PI/180., -0.5*decRange*M_PI/180., ra0, dec0);
-   std::pair<double, double> raDec2 =
-          Projection.getInverseGnomonicProjection(0, -0.5*decRange*M_PI/180., ra0, dec0);
-   std::pair<double, double> raDec3 =
-          Projection.getInverseGnomonicProjection(0.5*raRange*M_PI/180., -0.5*decRange*M_PI/180., ra0, dec0);
-   std::pair<double, double> raDec4 =
-          Projection.getInverseGnomonicProjection(0.5*raRange*M_PI/180., 0.5*decRange*M_PI/180., ra0, dec0);
-   std::pair<double, double> raDec5 =
-          Projection.getInverseGnomonicProjection(0, 0.5*decRange*M_PI/180., ra0, dec0);
-   std::pair<double, double> raDec6 =
-          Projection.getInverseGnomonicProjection(-0.5*raRange*M_PI/180., 0.5*decRange*M_PI/180., ra0, dec0);
+   std::pair<double, double> raDec1 = Projection.getInverseGnomonicProjection(-0.5*m_raRange*M_PI/180.,
+                                                                -0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
+   std::pair<double, double> raDec2 = Projection.getInverseGnomonicProjection(0,
+                                                                -0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
+   std::pair<double, double> raDec3 = Projection.getInverseGnomonicProjection(0.5*m_raRange*M_PI/180.,
+                                                                -0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
+   std::pair<double, double> raDec4 = Projection.getInverseGnomonicProjection(0.5*m_raRange*M_PI/180.,
+                                                                0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
+   std::pair<double, double> raDec5 = Projection.getInverseGnomonicProjection(0,
+                                                                0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
+   std::pair<double, double> raDec6 = Projection.getInverseGnomonicProjection(-0.5*m_raRange*M_PI/180.,
+                                                                0.5*m_decRange*M_PI/180., m_ra0, m_dec0);
 
    // Get the min and max values of ra and dec according to the geometrical effects of projection
-   raMin = raDec1.first < raDec6.first ? raDec1.first : raDec6.first;
-   decMin = raDec1.second < raDec2.second ? raDec1.second : raDec2.second;
-   raMax = raDec3.first > raDec4.first ? raDec3.first : raDec4.first;
-   decMax = raDec4.second > raDec5.second ? raDec4.second : raDec5.second;
-
-/*      logger.info()<<"ra dec 1: "<<raDec1.first<<" "<<raDec1.second;
-      logger.info()<<"ra dec 2: "<<raDec2.first<<" "<<raDec2.second;
-      logger.info()<<"ra dec 3: "<<raDec3.first<<" "<<raDec3.second;
-      logger.info()<<"ra dec 4: "<<raDec4.first<<" "<<raDec4.second;
-      logger.info()<<"ra dec 5: "<<raDec5.first<<" "<<raDec5.second;
-      logger.info()<<"ra dec 6: "<<raDec6.first<<" "<<raDec6.second;
-      logger.info()<<"ra min and max: "<<raMin<<" "<<raMax;
-      logger.info()<<"dec min and max: "<<decMin<<" "<<decMax;
-*/
-      // Define the bins sizes
-      binXSize = raRange*M_PI/180./xbin;
-      binYSize = decRange*M_PI/180./ybin;
- //logger.info()<<"binXSize: "<<binXSize<<" 	binYSize: "<<binYSize;
+   m_raMin = raDec1.first < raDec6.first ? raDec1.first : raDec6.first;
+   m_decMin = raDec1.second < raDec2.second ? raDec1.second : raDec2.second;
+   m_raMax = raDec3.first > raDec4.first ? raDec3.first : raDec4.first;
+   m_decMax = raDec4.second > raDec5.second ? raDec4.second : raDec5.second;
+
+   // Define the bins sizes
+   m_binXSize = m_raRange*M_PI/180./xbin;
+   m_binYSize = m_decRange*M_PI/180./ybin;
  }
- //double *Array = initializeArray<double>(xbin, ybin, 2);
- //double *countArray = initializeArray<double>(xbin, ybin, 1);
- double *Array = new double[xbin*ybin*2];
- std::fill_n(Array, xbin*ybin*2, 0);
- double *countArray = new double[xbin*ybin*1];
- std::fill_n(countArray, xbin*ybin*1, 0);
- unsigned int galCount = 0, selGalCount = 0; //count for galaxies watched and selected
-
- for (unsigned int i=0; i<inputData[0].size(); i++){
-  //std::vector<double> weight;
+
+ m_shearSum.assign(xbin*ybin*2, 0.);
+ m_convSum.assign(xbin*ybin, 0.);
+ m_countSum.assign(xbin*ybin, 0.);
+ m_galCount = 0;
+ m_selGalCount = 0;
+}
+
+void MapMaker::addCatalogChunk(const std::vector<std::vector<double> >& chunk){
+ addCatalogChunk(makeShearCatalogView(chunk));
+}
+
+template <typename T>
+void MapMaker::addCatalogChunk(const ShearCatalogView<T>& chunk){
+ // columns not read from the catalog are absent: only bin the maps they are needed for
+ binRows(chunk, chunk.data(G1_COLUMN) != nullptr, chunk.data(KAPPA_COLUMN) != nullptr);
+}
+
+unsigned int MapMaker::getCatalogColumns(const Euclid::WeakLensing::TwoDMass::mapType type){
+ unsigned int columns = RA_COLUMN | DEC_COLUMN | Z_COLUMN | WEIGHT_COLUMN;
+ if (type == Euclid::WeakLensing::TwoDMass::mapType::shearMap) {
+  columns |= G1_COLUMN | G2_COLUMN;
+ } else {
+  columns |= KAPPA_COLUMN;
+ }
+ return columns;
+}
+
+template <typename T>
+void MapMaker::binRows(const ShearCatalogView<T>& data, bool shear, bool convergence){
+ int xbin =  cartesianParam.getXaxis();
+ int ybin = cartesianParam.getYaxis();
+ LE3_2D_MASS_WL_CARTESIAN::Projection Projection;
+ // contiguous columns, the absent optional ones being null
+ const T* ra = data.data(RA_COLUMN);
+ const T* dec = data.data(DEC_COLUMN);
+ const T* z = data.data(Z_COLUMN);
+ const T* g1 = data.data(G1_COLUMN);
+ const T* g2 = data.data(G2_COLUMN);
+ const T* w = data.data(WEIGHT_COLUMN);
+
+ for (size_t i=0; i<data.size(); i++){
   double weight = 1.0; //if there is weight column in catalogue then use that instead of this
-  if (inputData[6].empty()==false){
-   weight = inputData[6][i];
+  if (w != nullptr){
+   weight = w[i];
   }
-  if (inputData[1][i]>= decMin && inputData[1][i]<= decMax){
-   if (inputData[0][i]>= raMin && inputData[0][i]<= raMax){
-    if (inputData[5][i]>= CB.getZMin() && inputData[5][i]<= CB.getZMax()) {
+  if (dec[i]>= m_decMin && dec[i]<= m_decMax){
+   if (ra[i]>= m_raMin && ra[i]<= m_raMax){
+    if (z[i]>= m_CB.getZMin() && z[i]<= m_CB.getZMax()) {
      int tmpx, tmpy;
+     // project the selected radec on gnomonic plan
+     std::pair<double, double> tmpXY = Projection.getGnomonicProjection(ra[i], dec[i], m_ra0, m_dec0);
+     //  calculate where it is on the binning
      if (cartesianParam.getSquareMap() == true) {
-      // project the selected radec on gnomonic plan
-      std::pair<double, double> tmpXY = Projection.getGnomonicProjection(inputData[0][i], inputData[1][i], ra0, dec0);
-      //  calculate where it is on the binning
-      tmpx = int(floor((tmpXY.first+0.5*raRange*M_PI/180.)/binXSize));
-      tmpy = int(floor((tmpXY.second+0.5*decRange*M_PI/180.)/binYSize));
+      tmpx = int(floor((tmpXY.first+0.5*m_raRange*M_PI/180.)/m_binXSize));
+      tmpy = int(floor((tmpXY.second+0.5*m_decRange*M_PI/180.)/m_binYSize));
      } else {
-      std::pair<double, double> tmpXY = Projection.getGnomonicProjection(inputData[0][i], inputData[1][i], ra0, dec0);
-      tmpx = int(floor((tmpXY.first-xyMin.first)/binXSize));
-      tmpy = int(floor((tmpXY.second-xyMin.second)/binYSize));
+      tmpx = int(floor((tmpXY.first-m_xyMin.first)/m_binXSize));
+      tmpy = int(floor((tmpXY.second-m_xyMin.second)/m_binYSize));
      }
-    // logger.info()<< "temp: "<<tmpx;
      if (tmpx>=0 && tmpx<int(xbin) && tmpy>=0 && tmpy<int(ybin)){
-      if (type == Euclid::WeakLensing::TwoDMass::mapType::shearMap){
+      if (shear == true){
        // Apply correction for the projection
-       std::pair<double, double> xy1 = Projection.getGnomonicProjection(inputData[0][i], inputData[1][i], ra0, dec0);
        std::pair<double, double> xy2 =
-                                Projection.getGnomonicProjection(inputData[0][i], (inputData[1][i]+0.01), ra0, dec0);
-       double rotationAngle = -atan((xy2.first-xy1.first)/(xy2.second-xy1.second));
-       double gamma1cor = -(inputData[3][i]*cos(2*rotationAngle)-inputData[4][i]*sin(2*rotationAngle));
-       double gamma2cor = -(inputData[3][i]*sin(2*rotationAngle)+inputData[4][i]*cos(2*rotationAngle));
-       Array[tmpy*xbin + tmpx] += gamma1cor*weight;
-       Array[xbin*ybin + tmpy*xbin + tmpx] += gamma2cor*weight;
+                                Projection.getGnomonicProjection(ra[i], (dec[i]+0.01), m_ra0, m_dec0);
+       double rotationAngle = -atan((xy2.first-tmpXY.first)/(xy2.second-tmpXY.second));
+       double gamma1cor = -(g1[i]*cos(2*rotationAngle)-g2[i]*sin(2*rotationAngle));
+       double gamma2cor = -(g1[i]*sin(2*rotationAngle)+g2[i]*cos(2*rotationAngle));
+       m_shearSum[tmpy*xbin + tmpx] += gamma1cor*weight;
+       m_shearSum[xbin*ybin + tmpy*xbin + tmpx] += gamma2cor*weight;
       }
-      if (type == Euclid::WeakLensing::TwoDMass::mapType::convMap){
-       Array[tmpy*xbin + tmpx] += inputData[2][i]*weight;
+      if (convergence == true){
+       m_convSum[tmpy*xbin + tmpx] += data.kappa(i)*weight;
       }
-      countArray[tmpy*xbin + tmpx] += weight;
-      selGalCount+=weight;
-   //  }
-   // }
-  // }
+      m_countSum[tmpy*xbin + tmpx] += weight;
+      m_selGalCount+=weight;
   } } } }
-   galCount+=weight;
- }
- logger.info()<<"number of galaxies selected: "<<selGalCount;
- logger.info()<<"over the total number of galaxies: "<<galCount;
- // Normalize the values to have the mean shear in each bin
- for (int i = 0; i<xbin*ybin; i++) {
-  if (countArray[i]>1) {
-   Array[i] /= countArray[i];
-   Array[i + xbin*ybin] /= countArray[i];
-  //}
- } }
- if (Array == nullptr){
-   logger.info()<< "INFO: data array is empty. Unable to create Shear map";
-   //return false;
-   exit (EXIT_FAILURE);
+   m_galCount+=weight;
  }
+}
 
- if (selGalCount == 0){
+template ShearMap* MapMaker::getShearMap(const ShearCatalogView<float>&, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound&);
+template ShearMap* MapMaker::getShearMap(const ShearCatalogView<double>&, LE3_2D_MASS_WL_CARTESIAN::CoordinateBound&);
+template void MapMaker::addCatalogChunk(const ShearCatalogView<float>&);
+template void MapMaker::addCatalogChunk(const ShearCatalogView<double>&);
+
+std::pair<long, double*> MapMaker::getBinnedMap(const Euclid::WeakLensing::TwoDMass::mapType type){
+ int xbin =  cartesianParam.getXaxis();
+ int ybin = cartesianParam.getYaxis();
+ logger.info()<<"number of galaxies selected: "<<m_selGalCount;
+ logger.info()<<"over the total number of galaxies: "<<m_galCount;
+
+ if (m_selGalCount == 0){
    logger.info()<< "INFO: no galaxies are selected";
    //return false;
    exit (EXIT_FAILURE);
  }
- //double *outArray = initializeArray<double>(xbin, ybin, 3);
  double *outArray = new double[xbin*ybin*3];
  std::fill_n(outArray, xbin*ybin*3, 0);
- //int sizeArray = xbin * ybin * 2;
- //int sizeCountArray = xbin * ybin *1;
- std::copy(Array, Array + (xbin * ybin * 2), outArray);
- std::copy(countArray, countArray + (xbin * ybin *1), outArray + (xbin * ybin * 2));
- // Delete dynamic arrays
- delete [] countArray;
- delete [] Array;
- return std::pair<long, double*> (selGalCount, outArray);
-
+ if (type == Euclid::WeakLensing::TwoDMass::mapType::shearMap){
+  std::copy(m_shearSum.begin(), m_shearSum.end(), outArray);
+ }
+ if (type == Euclid::WeakLensing::TwoDMass::mapType::convMap){
+  std::copy(m_convSum.begin(), m_convSum.end(), outArray);
+ }
+ // Normalize the values to have the mean shear in each bin
+ for (int i = 0; i<xbin*ybin; i++) {
+  if (m_countSum[i]>1) {
+   outArray[i] /= m_countSum[i];
+   outArray[i + xbin*ybin] /= m_countSum[i];
+  }
+ }
+ std::copy(m_countSum.begin(), m_countSum.end(), outArray + (xbin * ybin * 2));
+ return std::pair<long, double*> (m_selGalCount, outArray);
 }
 
 }  // namespace LE3_2D_MASS_WL_CARTESIAN
@@ -22,60 +22,166 @@
  */
 
 #include "LE3_2D_MASS_WL_CARTESIAN/Matrix.h"
+#include "fftw3.h"
+#include <algorithm>
+#include <limits>
 #include <iostream>
 #include "math.h"
 static Elements::Logging logger = Elements::Logging::getLogger("Matrix");
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
+namespace {
+ // Neumaier compensated addition of value to (sum, compensation)
+ inline void compensatedAdd(double& sum, double& compensation, double value) {
+  double t = sum + value;
+  if (fabs(sum) >= fabs(value)) {
+   compensation += (sum - t) + value;
+  } else {
+   compensation += (value - t) + sum;
+  }
+  sum = t;
+ }
+}
+
+double MatrixStatistics::getMean() const {
+ return sum/count;
+}
+
+double MatrixStatistics::getStandardDeviation() const {
+ return sqrt(sumSquare/count - sum*sum/count/count);
+}
+
+MatrixStatistics computeStatistics(const double *values, size_t n, size_t stride,
+                                   const double *mask, size_t maskStride) {
+ // Plain (vectorizable) sums inside blocks, compensated sums across blocks and threads
+ const long blockSize = 4096;
+ const long nBlocks = (long(n) + blockSize - 1)/blockSize;
+ double min = std::numeric_limits<double>::max();
+ double max = std::numeric_limits<double>::lowest();
+ double sum = 0., sumC = 0., sumSquare = 0., sumSquareC = 0.;
+ size_t count = 0;
+
+ #pragma omp parallel if (nBlocks > 8)
+ {
+  double tMin = std::numeric_limits<double>::max();
+  double tMax = std::numeric_limits<double>::lowest();
+  double tSum = 0., tSumC = 0., tSumSquare = 0., tSumSquareC = 0.;
+  size_t tCount = 0;
+
+  #pragma omp for nowait
+  for (long b = 0; b < nBlocks; b++) {
+   const size_t first = b*blockSize;
+   const size_t last = std::min(n, size_t(first + blockSize));
+   double bSum = 0., bSumSquare = 0.;
+   if (mask == nullptr) {
+    #pragma omp simd reduction(+:bSum, bSumSquare) reduction(min:tMin) reduction(max:tMax)
+    for (size_t i = first; i < last; i++) {
+     const double v = values[i*stride];
+     bSum += v;
+     bSumSquare += v*v;
+     tMin = v < tMin ? v : tMin;
+     tMax = v > tMax ? v : tMax;
+    }
+    tCount += last - first;
+   } else {
+    double bCount = 0.;
+    #pragma omp simd reduction(+:bSum, bSumSquare, bCount) reduction(min:tMin) reduction(max:tMax)
+    for (size_t i = first; i < last; i++) {
+     const bool in = mask[i*maskStride] != 0.;
+     const double v = in ? values[i*stride] : 0.;
+     bSum += v;
+     bSumSquare += v*v;
+     bCount += in ? 1. : 0.;
+     tMin = (in && v < tMin) ? v : tMin;
+     tMax = (in && v > tMax) ? v : tMax;
+    }
+    tCount += size_t(bCount);
+   }
+   compensatedAdd(tSum, tSumC, bSum);
+   compensatedAdd(tSumSquare, tSumSquareC, bSumSquare);
+  }
+
+  #pragma omp critical(computeStatistics)
+  {
+   min = std::min(min, tMin);
+   max = std::max(max, tMax);
+   compensatedAdd(sum, sumC, tSum + tSumC);
+   compensatedAdd(sumSquare, sumSquareC, tSumSquare + tSumSquareC);
+   count += tCount;
+  }
+ }
+
+ MatrixStatistics stats;
+ stats.min = count > 0 ? min : 0.;
+ stats.max = count > 0 ? max : 0.;
+ stats.sum = sum + sumC;
+ stats.sumSquare = sumSquare + sumSquareC;
+ stats.count = count;
+ return stats;
+}
+
 Matrix::~Matrix() {
  // Delete the m_values array if it exists
  if (m_values!=nullptr) {
-  delete [] m_values;
+  fftw_free(m_values);
   m_values = nullptr;
  }
 }
 
 Matrix::Matrix(unsigned int sizeXaxis, unsigned int sizeYaxis, double *values)
 : m_sizeXaxis(sizeXaxis), m_sizeYaxis(sizeYaxis) {
- // Allocate memory to the m_values array
- m_values = new double[m_sizeXaxis*m_sizeYaxis];
+ // Allocate aligned memory to the m_values array
+ m_values = static_cast<double*>(fftw_malloc(sizeof(double)*size()));
  // If no values are provided initialize to zeros
  if (values==nullptr) {
-  for (size_t i=0; i<m_sizeXaxis; i++) {
-   for (size_t j=0; j<m_sizeYaxis; j++) {
-    m_values[j*m_sizeXaxis + i] = 0;
-   }
-  }
+  std::fill_n(m_values, size(), 0.);
  } else {// Else initialize to the input values
-   for (size_t i=0; i<m_sizeXaxis; i++) {
-    for (size_t j=0; j<m_sizeYaxis; j++) {
-     m_values[j*m_sizeXaxis + i] = values[j*m_sizeXaxis + i];
-    }
-   }
+  std::copy_n(values, size(), m_values);
  }
 }
 
 Matrix::Matrix(const Matrix& copy): m_sizeXaxis(copy.m_sizeXaxis), m_sizeYaxis(copy.m_sizeYaxis) {
- // Allocate memory to the m_values array
- m_values = new double[m_sizeXaxis*m_sizeYaxis];
+ // Allocate aligned memory to the m_values array
+ m_values = static_cast<double*>(fftw_malloc(sizeof(double)*size()));
  // Initialize to the input values
- for (size_t i=0; i<m_sizeXaxis; i++) {
-  for (size_t j=0; j<m_sizeYaxis; j++) {
-   m_values[j*m_sizeXaxis + i] = copy.m_values[j*m_sizeXaxis + i];
-  }
- }
+ std::copy_n(copy.m_values, size(), m_values);
+}
+
+Matrix::Matrix(Matrix&& copy) noexcept: m_values(copy.m_values), m_sizeXaxis(copy.m_sizeXaxis),
+                                        m_sizeYaxis(copy.m_sizeYaxis) {
+ copy.m_values = nullptr;
+ copy.m_sizeXaxis = 0;
+ copy.m_sizeYaxis = 0;
 }
 
 Matrix& Matrix::operator= (const Matrix& copy) {
  // If objects are different, set members to same values (but different pointer memory)
  if (this!=&copy) {
+  // Reallocate only if the number of pixels differs
+  if (size() != copy.size() || m_values == nullptr) {
+   if (m_values != nullptr) {
+    fftw_free(m_values);
+   }
+   m_values = static_cast<double*>(fftw_malloc(sizeof(double)*copy.size()));
+  }
   m_sizeXaxis = copy.m_sizeXaxis;
   m_sizeYaxis = copy.m_sizeYaxis;
-  for (size_t i=0; i<m_sizeXaxis; i++) {
-   for (size_t j=0; j<m_sizeYaxis; j++) {
-    m_values[j*m_sizeXaxis + i] = copy.m_values[j*m_sizeXaxis + i];
-   }
+  std::copy_n(copy.m_values, size(), m_values);
+ }
+ return *this;
+}
+
+Matrix& Matrix::operator= (Matrix&& copy) noexcept {
+ if (this!=&copy) {
+  if (m_values != nullptr) {
+   fftw_free(m_values);
   }
+  m_values = copy.m_values;
+  m_sizeXaxis = copy.m_sizeXaxis;
+  m_sizeYaxis = copy.m_sizeYaxis;
+  copy.m_values = nullptr;
+  copy.m_sizeXaxis = 0;
+  copy.m_sizeYaxis = 0;
  }
  return *this;
 }
@@ -88,47 +194,80 @@ unsigned int Matrix::getYdim() const {
   return m_sizeYaxis;
 }
 
-Matrix Matrix::add(Matrix image) {
+size_t Matrix::size() const {
+  return size_t(m_sizeXaxis)*m_sizeYaxis;
+}
+
+Matrix Matrix::add(const Matrix& image) const {
  // Check if the sizes are the same
  if (m_sizeXaxis==image.getXdim() && m_sizeYaxis==image.getYdim()) {
   // Create an image which is the sum of this and the input image
-  Matrix output(m_sizeXaxis, m_sizeYaxis);
-  for (size_t i=0; i<m_sizeXaxis; i++) {
-   for (size_t j=0; j<m_sizeYaxis; j++) {
-    output.setValue(i, j, this->getValue(i, j) + image.getValue(i, j));
-   }
-  }
+  Matrix output(*this);
+  output += image;
   return output;
  } else {
   return Matrix(0, 0, nullptr);
  }
 }
 
-Matrix Matrix::substract(Matrix image) {
+Matrix Matrix::substract(const Matrix& image) const {
  // Check if the sizes are the same
  if (m_sizeXaxis==image.getXdim() && m_sizeYaxis==image.getYdim()) {
   // Create an image which is the substraction of this and the input image
-  Matrix output(m_sizeXaxis, m_sizeYaxis);
-  for (size_t i=0; i<m_sizeXaxis; i++) {
-   for (size_t j=0; j<m_sizeYaxis; j++) {
-    output.setValue(i, j, this->getValue(i, j) - image.getValue(i, j));
-   }
-  }
+  Matrix output(*this);
+  output -= image;
   return output;
  } else {
   return Matrix(0, 0, nullptr);
  }
 }
 
-Matrix Matrix::multiply(double factor) {
+Matrix Matrix::multiply(double factor) const {
  // Create an image which is the multiplication of this and the input factor
- Matrix output(m_sizeXaxis, m_sizeYaxis);
- for (size_t i=0; i<m_sizeXaxis; i++) {
-  for (size_t j=0; j<m_sizeYaxis; j++) {
-   output.setValue(i, j, this->getValue(i, j)*factor);
+ Matrix output(*this);
+ output *= factor;
+ return output;
+}
+
+Matrix& Matrix::operator+= (const Matrix& image) {
+ if (m_sizeXaxis==image.getXdim() && m_sizeYaxis==image.getYdim()) {
+  const double *in = image.m_values;
+  const size_t n = size();
+  for (size_t i=0; i<n; i++) {
+   m_values[i] += in[i];
   }
  }
- return output;
+ return *this;
+}
+
+Matrix& Matrix::operator-= (const Matrix& image) {
+ if (m_sizeXaxis==image.getXdim() && m_sizeYaxis==image.getYdim()) {
+  const double *in = image.m_values;
+  const size_t n = size();
+  for (size_t i=0; i<n; i++) {
+   m_values[i] -= in[i];
+  }
+ }
+ return *this;
+}
+
+Matrix& Matrix::operator*= (double factor) {
+ const size_t n = size();
+ for (size_t i=0; i<n; i++) {
+  m_values[i] *= factor;
+ }
+ return *this;
+}
+
+Matrix& Matrix::addMultiply(const Matrix& image, double factor) {
+ if (m_sizeXaxis==image.getXdim() && m_sizeYaxis==image.getYdim()) {
+  const double *in = image.m_values;
+  const size_t n = size();
+  for (size_t i=0; i<n; i++) {
+   m_values[i] += factor*in[i];
+  }
+ }
+ return *this;
 }
 
 double Matrix::getValue(int x, int y) const {
@@ -147,49 +286,30 @@ double Matrix::getValue(int x, int y) const {
 }
 
 double Matrix::getMax() const {
-// double max = m_values[0];
- double max = m_values[1];
- // Loop over all values to find the max
- for (size_t i=1; i<m_sizeXaxis*m_sizeYaxis; i++) {
-  if (m_values[i]>max) {
-   max = m_values[i];
-  }
- }
- return max;
+ return getStatistics().max;
 }
 
 double Matrix::getMin() const {
-// double min = m_values[0];
- double min = m_values[1];
- // Loop over all values to find the max
- for (size_t i=1; i<m_sizeXaxis*m_sizeYaxis; i++) {
-  if (m_values[i]<min) {
-   min = m_values[i];
-  }
- }
- return min;
+ return getStatistics().min;
 }
 
 double Matrix::getFlux() const {
-  double flux = 0.;
-  for (size_t i=1; i<m_sizeXaxis*m_sizeYaxis; i++) {
-    flux += m_values[i];
-  }
-  return flux;
+ return getStatistics().sum;
 }
 
 double Matrix::getStandardDeviation() const {
- double mean(0);
- double squareMean(0);
- unsigned int counts(0);
- // Loop over all values to find the max
- for (unsigned int i=1; i<m_sizeXaxis*m_sizeYaxis; i++) {
-  mean += m_values[i];
-  squareMean += m_values[i]*m_values[i];
-  counts++;
+ return getStatistics().getStandardDeviation();
+}
+
+MatrixStatistics Matrix::getStatistics() const {
+ return computeStatistics(m_values, size());
+}
+
+MatrixStatistics Matrix::getStatistics(const Matrix& mask) const {
+ if (m_sizeXaxis!=mask.getXdim() || m_sizeYaxis!=mask.getYdim()) {
+  return computeStatistics(m_values, 0);
  }
- double stdev = sqrt(squareMean/counts - mean*mean/counts/counts);
- return stdev;
+ return computeStatistics(m_values, size(), 1, mask.getArray());
 }
 
 void Matrix::setValue(unsigned int x, unsigned int y, double value) {
@@ -198,7 +318,7 @@ void Matrix::setValue(unsigned int x, unsigned int y, double value) {
 
 void Matrix::applyThreshold(double threshold) {
  // Loop over all values to apply the threshold
- for (size_t i=1; i<m_sizeXaxis*m_sizeYaxis; i++) {
+ for (size_t i=0; i<size(); i++) {
   if (fabs(m_values[i])<threshold) {
    m_values[i]=0;
   }
@@ -227,11 +347,7 @@ bool Matrix::isLocalMax(unsigned int x, unsigned int y) const {
 }
 
 void Matrix::reset() {
- for (size_t i=0; i<m_sizeXaxis; i++) {
-  for (size_t j=0; j<m_sizeYaxis; j++) {
-     this->setValue(i, j, 0.);
-  }
- }
+ std::fill_n(m_values, size(), 0.);
 }
 
 double* Matrix::getArray() const {
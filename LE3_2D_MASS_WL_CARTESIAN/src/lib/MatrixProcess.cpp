@@ -51,7 +51,8 @@ Matrix MatrixProcess::performDCT(Matrix input) {
 
  // Rescale the output
  double dctFactor = 2*sqrt(m_sizeXaxis*m_sizeYaxis);
- return DCToutput.multiply(1./dctFactor);
+ DCToutput *= 1./dctFactor;
+ return DCToutput;
 }
 
 Matrix MatrixProcess::performIDCT(Matrix input) {
@@ -71,7 +72,8 @@ Matrix MatrixProcess::performIDCT(Matrix input) {
  fftw_destroy_plan(IDCTplan);
  // Rescale the output
  double dctFactor = 2*sqrt(m_sizeXaxis*m_sizeYaxis);
- return output.multiply(1./dctFactor);
+ output *= 1./dctFactor;
+ return output;
 }
 
 Matrix MatrixProcess::performDCT(Matrix input, unsigned int blockSizeX, unsigned int blockSizeY, bool forward) {
@@ -102,23 +104,22 @@ Matrix MatrixProcess::performDCT(Matrix input, unsigned int blockSizeX, unsigned
  return output;
 }
 
-std::vector<Matrix> MatrixProcess::transformBspline(Matrix input, unsigned int nbScales) {
+std::vector<Matrix> MatrixProcess::transformBspline(const Matrix& input, unsigned int nbScales) {
  // Create a vector of images
  std::vector<Matrix> band;
+ band.reserve(nbScales);
  // Add the first image to this vector
  band.push_back(input);
  // Loop over the number of scales
  for (size_t step=0; step<nbScales-1; step++) {
-  // Apply the b spline transfo with algorithm a trous
-  Matrix imageOut = smoothBspline(band[step], step);
-  // Add the output image to the vector
-  band.push_back(imageOut);
-  band[step] = band[step].substract(band[step+1]);
+  // Apply the b spline transfo with algorithm a trous and add the output image to the vector
+  band.push_back(smoothBspline(band[step], step));
+  band[step] -= band[step+1];
  }
  return band;
 }
 
-Matrix MatrixProcess::smoothBspline(Matrix input, unsigned int stepTrou) {
+Matrix MatrixProcess::smoothBspline(const Matrix& input, unsigned int stepTrou) {
  // Define some values for the transform
  float h0 = 3./8.;
  float h1 = 1./4.;
@@ -147,13 +148,13 @@ Matrix MatrixProcess::smoothBspline(Matrix input, unsigned int stepTrou) {
  return imageOut;
 }
 
-Matrix MatrixProcess::reconsBspline(std::vector<Matrix> band) {
+Matrix MatrixProcess::reconsBspline(const std::vector<Matrix>& band) {
  // Create the output image
   Matrix imageOut(band[0].getXdim(), band[0].getYdim());
 
  // Just add the images from all the scales
  for (size_t i=0; i<band.size(); i++) {
-  imageOut = imageOut.add(band[i]);
+  imageOut += band[i];
  }
  return imageOut;
 }
@@ -51,7 +51,13 @@ ReconstructMR::ReconstructMR() {
 }
 
 ReconstructMR::ReconstructMR(const ReconstructMR& copy): C1(copy.C1), C2(copy.C2), Np(copy.Np),
-   TabHsGauss(copy.TabHsGauss), TabHnGauss(copy.TabHnGauss), Step(copy.Step){}
+   Step(copy.Step) {
+  // Deep copy of the tables, both objects delete their own arrays
+  TabHsGauss = new double [Np];
+  TabHnGauss = new double [Np];
+  std::copy_n(copy.TabHsGauss, Np, TabHsGauss);
+  std::copy_n(copy.TabHnGauss, Np, TabHnGauss);
+}
 
 ReconstructMR::~ReconstructMR()  {
    if (TabHnGauss  != NULL) {
@@ -63,21 +69,21 @@ ReconstructMR::~ReconstructMR()  {
    Np = 0;
 }
 
-double ReconstructMR::grad_hn_sig1(double Val) {
+double ReconstructMR::grad_hn_sig1(double Val) const {
     int Sign = (Val >= 0) ? 1: -1;
     double Coef = Val*Sign;
     Coef = Coef*std::erfc(Coef/C2) + C1 * (1-exp(-(Coef*Coef)/2.));
     return Coef*Sign;
 }
 
-double ReconstructMR::grad_hs_sig1(double Val) {
+double ReconstructMR::grad_hs_sig1(double Val) const {
      int Sign = (Val >= 0) ? 1: -1;
      double Coef = Val*Sign;
      Coef = -Coef*std::erf(Coef/C2) + C1 * (1-exp(-(Coef*Coef)/2.));
      return Coef*Sign;
 }
 
-double ReconstructMR::grad_hs(double Val) {
+double ReconstructMR::grad_hs(double Val) const {
     int Ind;
     double ValRet = 0.;
     if (Val >= 5.) {
@@ -89,7 +95,7 @@ double ReconstructMR::grad_hs(double Val) {
     return ValRet;
 }
 
-double ReconstructMR::grad_hn(double Val) {
+double ReconstructMR::grad_hn(double Val) const {
    int Ind;
    double ValRet = 0.;
    if (Val >= 5.) ValRet = TabHnGauss[Np-1];
@@ -101,7 +107,7 @@ double ReconstructMR::grad_hn(double Val) {
    return ValRet;
 }
 
-double ReconstructMR::filter (double CoefDat, double Alpha, double Sig) {
+double ReconstructMR::filter (double CoefDat, double Alpha, double Sig) const {
    double ValRet=0.;
    double Sigma=Sig;
    if (Sigma < FLOAT_EPSILON) {
@@ -44,95 +44,26 @@ namespace LE3_2D_MASS_WL_CARTESIAN {
 }
  ShearMap::ShearMap(const std::string& filename): GetMap(filename){}
 
- ShearMap::ShearMap(GetMap const& copyMap):GetMap(copyMap){}
-
-ConvergenceMap ShearMap::getConvMap(){
-  double fftFactor = 1.0/sizeXaxis/sizeYaxis;
-
-  // Create the complex maps
-  fftw_complex *gamma_complex  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *sizeXaxis*sizeYaxis);
-  fftw_complex *fft_gamma_complex  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *sizeXaxis*sizeYaxis);
-  fftw_complex *Psi_complex  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *sizeXaxis*sizeYaxis);
-  fftw_complex *fft_kappa_complex  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *sizeXaxis*sizeYaxis);
-  fftw_complex *kappa_complex  = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) *sizeXaxis*sizeYaxis);
-
-  // Create the plans for transformation
-  fftw_plan plan_k_backward;
-  fftw_plan plan_g_forward;
+ ShearMap::ShearMap(const std::string& filename, const std::string& hduName, int firstPlane, int nbPlanes):
+                GetMap(filename, hduName, firstPlane, nbPlanes){}
 
-  #pragma omp critical
-  {
-    // Create the plans for transformation
-    plan_k_backward = fftw_plan_dft_2d(sizeXaxis, sizeYaxis, fft_kappa_complex, kappa_complex,
-                                       FFTW_BACKWARD,  FFTW_MEASURE);
-    plan_g_forward = fftw_plan_dft_2d(sizeXaxis, sizeYaxis, gamma_complex, fft_gamma_complex,
-                                      FFTW_FORWARD,  FFTW_MEASURE);
-  }
-
-  // Fill the complex gamma map with shear map values
-  for ( int i=0; i<sizeXaxis; i++) {
-    for (int j=0; j<sizeYaxis; j++) {
-      gamma_complex[j*sizeXaxis +i][0] = (*m_mapValues)[i][j][0];
-      gamma_complex[j*sizeXaxis +i][1] = (*m_mapValues)[i][j][1];
-    }
-  }
+ ShearMap::ShearMap(const std::string& filename, int hduIndex, int firstPlane, int nbPlanes):
+                GetMap(filename, hduIndex, firstPlane, nbPlanes){}
 
-  // Perform the fourier transform of the complex shear map
-  fftw_execute(plan_g_forward);
-
-  // Create the P factor
-  for ( int i=0; i<sizeXaxis; i++) {
-    for ( int j=0; j<sizeYaxis; j++) {
-//        if (i+j == 0) continue;
-      int l1 = (double(i) <= double(sizeXaxis)/2. ? i : i - sizeXaxis);
-      int l2 = (double(j) <= double(sizeYaxis)/2. ? j : j - sizeYaxis);
-      Psi_complex[j*sizeXaxis +i][0] = double(l1*l1-l2*l2)/double(l1*l1+l2*l2);
-      Psi_complex[j*sizeXaxis +i][1] = -double(2.*(l1*l2))/double(l1*l1+l2*l2);
-    }
-  }
-  Psi_complex[0][0] = 0.0;
-  Psi_complex[0][1] = 0.0;
-
-  // Create the complex convergence map in Fourier space
-  for (int i=0; i<sizeXaxis; i++) {
-    for ( int j=0; j<sizeYaxis; j++) {
-      fft_kappa_complex[j*sizeXaxis+i][0] = Psi_complex[j*sizeXaxis+i][0]*fft_gamma_complex[j*sizeXaxis+i][0]
-                                             -Psi_complex[j*sizeXaxis+i][1]*fft_gamma_complex[j*sizeXaxis+i][1];
-      fft_kappa_complex[j*sizeXaxis+i][1] = Psi_complex[j*sizeXaxis+i][0]*fft_gamma_complex[j*sizeXaxis+i][1]
-                                             +Psi_complex[j*sizeXaxis+i][1]*fft_gamma_complex[j*sizeXaxis+i][0];
-    }
-  }
-
-  // Perform inverse Fourier transform to get the convergence map
-  fftw_execute(plan_k_backward);
+ ShearMap::ShearMap(GetMap const& copyMap):GetMap(copyMap){}
 
-  // Fill the convergence map
+ConvergenceMap ShearMap::getConvMap(){
+  // Copy the map, then replace its two first planes by the convergence computed with K&S
   double *kappaArray = new double[sizeXaxis*sizeYaxis*sizeZaxis];
   getArray(kappaArray);
-  for ( int i=0; i<sizeXaxis; i++) {
-    for ( int j=0; j<sizeYaxis; j++) {
-      kappaArray[j*sizeXaxis +i] = kappa_complex[j*sizeXaxis +i][0]*fftFactor;
-      kappaArray[sizeXaxis*sizeYaxis + j*sizeXaxis +i] = kappa_complex[j*sizeXaxis +i][1]*fftFactor;
-    }
-  }
+  applyKSKernel(kappaArray, true);
 
   ConvergenceMap kappaMap(kappaArray, sizeXaxis, sizeYaxis, sizeZaxis, nGalaxies);
 
   // free memory
   delete [] kappaArray;
   kappaArray = nullptr;
-
-  fftw_destroy_plan(plan_g_forward);
-  fftw_destroy_plan(plan_k_backward);
-
-  fftw_free(gamma_complex);
-  fftw_free(Psi_complex);
-  fftw_free(kappa_complex);
-  fftw_free(fft_gamma_complex);
-  fftw_free(fft_kappa_complex);
-  fftw_cleanup();
   return kappaMap;
-
 }
 
 void ShearMap::computeReducedShear(LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap& inputConvMap) {
@@ -22,12 +22,18 @@
  */
 
 #include "LE3_2D_MASS_WL_CARTESIAN/SplitCatalog.h"
+#include "ElementsKernel/Exception.h"
 
 using namespace Euclid::WeakLensing::TwoDMass;
 
 static Elements::Logging logger = Elements::Logging::getLogger("Splitting");
 namespace LE3_2D_MASS_WL_CARTESIAN {
 
+// columns of the sub-catalogs, in the order of the column names of getcolumnNames
+const std::array<unsigned int, 7> SplitCatalog::outColumns = {{RA_COLUMN, DEC_COLUMN, G1_COLUMN, G2_COLUMN,
+                                                              WEIGHT_COLUMN, Z_COLUMN, CORRECTION_COLUMN}};
+const long SplitCatalog::blockSize;
+
 SplitCatalog::SplitCatalog(std::vector<std::vector<double> >& Cat_Data, const CartesianParam& param,
           std::string& catType): InData(Cat_Data), m_cartesianParam(param), m_catType(catType) {
    m_nbZBins = m_cartesianParam.getnbZBins();
@@ -87,27 +93,9 @@ void SplitCatalog::getColname (std::vector < std::string >& columnNames) {
 
 void SplitCatalog::getEqualBinSplittedCatalogs(fs::path& datadir, std::vector<std::string>& Filenames) {
 
-   std::vector < std::string > columnNames = getcolumnNames(m_catType);
-   //getColname (columnNames);
-
-   for (size_t iter = 0; iter<m_nbZBins; iter++) {
-    const std::string filename = datadir.string() + "/" + Filenames[iter];
-    std::vector <double> temp;
-    temp = split(InData[0], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[0]);
-    temp = split(InData[1], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[1]);
-    temp = split(InData[3], m_nbZBins,  iter);
-    saveSubCatalogs (filename, temp, columnNames[2]);
-    temp = split(InData[4], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[3]);
-    temp = split(InData[5], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[4]);
-    temp = split(InData[6], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[5]);
-    temp = split(InData[7], m_nbZBins, iter);
-    saveSubCatalogs (filename, temp, columnNames[6]);
-  }
+   // equal-population bins found by selection of the redshift quantiles, without sorting the catalog
+   std::vector<std::vector<std::vector<double> > > binData = partitionBalanced(m_nbZBins, subCatalogColumns());
+   writeBins(datadir, Filenames, binData);
 }
 
 void SplitCatalog::getSplittedCatalogs(fs::path& datadir, std::vector<std::string>& Filenames) {
@@ -118,68 +106,228 @@ void SplitCatalog::getSplittedCatalogs(fs::path& datadir, std::vector<std::strin
    double t_zmin = m_zMin;
    double t_zmax= m_zMin + range;
    //logger.info()<<"zMax: "<< m_zMax <<"\t"<<"zMin: "<<m_zMin<<"\t"<<"range: "<<range;
-   std::vector < std::string > columnNames = getcolumnNames(m_catType);
-   //getColname (columnNames);
+   // bin edges accumulated as the redshift ranges of the sub-catalogs, the bins beyond zMax being dropped
+   std::vector<double> edges(1, t_zmin);
    for (size_t it = 0; it<m_nbZBins; it++) {
-    const std::string filename = datadir.string() + "/" + Filenames[it];
-    std::vector <int> indices;
-    indices.clear();
     logger.info()<<"Redshift Range for subcatalogue " << int(it+1) <<"is z_min: "<< t_zmin <<"\t"<<"z_max: "<<t_zmax;
     if (t_zmax > m_zMax) {
      logger.info() <<" Redshift values are greater than input Zmax ";
      break;
     }
- /*   for (size_t i=0; i<nGal; i++){
-      if (t_zmax<=m_zMax) {
-        if (InData[5][i] >= t_zmin && InData[5][i] < t_zmax) { //less than max and greater than and equal to min
-         indices.push_back(i);
-        }
+    edges.push_back(t_zmax);
+    t_zmin = t_zmin + range;
+    t_zmax = t_zmax + range;
+   }
+
+   std::vector<std::vector<std::vector<double> > > binData = partitionByRedshift(edges, subCatalogColumns());
+   writeBins(datadir, Filenames, binData);
+}
+
+unsigned int SplitCatalog::subCatalogColumns() {
+  unsigned int columns = 0;
+  for (unsigned int col : outColumns) {
+    columns |= col;
+  }
+  return columns;
+}
+
+void SplitCatalog::writeBins(fs::path& datadir, std::vector<std::string>& Filenames,
+                             std::vector<std::vector<std::vector<double> > >& binData) {
+   std::vector < std::string > columnNames = getcolumnNames(m_catType);
+   //getColname (columnNames);
+   // each bin goes to its own file, the bins being released as soon as written. The bins are
+   // written one after the other: CFITSIO is not reentrant, and the partition is already parallel
+   for (size_t it = 0; it < binData.size(); it++) {
+    const std::string filename = datadir.string() + "/" + Filenames[it];
+    saveSubCatalog(filename, binData[it], columnNames);
+    std::vector<std::vector<double> >().swap(binData[it]);
+   }
+   logger.info()<<"number of created subcatalogs: "<<int(binData.size());
+}
+
+std::vector<std::vector<std::vector<double> > > SplitCatalog::partitionByRedshift(const std::vector<double>& edges,
+                                                                                unsigned int columns) const {
+  const size_t nBins = edges.size() > 1 ? edges.size() - 1 : 0;
+  const std::vector<double>& redshift = InData[5];
+  const long nGal = long(redshift.size());
+  const long nBlocks = (nGal + blockSize - 1) / blockSize;
+
+  // first pass: bin of each row (nBins for the rows out of the bins) and number of rows per bin in each block
+  std::vector<unsigned int> binOfRow(nGal);
+  std::vector<size_t> blockCounts(nBlocks * (nBins + 1), 0);
+  #pragma omp parallel for if (nBlocks > 1)
+  for (long block = 0; block < nBlocks; block++) {
+    size_t* counts = &blockCounts[block * (nBins + 1)];
+    const long end = std::min(nGal, (block + 1) * blockSize);
+    for (long i = block * blockSize; i < end; i++) {
+      // z in [edges[k], edges[k+1]) gives k+1; below the first edge, from the last edge or NaN give 0 or nBins+1
+      const size_t k = std::upper_bound(edges.begin(), edges.end(), redshift[i]) - edges.begin();
+      const unsigned int bin = (k == 0 || k > nBins) ? nBins : k - 1;
+      binOfRow[i] = bin;
+      counts[bin]++;
+    }
+  }
+
+  return scatterRows(binOfRow, blockCounts, nBins, columns);
+}
+
+std::vector<std::vector<std::vector<double> > > SplitCatalog::partitionBalanced(size_t nBins,
+                                                                              unsigned int columns) const {
+  const std::vector<double>& redshift = InData[5];
+  const long nGal = long(redshift.size());
+  const long nBlocks = (nGal + blockSize - 1) / blockSize;
+  if (nBins == 0) {
+    throw Elements::Exception() << "The number of balanced redshift bins must be positive";
+  }
+
+  // redshifts of the rows, the rows without redshift (NaN) being out of the bins
+  std::vector<double> values;
+  values.reserve(nGal);
+  for (long i = 0; i < nGal; i++) {
+    if (std::isnan(redshift[i]) == false) {
+      values.push_back(redshift[i]);
+    }
+  }
+  // as for the equal split of the sorted catalog, bin k gets the ranks [k*quotient, (k+1)*quotient)
+  // in the redshift order (ties in the catalog order), the last values.size() % nBins ranks being left out
+  const size_t quotient = values.size() / nBins;
+  const size_t nRanks = quotient * nBins;
+
+  // thresholds: redshift of the first rank of each bin and of the first rank left out, found by successive
+  // selections on the part of the values not yet ordered
+  std::vector<double> thresholds;
+  std::vector<double>::iterator first = values.begin();
+  for (size_t bin = 1; bin <= nBins && quotient > 0; bin++) {
+    const size_t rank = bin * quotient;
+    if (rank >= values.size()) {
+      break;
+    }
+    std::vector<double>::iterator nth = values.begin() + rank;
+    std::nth_element(first, nth, values.end());
+    thresholds.push_back(*nth);
+    first = nth;
+  }
+  thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+  std::vector<double>().swap(values);
+
+  // the redshifts are grouped in buckets: 2j+1 for the rows equal to the threshold j and 2j for the rows
+  // strictly between the thresholds j-1 and j. Bin boundaries only fall inside the buckets of thresholds,
+  // so all the rows of the other buckets share a bin, the rank of their first row
+  const size_t nBuckets = 2 * thresholds.size() + 1;
+  auto bucketOf = [&thresholds](double z) {
+    const size_t j = std::lower_bound(thresholds.begin(), thresholds.end(), z) - thresholds.begin();
+    return (j < thresholds.size() && thresholds[j] == z) ? 2 * j + 1 : 2 * j;
+  };
+
+  // first pass: number of rows per bucket in each block
+  std::vector<size_t> blockBuckets(nBlocks * nBuckets, 0);
+  #pragma omp parallel for if (nBlocks > 1)
+  for (long block = 0; block < nBlocks; block++) {
+    size_t* counts = &blockBuckets[block * nBuckets];
+    const long end = std::min(nGal, (block + 1) * blockSize);
+    for (long i = block * blockSize; i < end; i++) {
+      if (std::isnan(redshift[i]) == false) {
+        counts[bucketOf(redshift[i])]++;
       }
-      if ((m_nbZBins % 2 == 1) && t_zmax > m_zMax) { //left overs
-        if (InData[5][i] >= t_zmin && InData[5][i] <= m_zMax){
-         indices.push_back(i);
+    }
+  }
+
+  // first rank of each bucket, and first rank of each block inside the buckets
+  std::vector<size_t> bucketRanks(nBuckets, 0);
+  for (long block = 0; block < nBlocks; block++) {
+    size_t* counts = &blockBuckets[block * nBuckets];
+    for (size_t bucket = 0; bucket < nBuckets; bucket++) {
+      const size_t count = counts[bucket];
+      counts[bucket] = bucketRanks[bucket];
+      bucketRanks[bucket] += count;
+    }
+  }
+  size_t rank = 0;
+  for (size_t bucket = 0; bucket < nBuckets; bucket++) {
+    const size_t count = bucketRanks[bucket];
+    bucketRanks[bucket] = rank;
+    rank += count;
+  }
+
+  // second pass: rank of each row, hence its bin, and number of rows per bin in each block
+  std::vector<unsigned int> binOfRow(nGal);
+  std::vector<size_t> blockCounts(nBlocks * (nBins + 1), 0);
+  #pragma omp parallel for if (nBlocks > 1)
+  for (long block = 0; block < nBlocks; block++) {
+    std::vector<size_t> next(blockBuckets.begin() + block * nBuckets, blockBuckets.begin() + (block + 1) * nBuckets);
+    size_t* counts = &blockCounts[block * (nBins + 1)];
+    const long end = std::min(nGal, (block + 1) * blockSize);
+    for (long i = block * blockSize; i < end; i++) {
+      unsigned int bin = nBins;
+      if (std::isnan(redshift[i]) == false) {
+        const size_t bucket = bucketOf(redshift[i]);
+        const size_t rowRank = bucketRanks[bucket] + ((bucket % 2 == 1) ? next[bucket]++ : 0);
+        if (rowRank < nRanks) {
+          bin = rowRank / quotient;
         }
       }
-   }*/
-   getIndices(indices, t_zmin, t_zmax);
-   indices.shrink_to_fit();
-   std::vector <double> temp;
-   temp = extract_at(InData[0], indices);
-   saveSubCatalogs (filename, temp, columnNames[0]);
-   temp = extract_at(InData[1], indices);
-   saveSubCatalogs (filename, temp, columnNames[1]);
-   temp = extract_at(InData[3], indices);
-   saveSubCatalogs (filename, temp, columnNames[2]);
-   temp = extract_at(InData[4], indices);
-   saveSubCatalogs (filename, temp, columnNames[3]);
-   temp =  extract_at(InData[5], indices);
-   saveSubCatalogs (filename, temp, columnNames[4]);
-   temp = extract_at(InData[6], indices);
-   saveSubCatalogs (filename, temp, columnNames[5]);
-   temp = extract_at(InData[7], indices);
-   saveSubCatalogs (filename, temp, columnNames[6]);
-
-   logger.info()<<"number of created subcatalogs: "<<int(it+1);
-   t_zmin = t_zmin + range;
-   t_zmax = t_zmax + range;
+      binOfRow[i] = bin;
+      counts[bin]++;
+    }
   }
+
+  return scatterRows(binOfRow, blockCounts, nBins, columns);
 }
 
-void SplitCatalog::getIndices(std::vector < int >& Indices, double t_zmin, double t_zmax) {
-      unsigned int nGal=0;
-      nGal = InData[0].size();
-      for (size_t i=0; i<nGal; i++){
-      if (t_zmax<=m_zMax) {
-        if (InData[5][i] >= t_zmin && InData[5][i] < t_zmax) { //less than max and greater than and equal to min
-         Indices.push_back(i);
-        }
-      }
-      if ((m_nbZBins % 2 == 1) && t_zmax > m_zMax) { //left overs
-        if (InData[5][i] >= t_zmin && InData[5][i] <= m_zMax){
-         Indices.push_back(i);
+std::vector<std::vector<std::vector<double> > > SplitCatalog::scatterRows(const std::vector<unsigned int>& binOfRow,
+                                        std::vector<size_t>& blockCounts, size_t nBins, unsigned int columns) const {
+  const long nGal = long(binOfRow.size());
+  const long nBlocks = (nGal + blockSize - 1) / blockSize;
+
+  // first row of each block in each bin (exclusive prefix sum over the blocks), keeping the input order
+  std::vector<size_t> binSizes(nBins, 0);
+  for (long block = 0; block < nBlocks; block++) {
+    size_t* counts = &blockCounts[block * (nBins + 1)];
+    for (size_t bin = 0; bin < nBins; bin++) {
+      const size_t count = counts[bin];
+      counts[bin] = binSizes[bin];
+      binSizes[bin] += count;
+    }
+  }
+
+  std::vector<size_t> selected;
+  for (size_t col = 0; col < InData.size() && col < ShearCatalogView<double>::nbColumns; col++) {
+    if ((columns & (1u << col)) != 0 && InData[col].empty() == false) {
+      selected.push_back(col);
+    }
+  }
+  std::vector<std::vector<std::vector<double> > > binData(nBins,
+                                      std::vector<std::vector<double> >(ShearCatalogView<double>::nbColumns));
+  for (size_t bin = 0; bin < nBins; bin++) {
+    for (size_t col : selected) {
+      binData[bin][col].resize(binSizes[bin]);
+    }
+  }
+
+  // second pass: each block scatters its rows at its own offsets of the bins, column by column
+  #pragma omp parallel for if (nBlocks > 1)
+  for (long block = 0; block < nBlocks; block++) {
+    const size_t* offsets = &blockCounts[block * (nBins + 1)];
+    const long end = std::min(nGal, (block + 1) * blockSize);
+    std::vector<size_t> next(nBins);
+    for (size_t col : selected) {
+      const double* in = InData[col].data();
+      std::copy(offsets, offsets + nBins, next.begin());
+      for (long i = block * blockSize; i < end; i++) {
+        const unsigned int bin = binOfRow[i];
+        if (bin < nBins) {
+          binData[bin][col][next[bin]++] = in[i];
         }
       }
-   }
+    }
+  }
+
+  return binData;
+}
+
+unsigned int SplitCatalog::getCatalogColumns(){
+  // only the columns written in the sub-catalogs are read, kappa is not
+  return subCatalogColumns();
 }
 
 bool SplitCatalog::writeSubCatalogs(fs::path& datadir, std::vector<std::string>& Filenames){
@@ -207,20 +355,24 @@ bool SplitCatalog::writeSubCatalogs(fs::path& datadir, std::vector<std::string>&
 return true;
 }
 
-bool SplitCatalog::saveSubCatalogs (const std::string& filename, std::vector<double>& Data, const std::string &colname){
-  if (access( filename.c_str(), F_OK ) != -1 ) {
-    MefFile outfile(filename, MefFile::Permission::Edit);
-    const auto col = generateColumn<double>(colname, Data);
-    long nbHdu = outfile.hduCount();
-    const auto &ext = outfile.access<BintableHdu>(nbHdu-1);
-    ext.appendColumn(col);
-  } else {
-    MefFile outfile(filename, MefFile::Permission::Overwrite);
-    const auto col = generateColumn<double>(colname, Data);
-    outfile.assignBintableExt("", col); // Unnamed extension
-  }
-
- return true;
+bool SplitCatalog::saveSubCatalog (const std::string& filename, const std::vector<std::vector<double> >& binData,
+                                    const std::vector<std::string>& columnNames) {
+  std::vector<std::vector<double> > emptyColumns(outColumns.size());
+  auto column = [&](size_t col) -> const std::vector<double>& {
+    const size_t index = ShearCatalogView<double>::columnIndex(ShearColumns(outColumns[col]));
+    return index < binData.size() ? binData[index] : emptyColumns[col];
+  };
+  // all the columns are written at once in a new table
+  MefFile outfile(filename, MefFile::Permission::Overwrite);
+  outfile.assignBintableExt("", // Unnamed extension
+                            generateColumn<double>(columnNames[0], column(0)),
+                            generateColumn<double>(columnNames[1], column(1)),
+                            generateColumn<double>(columnNames[2], column(2)),
+                            generateColumn<double>(columnNames[3], column(3)),
+                            generateColumn<double>(columnNames[4], column(4)),
+                            generateColumn<double>(columnNames[5], column(5)),
+                            generateColumn<double>(columnNames[6], column(6)));
+  return true;
 }
 
 }  // namespace LE3_2D_MASS_WL_CARTESIAN
@@ -92,6 +92,11 @@ public:
    options.add_options()
    ("MCConvergenceMaps", po::value<string>()->default_value(""), "MC convergence Maps Name in txt/jason file");
 
+   // tile compression of the MC maps
+   options.add_options()
+   ("mapCompression", po::value<int>()->default_value(0),
+    "tile compression of the MC maps (0-> None, 1-> Rice and 2-> GZIP)");
+
     return options;
   }
 
@@ -134,6 +139,12 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   CartesianParam Patchparams;
   readParameterFile ((workdir/inPatchParamFile), Patchparams);
+  int mapCompression = args["mapCompression"].as<int>();
+  if (mapCompression < 0 || mapCompression > 2) {
+   logger.info()<< "Unknown map compression " << mapCompression << ", maps are written uncompressed";
+   mapCompression = 0;
+  }
+  Patchparams.setMapCompression(static_cast<MapCompression>(mapCompression));
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Variable to save input catalog name
@@ -41,6 +41,7 @@
 #include "LE3_2D_MASS_WL_UTILITIES/NoisyCatalogData.h"
 #include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h"
 
 namespace po = boost::program_options;
 
@@ -178,6 +179,12 @@ public:
   // get Shear catalog Data
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    ReadCatalog read;
+   // Only read the columns of the requested maps
+   unsigned int columns = LE3_2D_MASS_WL_CARTESIAN::MapMaker::getCatalogColumns(mapType::shearMap);
+   if ((ConvergenceMap.string()).empty() == false) {
+     columns |= LE3_2D_MASS_WL_CARTESIAN::MapMaker::getCatalogColumns(mapType::convMap);
+   }
+   read.setColumns(columns);
    read.readShearCatalog(workdir, InCatalog, catData);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -260,6 +267,9 @@ public:
    std::ofstream outfile;
    outfile.open ((workdir /output_shearMaps).string(), std::ios_base::app);
    outfile << "[";
+   // The maps are written in the background while the next realisation is computed. CFITSIO is not
+   // reentrant: the convergence maps go through the same writer, the loop itself making no FITS call
+   AsyncWriter writer;
  for (size_t it=0; it<centerX.size(); it++){
    //logger.info() << "Center: " << centerX[it] << "	" << centerY[it];
    //logger.info() << "Cluster Id: " << std::setprecision (15)<< clusterId[it];
@@ -276,7 +286,7 @@ public:
    if ((ConvergenceMap.string()).empty() == false) {
     logger.info("creating convergence Map");
    // ConvergenceMap = data_dir / fs::path("EUC_LE3_WL_ConvergenceMap_"  + getDateTimeString() + ".fits");
-    CartesainAlgo.extractConvergnceMap ((datadir /ConvergenceMap).native(), catData, m_CB);
+    CartesainAlgo.extractConvergnceMap ((datadir /ConvergenceMap).native(), catData, m_CB, writer);
    }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -286,7 +296,7 @@ public:
    if ((true == ShearMap.string().empty())) {
     ShearMap = fs::path("ShearMap_0" + std::to_string(it) + "_" + getDateTimeString() + ".fits");
    }
-   CartesainAlgo.extractShearMap ((datadir /ShearMap).native(), catData, m_CB);
+   CartesainAlgo.extractShearMap ((datadir /ShearMap).native(), makeShearCatalogView(catData), m_CB, writer);
    outfile << ShearMap.filename();
    if (it < centerX.size()-1) {
      outfile << ",";
@@ -296,13 +306,15 @@ public:
   logger.info("creating associated snr shear Maps");
    if(params.getNSamples() > 0) {
     outfile << ",";
+    // The realisations only replace the shear columns of the catalog, reused between samples
+    ShearCatalogView<double> catView = makeShearCatalogView(catData);
+    ShearCatalog<double> noisyShear;
+    NoisyCatalogData randomise;
     for (int iter = 0; iter < params.getNSamples(); ++iter) {
-      std::vector<std::vector<double> > RanData;
-      NoisyCatalogData randomise;
-      RanData = randomise.create_noisy_data(catData);
+      ShearCatalogView<double> RanData = randomise.create_noisy_data(catView, noisyShear);
       ShearMap = fs::path("ShearMap_0" + std::to_string(it) + "_NReSample_0" + std::to_string(iter) + "_" +
                                          getDateTimeString() + ".fits");
-      CartesainAlgo.extractShearMap ((datadir / ShearMap).native(), RanData, m_CB);
+      CartesainAlgo.extractShearMap ((datadir / ShearMap).native(), RanData, m_CB, writer);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Generate the json/txt product
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -316,6 +328,7 @@ public:
  } //end of for loop
    outfile << "]";
    outfile.close();
+   writer.wait();
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  //End of patch extraction
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
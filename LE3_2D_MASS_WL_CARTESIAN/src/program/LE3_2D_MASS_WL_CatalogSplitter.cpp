@@ -61,50 +61,6 @@ using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
 
 static Elements::Logging logger = Elements::Logging::getLogger("LE3_2D_MASS_WL_CatalogSplitter");
 
-/**
- *  @brief    Template to sort indices of a vector
- *  @param    v <vector<T> >, vector to sort
- *  @return   vector of sorted indices
-*/
-template <typename T>
-std::vector<size_t> sort_indexes(const std::vector<T> &v) {
-  // initialize original index locations
-  std::vector<size_t> idx(v.size());
-  for (size_t i = 0; i != idx.size(); ++i) {
-    idx[i] = i;
-  }
-  // sort indexes based on comparing values in v
-  // using std::stable_sort instead of std::sort
-  // to avoid unnecessary index re-orderings
-  // when v contains elements of equal values
-  stable_sort(idx.begin(), idx.end(),
-       [&v](size_t i1, size_t i2) {
-   return v[i1] < v[i2];
-  });
-  return idx;
-}
-
-void getSortedData(std::vector<std::vector<double> >& Data) {
-   std::vector <double> sorted_ra, sorted_dec, sorted_kappa, sorted_g1, sorted_g2, sorted_z, sorted_weight;
-   for (auto i : sort_indexes(Data[5])) {
-    sorted_ra.push_back(Data[0][i]);
-    sorted_dec.push_back(Data[1][i]);
-    sorted_z.push_back(Data[5][i]);
-    sorted_kappa.push_back(Data[2][i]);
-    sorted_g1.push_back(Data[3][i]);
-    sorted_g2.push_back(Data[4][i]);
-    sorted_weight.push_back(Data[6][i]);
-   }
-   Data.clear();
-   Data.push_back(sorted_ra);
-   Data.push_back(sorted_dec);
-   Data.push_back(sorted_kappa);
-   Data.push_back(sorted_g1);
-   Data.push_back(sorted_g2);
-   Data.push_back(sorted_z);
-   Data.push_back(sorted_weight);
-}
-
 // This makes the sort be according to redshift column and ascending
 /*bool sortFunc( const vector<double>& z1,
            const vector<double>& z2 ) {
@@ -235,6 +191,7 @@ public:
   std::vector<std::vector<double> > catData;
   std::string m_catType="LENSMC";
 
+  read.setColumns(LE3_2D_MASS_WL_CARTESIAN::SplitCatalog::getCatalogColumns());
   read.readShearCatalog(workdir, Input_Catalog, catData);
   m_catType = read.getCatalogReadType();
 
@@ -253,12 +210,7 @@ public:
                                  std::to_string(i)+ "_" + getDateTimeString() + ".fits")).string();
      SubCatFilenames.push_back(subCatalogName);
   }
-  if (m_balancedBins == 1) {
-    getSortedData(catData);
-  // Do the sorting according to redshift
-   // std::sort(catData.begin(), catData.end(), sortFunc);
-   //std::stable_sort(catData.begin(), catData.end(), sortFunc);
-  }
+  // balanced bins are found by SplitCatalog from the redshift quantiles, the catalog needs no sorting
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Splitting Input catalog
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
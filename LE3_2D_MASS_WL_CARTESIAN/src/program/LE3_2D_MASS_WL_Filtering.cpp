@@ -46,6 +46,8 @@
 #include <iostream>
 #include <cmath>
 #include <iomanip>
+#include <fstream>
+#include <memory>
 
 namespace po = boost::program_options;
 using std::string;
@@ -59,6 +61,7 @@ using boost::program_options::options_description;
 using boost::program_options::variable_value;
 using namespace dpd::le3::wl::twodmass::inp::paramsconvergencepatch;
 using LE3_2D_MASS_WL_CARTESIAN::FilterMR;
+using LE3_2D_MASS_WL_CARTESIAN::ReconstructMR;
 
 static Elements::Logging logger = Elements::Logging::getLogger("LE3_2D_MASS_WL_Filtering");
 
@@ -77,9 +80,9 @@ public:
    options.add_options()
    ("logdir", po::value<string>()->default_value(""), "logs Directory");
 
-   // input catalog file
+   // input convergence map file
    options.add_options()
-   ("inmap", po::value<string>()->default_value(""), "input map");
+   ("inmap", po::value<string>()->default_value(""), "input map in fits format or list of maps in json format");
 
    // input parameter file
    options.add_options()
@@ -104,6 +107,10 @@ public:
    // output file
    options.add_options()
    ("outputMap", po::value<string>()->default_value(""), "Output Map in fits format"); 
+
+   // output list of files (json input only)
+   options.add_options()
+   ("outputMaps", po::value<string>()->default_value(""), "Output list of filtered Maps in json format");
     return options;
   }
 
@@ -129,6 +136,7 @@ public:
    fs::path ParameterFile {args["paramFile"].as<std::string>()};
    fs::path logPath (args["logdir"].as<string>());
    fs::path DenoisedMap {args["outputMap"].as<std::string>()};
+   fs::path DenoisedMaps {args["outputMaps"].as<std::string>()};
    fs::path datadir {workdir / "data"};
    bool positiveCons = true; //{args["positiveCons"].as<int>()};
    bool KillLastScale = true; //{args["KillLastScale"].as<int>()};
@@ -166,19 +174,61 @@ public:
   CartesianParam params;
   readParameterFile ((workdir/ParameterFile), params);
   logger.info()<< "FDR_val = " << params.getThreshold();
-  //if(params.getThreshold() > 0.) {
-    LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *m_ConvergenceMap;
-    m_ConvergenceMap = new LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap((workdir/Inmap).native());
+  // Multiscale entropy lookup tables, built once and shared by all the filtered maps
+  std::shared_ptr<const ReconstructMR> restore = std::make_shared<const ReconstructMR>();
 
-    FilterMR filter(*m_ConvergenceMap, positiveCons, KillLastScale, KillIsol, nbIter, FirstScale, params);
+  std::string timeNamePart = getDateTimeString();
+  if (true == checkFileType((workdir/Inmap).native(), Euclid::WeakLensing::TwoDMass::signFITS)) {
+    ConvergenceMap convMap((workdir/Inmap).native());
 
-    LE3_2D_MASS_WL_CARTESIAN::ConvergenceMap *myconvMap = filter.performFiltering();
+    FilterMR filter(convMap, positiveCons, KillLastScale, KillIsol, nbIter, FirstScale, params, restore);
+
+    ConvergenceMap *myconvMap = filter.performFiltering();
 
-    std::string timeNamePart = getDateTimeString();
     if (true == DenoisedMap.string().empty())
        DenoisedMap = fs::path("EUC_LE3_WL_DenoisedMap_" + timeNamePart + ".fits");
-     myconvMap->writeMap((workdir / DenoisedMap).native(), params);
-  //}
+    myconvMap->writeMap((workdir / DenoisedMap).native(), params);
+    delete myconvMap;
+  } else { // input maps in json file
+    std::vector<fs::path> filenames = read_filenames(workdir, Inmap);
+    std::vector<fs::path> outFilenames(filenames.size());
+    logger.info() << "number of maps to filter: " << filenames.size();
+
+    // Maps are independent, the thread pool takes them one at a time
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < filenames.size(); i++) {
+      ConvergenceMap *convMap = nullptr;
+      #pragma omp critical(Filtering_fitsio)
+      {
+        convMap = new ConvergenceMap((datadir/filenames[i]).native());
+      }
+
+      FilterMR filter(*convMap, positiveCons, KillLastScale, KillIsol, nbIter, FirstScale, params, restore);
+      ConvergenceMap *myconvMap = filter.performFiltering();
+
+      outFilenames[i] = fs::path("EUC_LE3_WL_DenoisedMap_" + std::to_string(i) + "_" + timeNamePart + ".fits");
+      #pragma omp critical(Filtering_fitsio)
+      {
+        myconvMap->writeMap((datadir/outFilenames[i]).native(), params);
+      }
+      delete myconvMap;
+      delete convMap;
+    }
+
+    if (true == DenoisedMaps.string().empty())
+       DenoisedMaps = fs::path("DenoisedMapsList_" + timeNamePart + ".json");
+    std::ofstream outfile;
+    outfile.open((workdir / DenoisedMaps).string());
+    outfile << "[";
+    for (size_t i = 0; i < outFilenames.size(); i++) {
+      outfile << outFilenames[i].filename();
+      if (i < outFilenames.size()-1) {
+        outfile << ",";
+      }
+    }
+    outfile << "]";
+    outfile.close();
+  }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  //End of Filtering
@@ -26,6 +26,7 @@
 #include <boost/filesystem/fstream.hpp>
 #include "ElementsKernel/Auxiliary.h"
 #include "ElementsKernel/Temporary.h" 
+#include "ElementsKernel/Exception.h"
 #include "LE3_2D_MASS_WL_CARTESIAN/CartesianParam.h"
 #include "LE3_2D_MASS_WL_CARTESIAN/GetMap.h"
 
@@ -153,6 +154,75 @@ BOOST_FIXTURE_TEST_CASE( filenameConstructor_test, GetMapFixture)
 
 //-----------------------------------------------------------------------------
 
+BOOST_FIXTURE_TEST_CASE( filenameSelection_test, GetMapFixture)
+{
+ Elements::TempDir tempDir;
+ std::string filename = (tempDir.path() / "GetMap_selection_test.fits").string();
+ CartesianParam params;
+ std::string extName = "SELECTION_TEST";
+ params.setExtName(extName);
+ myArrayTestMap->writeMap(filename, params);
+
+ // Whole image, by name and by index (Primary is index 0)
+ GetMap fullMap(filename);
+ GetMap namedMap(filename, extName);
+ GetMap indexedMap(filename, 1);
+ BOOST_CHECK_EQUAL(fullMap.getZdim(), zSize);
+ BOOST_CHECK_EQUAL(namedMap.getZdim(), zSize);
+ BOOST_CHECK_EQUAL(indexedMap.getZdim(), zSize);
+ BOOST_CHECK_EQUAL(namedMap.getNumberOfGalaxies(), nGalaxies);
+
+ // Second plane only
+ GetMap planeMap(filename, extName, 1, 1);
+ BOOST_CHECK_EQUAL(planeMap.getXdim(), xSize);
+ BOOST_CHECK_EQUAL(planeMap.getYdim(), ySize);
+ BOOST_CHECK_EQUAL(planeMap.getZdim(), 1);
+ for (int i=0; i<xSize; i++) {
+  for (int j=0; j<ySize; j++) {
+   BOOST_CHECK_CLOSE(fullMap.getBinValue(i, j, 0), mapUniformValueZ0, 0.0001);
+   BOOST_CHECK_CLOSE(planeMap.getBinValue(i, j, 0), mapUniformValueZ0 + mapUniformValueZ1, 0.0001);
+  }
+ }
+
+ // Unknown HDU or planes out of range
+ BOOST_CHECK_THROW(GetMap(filename, "NO_SUCH_HDU"), Elements::Exception);
+ BOOST_CHECK_THROW(GetMap(filename, extName, 1, 2), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE( compressedWriter_test, GetMapFixture)
+{
+ Elements::TempDir tempDir;
+ std::string gzipFilename = (tempDir.path() / "GetMap_gzip_test.fits").string();
+ std::string riceFilename = (tempDir.path() / "GetMap_rice_test.fits").string();
+ CartesianParam params;
+
+ // Second plane only, losslessly compressed
+ params.setMapCompression(MapCompression::GZIP);
+ myArrayTestMap->writeMap(gzipFilename, params, 1, 1);
+ GetMap gzipMap(gzipFilename);
+ BOOST_CHECK_EQUAL(gzipMap.getZdim(), 1);
+ BOOST_CHECK_EQUAL(gzipMap.getNumberOfGalaxies(), nGalaxies);
+
+ // All planes, quantized
+ params.setMapCompression(MapCompression::RICE);
+ myArrayTestMap->writeMap(riceFilename, params);
+ GetMap riceMap(riceFilename);
+ BOOST_CHECK_EQUAL(riceMap.getZdim(), zSize);
+
+ for (int i=0; i<xSize; i++) {
+  for (int j=0; j<ySize; j++) {
+   BOOST_CHECK_CLOSE(gzipMap.getBinValue(i, j, 0), mapUniformValueZ0 + mapUniformValueZ1, 0.0001);
+   BOOST_CHECK_CLOSE(riceMap.getBinValue(i, j, 0), mapUniformValueZ0, 1);
+  }
+ }
+
+ BOOST_CHECK_THROW(myArrayTestMap->writeMap(gzipFilename, params, zSize, 1), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_FIXTURE_TEST_CASE( copyConstructor_test, GetMapFixture)
 {
   // Create a Map using the copy constructor
@@ -35,6 +35,7 @@
 #include <ios>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 using namespace Euclid::WeakLensing::TwoDMass;
 using namespace LE3_2D_MASS_WL_CARTESIAN;
@@ -143,4 +144,47 @@ BOOST_FIXTURE_TEST_CASE( get_convMap_test, MapMakerTestEnv) {
   m_ConvergenceMap = nullptr;
 }
 //-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE( get_chunkMaps_test, MapMakerTestEnv) {
+  logger.info() <<"get_chunkMaps_test";
+  CoordinateBound m_CB(rmin, params.getRaMax(rmin), dmin, params.getDecMax(dmin), zmin, zmax);
+  MapMaker map(testCatData,  params);
+  m_ShearMap = map.getShearMap(m_CB);
+  m_ConvergenceMap = map.getConvMap(m_CB);
+
+  // Bin the same catalog by chunks of 50 rows, both maps in a single pass
+  MapMaker chunkMap(params);
+  chunkMap.startBinning(m_CB);
+  for (size_t first = 0; first < testCatData[0].size(); first += 50) {
+    size_t last = std::min(first + 50, testCatData[0].size());
+    std::vector<std::vector<double> > chunk;
+    for (const auto& column : testCatData) {
+      chunk.emplace_back(column.begin() + first, column.begin() + last);
+    }
+    chunkMap.addCatalogChunk(chunk);
+  }
+  ShearMap *chunkShearMap = chunkMap.getBinnedShearMap();
+  ConvergenceMap *chunkConvMap = chunkMap.getBinnedConvMap();
+  BOOST_REQUIRE(m_ShearMap != nullptr && chunkShearMap != nullptr);
+  BOOST_REQUIRE(m_ConvergenceMap != nullptr && chunkConvMap != nullptr);
+
+  BOOST_CHECK_EQUAL(chunkShearMap->getNumberOfGalaxies(), m_ShearMap->getNumberOfGalaxies());
+  int nbDifferences = 0;
+  for (int k = 0; k < 3; k++) {
+    for (int j = 0; j < m_ShearMap->getYdim(); j++) {
+      for (int i = 0; i < m_ShearMap->getXdim(); i++) {
+        nbDifferences += (chunkShearMap->getBinValue(i, j, k) != m_ShearMap->getBinValue(i, j, k));
+        nbDifferences += (chunkConvMap->getBinValue(i, j, k) != m_ConvergenceMap->getBinValue(i, j, k));
+      }
+    }
+  }
+  BOOST_CHECK_EQUAL(nbDifferences, 0);
+  delete chunkShearMap;
+  delete chunkConvMap;
+  delete m_ShearMap;
+  m_ShearMap = nullptr;
+  delete m_ConvergenceMap;
+  m_ConvergenceMap = nullptr;
+}
+//-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END ()
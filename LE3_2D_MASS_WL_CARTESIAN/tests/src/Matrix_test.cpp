@@ -27,6 +27,8 @@
 #include <iostream>
 
 using LE3_2D_MASS_WL_CARTESIAN::Matrix;
+using LE3_2D_MASS_WL_CARTESIAN::MatrixStatistics;
+using LE3_2D_MASS_WL_CARTESIAN::computeStatistics;
 static Elements::Logging logger = Elements::Logging::getLogger("Matrix_test");
 //-----------------------------------------------------------------------------
 
@@ -170,6 +172,74 @@ BOOST_AUTO_TEST_CASE( add_substract_multiply_tests ) {
  delete [] values;
  values = nullptr;
 }
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( inPlaceOperators_tests ) {
+  logger.info() << "-- Matrix: inPlaceOperators_test";
+ unsigned int imSize(32);
+ double *values = new double[imSize*imSize];
+ // Define arbitraty values for an image
+ for (unsigned int i=0; i<imSize; i++) {
+  for (unsigned int j=0; j<imSize; j++) {
+   values[j*imSize + i] = double(i-j);
+  }
+ }
+ Matrix myImage(imSize, imSize, values);
+ Matrix myImage2(imSize, imSize, values);
+
+ // this = 2*this + 3*image - image
+ double factor = 2.;
+ myImage *= factor;
+ myImage.addMultiply(myImage2, 3.);
+ myImage -= myImage2;
+ // Check the values
+ for (unsigned int i=0; i<imSize; i++) {
+  for (unsigned int j=0; j<imSize; j++) {
+   BOOST_CHECK_CLOSE(myImage.getValue(i, j), 4.*double(i-j), 0.01);
+  }
+ }
+ myImage += myImage2;
+ BOOST_CHECK_CLOSE(myImage.getValue(5, 1), 20., 0.01);
+
+ // Different sizes leave the matrix unchanged
+ Matrix smallImage(imSize/2, imSize/2);
+ myImage += smallImage;
+ myImage.addMultiply(smallImage, 2.);
+ BOOST_CHECK_CLOSE(myImage.getValue(5, 1), 20., 0.01);
+
+ delete [] values;
+ values = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( move_tests ) {
+  logger.info() << "-- Matrix: move_test";
+ unsigned int imSize(32);
+ Matrix myImage(imSize, imSize*2);
+ myImage.setValue(3, 4, 7.);
+ double *array = myImage.getArray();
+
+ // The moved matrix takes over the buffer, the source is left empty
+ Matrix myImage2(std::move(myImage));
+ BOOST_CHECK(myImage2.getArray() == array);
+ BOOST_CHECK_EQUAL(myImage2.getXdim(), imSize);
+ BOOST_CHECK_EQUAL(myImage2.getYdim(), imSize*2);
+ BOOST_CHECK_EQUAL(myImage.getXdim(), 0);
+ BOOST_CHECK(myImage.getArray() == nullptr);
+
+ // Move assignment
+ Matrix myImage3(2, 2);
+ myImage3 = std::move(myImage2);
+ BOOST_CHECK(myImage3.getArray() == array);
+ BOOST_CHECK_CLOSE(myImage3.getValue(3, 4), 7., 0.01);
+
+ // Copy assignment to a matrix of a different size reallocates
+ Matrix myImage4(2, 2);
+ myImage4 = myImage3;
+ BOOST_CHECK_EQUAL(myImage4.getYdim(), imSize*2);
+ BOOST_CHECK_CLOSE(myImage4.getValue(3, 4), 7., 0.01);
+ BOOST_CHECK(myImage4.getArray() != array);
+}
+
 //-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_CASE( AddSubstract_differentSizeImage_tests ) {
   logger.info() << "-- Matrix: Add_Substract_different_Size_Image_test";
@@ -238,8 +308,8 @@ BOOST_AUTO_TEST_CASE( getMin_tests ) {
  // Get the max
  double Min = myImage.getMin();
 
- // Check the max is the right value
- BOOST_CHECK_CLOSE(Min, 1, 1);
+ // Check the min is the right value (first pixel included)
+ BOOST_CHECK_SMALL(Min, 1e-12);
 
  delete [] values;
  values = nullptr;
@@ -434,5 +504,49 @@ BOOST_AUTO_TEST_CASE( getArray_tests ) {
  values = nullptr;
 }
 
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( getStatistics_tests ) {
+ logger.info() << "-- Matrix: getStatistics_test";
+ // Large enough to use several blocks of the statistics kernel
+ unsigned int imSize(256);
+ Matrix myImage(imSize, imSize);
+ Matrix mask(imSize, imSize);
+ double sum(0.), sumSquare(0.), maskedSum(0.);
+ size_t maskedCount(0);
+ for (unsigned int i=0; i<imSize; i++) {
+  for (unsigned int j=0; j<imSize; j++) {
+   double value = 0.01*(double(i) - 2.*double(j));
+   myImage.setValue(i, j, value);
+   sum += value;
+   sumSquare += value*value;
+   if (i < imSize/2) {
+    mask.setValue(i, j, 1.);
+    maskedSum += value;
+    maskedCount++;
+   }
+  }
+ }
+
+ MatrixStatistics stats = myImage.getStatistics();
+ BOOST_CHECK_EQUAL(stats.count, size_t(imSize*imSize));
+ BOOST_CHECK_CLOSE(stats.min, -0.02*(imSize-1), 1e-9);
+ BOOST_CHECK_CLOSE(stats.max, 0.01*(imSize-1), 1e-9);
+ BOOST_CHECK_CLOSE(stats.sum, sum, 1e-9);
+ BOOST_CHECK_CLOSE(stats.sumSquare, sumSquare, 1e-9);
+ BOOST_CHECK_CLOSE(stats.getMean(), sum/(imSize*imSize), 1e-9);
+ BOOST_CHECK_CLOSE(stats.getStandardDeviation(), myImage.getStandardDeviation(), 1e-9);
+
+ MatrixStatistics maskedStats = myImage.getStatistics(mask);
+ BOOST_CHECK_EQUAL(maskedStats.count, maskedCount);
+ BOOST_CHECK_CLOSE(maskedStats.min, -0.02*(imSize-1), 1e-9);
+ BOOST_CHECK_CLOSE(maskedStats.max, 0.01*(imSize/2-1), 1e-9);
+ BOOST_CHECK_CLOSE(maskedStats.sum, maskedSum, 1e-9);
+
+ // Strided access on every other pixel
+ MatrixStatistics strided = computeStatistics(myImage.getArray(), myImage.size()/2, 2);
+ BOOST_CHECK_EQUAL(strided.count, myImage.size()/2);
+ BOOST_CHECK_CLOSE(strided.max, 0.01*(imSize-2), 1e-9);
+}
+
 //-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END ()
@@ -35,6 +35,19 @@ BOOST_AUTO_TEST_CASE( example_test ) {
 
 
 
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( copy_filter_test ) {
+  // The copy owns its own tables and must give the same filtered values
+  LE3_2D_MASS_WL_CARTESIAN::ReconstructMR *restore = new LE3_2D_MASS_WL_CARTESIAN::ReconstructMR();
+  const LE3_2D_MASS_WL_CARTESIAN::ReconstructMR restoreCopy(*restore);
+  double ref = restore->filter(2.5, 1., 0.5);
+  delete restore;
+  BOOST_CHECK_CLOSE(restoreCopy.filter(2.5, 1., 0.5), ref, 0.0001);
+  BOOST_CHECK_CLOSE(restoreCopy.filter(2.5, 0., 0.5), 2.5, 0.0001);
+  BOOST_CHECK_EQUAL(restoreCopy.filter(2.5, -1., 0.5), 0.);
 }
 
 //-----------------------------------------------------------------------------
@@ -157,6 +157,133 @@ BOOST_AUTO_TEST_CASE( GetSplittedCatalogs_test ) {
   }
 }
 
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( PartitionByRedshift_test ) {
+
+  CartesianParam params;
+  if (true == fileHasField(testParamFile1, "DpdTwoDMassParamsConvergencePatch")) {
+    params.ReadConvPatchXMLFile (testParamFile1.native());
+  }
+  // several blocks of rows, with rows out of the bins and missing redshifts
+  const size_t nGal = 200000;
+  std::vector<std::vector<double> > catData(8);
+  for (size_t i = 0; i < nGal; i++) {
+    catData[0].push_back(double(i));
+    catData[1].push_back(-double(i));
+    catData[3].push_back(0.001*(i%1000));
+    catData[4].push_back(-0.001*(i%1000));
+    catData[5].push_back((i%97 == 0) ? std::nan("") : 2.*((i*7919)%nGal)/nGal);
+    catData[6].push_back(1.);
+    catData[7].push_back(1.);
+  }
+  std::string m_catType = "LENSMC";
+  SplitCatalog split(catData, params, m_catType);
+
+  const std::vector<double> edges = {0.2, 0.7, 1.1, 1.9};
+  std::vector<std::vector<std::vector<double> > > binData = split.partitionByRedshift(edges,
+                                                                            RA_COLUMN|DEC_COLUMN|Z_COLUMN);
+  BOOST_CHECK_EQUAL(binData.size(), edges.size() - 1);
+  for (size_t bin = 0; bin < binData.size(); bin++) {
+    std::vector<double> ra, z;
+    for (size_t i = 0; i < nGal; i++) {
+      if (catData[5][i] >= edges[bin] && catData[5][i] < edges[bin+1]) {
+        ra.push_back(catData[0][i]);
+        z.push_back(catData[5][i]);
+      }
+    }
+    BOOST_CHECK(binData[bin][0] == ra);
+    BOOST_CHECK(binData[bin][5] == z);
+    BOOST_CHECK_EQUAL(binData[bin][1].size(), ra.size());
+    BOOST_CHECK(binData[bin][3].empty());
+  }
+}
+
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( PartitionBalanced_test ) {
+
+  CartesianParam params;
+  if (true == fileHasField(testParamFile1, "DpdTwoDMassParamsConvergencePatch")) {
+    params.ReadConvPatchXMLFile (testParamFile1.native());
+  }
+  // several blocks of rows, with many equal redshifts
+  const size_t nGal = 150001;
+  std::vector<std::vector<double> > catData(8);
+  for (size_t i = 0; i < nGal; i++) {
+    catData[0].push_back(double(i));
+    catData[1].push_back(-double(i));
+    catData[3].push_back(0.);
+    catData[4].push_back(0.);
+    catData[5].push_back(0.01*((i*7919)%200));
+    catData[6].push_back(1.);
+    catData[7].push_back(1.);
+  }
+  std::string m_catType = "LENSMC";
+  SplitCatalog splitter(catData, params, m_catType);
+
+  // reference: equal split of the catalog sorted by redshift, ties in the catalog order
+  std::vector<size_t> order(nGal);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&catData](size_t i1, size_t i2) {
+    return catData[5][i1] < catData[5][i2];
+  });
+  std::vector<double> sortedRa;
+  for (size_t i : order) {
+    sortedRa.push_back(catData[0][i]);
+  }
+
+  const size_t nBins = 7;
+  std::vector<std::vector<std::vector<double> > > binData = splitter.partitionBalanced(nBins, RA_COLUMN|Z_COLUMN);
+  BOOST_CHECK_EQUAL(binData.size(), nBins);
+  for (size_t bin = 0; bin < nBins; bin++) {
+    std::vector<double> ra = split(sortedRa, nBins, bin);
+    std::sort(ra.begin(), ra.end());
+    BOOST_CHECK(binData[bin][0] == ra);
+    BOOST_CHECK_EQUAL(binData[bin][5].size(), ra.size());
+  }
+}
+
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( SaveSubCatalog_test ) {
+
+  CartesianParam params;
+  if (true == fileHasField(testParamFile1, "DpdTwoDMassParamsConvergencePatch")) {
+    params.ReadConvPatchXMLFile (testParamFile1.native());
+  }
+  std::vector<std::vector<double> > catData(8);
+  for (size_t i = 0; i < 10; i++) {
+    for (size_t col = 0; col < catData.size(); col++) {
+      catData[col].push_back(double(10*col + i));
+    }
+  }
+  std::string m_catType = "LENSMC";
+  SplitCatalog splitter(catData, params, m_catType);
+
+  Elements::TempDir one{"Split-Catalogue-%%%%%%"};
+  const std::string filename = one.path().string() + "/CatZ_Test_subcatalogue.fits";
+  std::vector<std::string> columnNames = getcolumnNames(m_catType);
+  BOOST_CHECK(splitter.saveSubCatalog(filename, catData, columnNames));
+
+  // all the columns in one table under their own names, kappa being left out
+  MefFile infile(filename, MefFile::Permission::Read);
+  const auto &ext = infile.access<BintableHdu>(1);
+  const size_t catColumns[] = {0, 1, 3, 4, 6, 5, 7};
+  for (size_t col = 0; col < columnNames.size(); col++) {
+    BOOST_CHECK(ext.readColumn<double>(columnNames[col]).vector() == catData[catColumns[col]]);
+  }
+  BOOST_CHECK(ext.readColumn<double>("PHZ_MEDIAN").vector() == catData[5]);
+  BOOST_CHECK(ext.readColumn<double>("SHE_LENSMC_WEIGHT").vector() == catData[6]);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( GetCatalogColumns_test ) {
+  // the columns of the sub-catalogs are read, kappa is not
+  const unsigned int columns = SplitCatalog::getCatalogColumns();
+  BOOST_CHECK_EQUAL(columns, (unsigned int)(RA_COLUMN | DEC_COLUMN | G1_COLUMN | G2_COLUMN |
+                                            Z_COLUMN | WEIGHT_COLUMN | CORRECTION_COLUMN));
+  BOOST_CHECK_EQUAL(columns & KAPPA_COLUMN, 0u);
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END ()
@@ -158,6 +158,7 @@ public:
   ReadCatalog readCat;
   logger.info("Reading Input Shear Catalog");
   std::vector<std::vector<double> > catalogData;
+  readCat.setColumns(MapMaker::getCatalogColumns(mapType::shearMap));
   readCat.readShearCatalog(workdir, inputShearCat, catalogData);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -187,8 +188,8 @@ Euclid::WeakLensing::TwoDMass::CartesianKS::CartesianAlgoKS CartesainAlgo(Patchp
  // Randomising shear catalog
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   NoisyCatalogData random;
-  std::vector<std::vector<double> > NoisData;
-  NoisData = random.create_noisy_data(catalogData);
+  ShearCatalog<double> noisyShear;
+  ShearCatalogView<double> NoisData = random.create_noisy_data(makeShearCatalogView(catalogData), noisyShear);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Creating Patch of shear Map from randomised shear
@@ -197,8 +198,7 @@ Euclid::WeakLensing::TwoDMass::CartesianKS::CartesianAlgoKS CartesainAlgo(Patchp
 
    fs::path NoisyshearMap = fs::path("EUC_LE3_WL_NoisyShearMap_" + getDateTimeString() + ".fits");
    CartesainAlgo.extractShearMap ((datadir /NoisyshearMap).native(), NoisData, m_CB);
-   NoisData.clear();
-   NoisData.shrink_to_fit();
+   noisyShear = ShearCatalog<double>();
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Output filename
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
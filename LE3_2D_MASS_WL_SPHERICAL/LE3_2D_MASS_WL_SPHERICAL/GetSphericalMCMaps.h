@@ -69,6 +69,14 @@ public:
    */
   std::pair<Healpix_Map<double>, Healpix_Map<double> > getDeNoisedShearMap();
 
+  /**
+   * @brief get the parameters of the maps, with the footprint rings of the galaxy count map
+   *        once the denoised shear map is computed with ring restricted transforms
+   * @param[in] None
+   * @return the SphericalParam object of the maps
+   */
+  LE3_2D_MASS_WL_SPHERICAL::SphericalParam getSphericalParam();
+
   /**
    * @brief get the Noised Shear Map after randomising the input Shear
    * @param[in] None
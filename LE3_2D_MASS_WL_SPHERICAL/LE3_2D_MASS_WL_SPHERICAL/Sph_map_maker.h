@@ -26,6 +26,7 @@
 
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalIO.h"
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
 #include <vector>
 #include <memory>
 
@@ -57,8 +58,45 @@ public:
   //std::pair<Healpix_Map<double>, Healpix_Map<double> > create_ShearMap(std::vector<std::vector<double> > &catData);
   std::tuple<Healpix_Map<double>, Healpix_Map<double>, Healpix_Map<double> > create_ShearMap
                                                                 (std::vector<std::vector<double> > &catData);
+
+  /**
+  @brief  This method starts the binning of a catalog read by chunks (resets the shear and count sums)
+  */
+  void startBinning();
+
+  /**
+  @brief  This method bins a chunk of catalog rows into the shear and count sums, in parallel:
+          the pixel of each galaxy is computed once, the rows are grouped by ranges of pixels
+          (counting sort) and each range of pixels is summed by one thread in the catalog order,
+          so that the sums do not depend on the number of threads
+  @param  <chunk> catalog rows in vectors column-wise (as returned by ReadCatalog)
+  */
+  void addCatalogChunk(const std::vector<std::vector<double> > &chunk);
+
+  /**
+  @brief  This method returns the maps of the chunks binned since startBinning
+  @retun  <Shear1, Shear2, GalCountMap> Shear healpix maps
+  */
+  std::tuple<Healpix_Map<double>, Healpix_Map<double>, Healpix_Map<double> > getBinnedShearMap();
+
+  /**
+  @brief  This method returns the catalog columns (ShearColumns flags) needed to create the Shear Map,
+          to be given to ReadCatalog::setColumns so that the other columns are not read
+  */
+  static unsigned int getCatalogColumns();
+
 private:
 
+  /**
+   *  @brief <blockSize>, rows per block of the counting sort, fixed so that it does not depend on the number of threads
+  */
+ static const long blockSize = 65536;
+
+  /**
+   *  @brief <nbPixelRanges>, maximum number of ranges of pixels summed in parallel
+  */
+ static const int nbPixelRanges = 1024;
+
   /**
    *  @brief <hb>, Healpix_Base object
   */
@@ -74,6 +112,11 @@ private:
   */
  LE3_2D_MASS_WL_SPHERICAL::SphericalParam m_SphParam;
 
+  /**
+   *  @brief sums of gamma1 and gamma2, and number of galaxies per pixel of the current binning
+  */
+ Healpix_Map<double> m_g1Sum, m_g2Sum, m_ngalSum;
+
 };  // End of Sph_map_maker class
 }  // namespace  LE3_2D_MASS_WL_SPHERICAL
 #endif
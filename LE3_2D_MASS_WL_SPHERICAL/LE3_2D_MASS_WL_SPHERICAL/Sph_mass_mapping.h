@@ -27,6 +27,7 @@
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalIO.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
 #include <vector>
 #include <memory>
 
@@ -41,11 +42,23 @@ class Sph_mass_mapping {
 
 public:
 
+  /**
+   * @brief <defaultBatchSize>, number of maps of the batched transforms by default: a batch of K maps holds
+   *        4*K full sky maps (shear and convergence) and 2*K sets of harmonic coefficients
+   */
+  static const int defaultBatchSize = 4;
+
   /**
    * @brief Constructor
    */
   Sph_mass_mapping();
 
+  /**
+   * @brief Constructor
+   * @param[in] params SphericalParam object with the parameters of the harmonic transforms
+   */
+  explicit Sph_mass_mapping(const LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params);
+
   /**
    * @brief Destructor
    */
@@ -69,6 +82,85 @@ public:
  std::pair<Healpix_Map<double>, Healpix_Map<double> > create_ConvtoShearMap
                                              (Healpix_Map<double>& mapE, Healpix_Map<double>& mapB);
 
+ /**
+ @brief  This method create Convergence Map using shear Map, in the given maps and with the buffers of the workspace
+ @param  <mapE> Gamma1 healpix map
+ @param  <mapB> Gamma2 healpix map
+ @param  <outE> kappaE healpix map, (re)sized to the nside of the input maps if needed
+ @param  <outB> kappaB healpix map, (re)sized to the nside of the input maps if needed
+ @param  <workspace> pool of the harmonic coefficients buffers
+ */
+ void create_SheartoConvMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                            Healpix_Map<double>& outE, Healpix_Map<double>& outB, SphericalWorkspace& workspace);
+
+ /**
+ @brief  This method create Shear Map using convergence Map, in the given maps and with the buffers of the workspace
+ @param  <mapE> kappaE healpix map
+ @param  <mapB> kappaB healpix map
+ @param  <outE> Gamma1 healpix map, (re)sized to the nside of the input maps if needed
+ @param  <outB> Gamma2 healpix map, (re)sized to the nside of the input maps if needed
+ @param  <workspace> pool of the harmonic coefficients buffers
+ */
+ void create_ConvtoShearMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                            Healpix_Map<double>& outE, Healpix_Map<double>& outB, SphericalWorkspace& workspace);
+
+ /**
+ @brief  This method create the Convergence Maps of several Shear Maps (realisations or redshift bins) in
+         batches: the maps of a batch are transformed by single libsharp jobs (one spin-2 analysis and one
+         spin-0 synthesis), sharing the Legendre recursion between the maps. A batch holds two sets of
+         harmonic coefficients per map in the workspace
+ @param  <shearPairs> Gamma1 and Gamma2 healpix maps of each realisation, of the same nside
+ @param  <workspace> pool of the harmonic coefficients buffers, shared by the transforms
+ @param  <batchSize> number of maps transformed at the same time, 0 for defaultBatchSize
+ @retun  <kappaE, kappaB> convergence healpix maps of each realisation, in the order of the input maps
+ */
+ std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > create_SheartoConvMaps
+                (std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > >& shearPairs,
+                 SphericalWorkspace& workspace, int batchSize = 0);
+
+ /**
+ @brief  This method create Convergence Map using shear Map smoothed by a gaussian kernel, the smoothing
+         and the kernel being applied on the coefficients of a single spin-2 analysis of the shear
+ @param  <mapE> Gamma1 healpix map
+ @param  <mapB> Gamma2 healpix map
+ @param  <sigma> sigma of the gaussian kernel, 0 for no smoothing
+ @param  <outE> kappaE healpix map, (re)sized to the nside of the input maps if needed
+ @param  <outB> kappaB healpix map, (re)sized to the nside of the input maps if needed
+ @param  <workspace> pool of the harmonic coefficients buffers
+ @param  <smoothedE> if not null, set to the smoothed Gamma1 healpix map
+ @param  <smoothedB> if not null, set to the smoothed Gamma2 healpix map
+ */
+ void create_SmoothedSheartoConvMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB, double sigma,
+                                    Healpix_Map<double>& outE, Healpix_Map<double>& outB,
+                                    SphericalWorkspace& workspace, Healpix_Map<double>* smoothedE = nullptr,
+                                    Healpix_Map<double>* smoothedB = nullptr);
+
+ /**
+ @brief  This method create the denoised Shear Map: shear of the convergence whose E-Mode is smoothed by a
+         gaussian kernel, with a single spin-2 analysis of the shear and a single spin-2 synthesis
+ @param  <mapE> Gamma1 healpix map
+ @param  <mapB> Gamma2 healpix map
+ @param  <sigma> sigma of the gaussian kernel, 0 for no smoothing
+ @param  <outGamma1> denoised Gamma1 healpix map
+ @param  <outGamma2> denoised Gamma2 healpix map
+ @param  <outKappaE> smoothed kappaE healpix map
+ @param  <outKappaB> kappaB healpix map
+ @param  <workspace> pool of the harmonic coefficients buffers
+ */
+ void create_DeNoisedShearMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB, double sigma,
+                              Healpix_Map<double>& outGamma1, Healpix_Map<double>& outGamma2,
+                              Healpix_Map<double>& outKappaE, Healpix_Map<double>& outKappaB,
+                              SphericalWorkspace& workspace);
+
+ /**
+ @brief  This method applies the mass mapping kernel on the harmonic coefficients of the E and B modes
+ @param  <mapType> type of the field of the coefficients i.e. either shearMap (to convergence) or convMap (to shear)
+ @param  <almE> E-Mode coefficients, replaced by those of the other field
+ @param  <almB> B-Mode coefficients, replaced by those of the other field
+ */
+ void applyKernel(const Euclid::WeakLensing::TwoDMass::mapType type,
+                  Alm<xcomplex<double> >& almE, Alm<xcomplex<double> >& almB);
+
  /**
  @brief  This method returns nside of the map
  @param  None
@@ -101,9 +193,41 @@ private:
  std::pair<Healpix_Map<double>, Healpix_Map<double> > sphMassMap
       (const Euclid::WeakLensing::TwoDMass::mapType type, Healpix_Map<double>& mapE, Healpix_Map<double>& mapB);
  /**
+ @brief  This method does mass mapping in the given output maps
+ @param  <mapType> input healpix map type i.e. either shearMap or convMap
+ @param  <inMapE> input E-Mode healpix map
+ @param  <inMapB> input B-Mode healpix map
+ @param  <outE> output E-Mode healpix map
+ @param  <outB> output B-Mode healpix map
+ @param  <workspace> pool of the harmonic coefficients buffers
+ */
+ void sphMassMap(const Euclid::WeakLensing::TwoDMass::mapType type, Healpix_Map<double>& mapE,
+                 Healpix_Map<double>& mapB, Healpix_Map<double>& outE, Healpix_Map<double>& outB,
+                 SphericalWorkspace& workspace);
+ /**
+ @brief  This method filters the shear in harmonic space: spin-2 analysis of the shear, gaussian kernels
+         on the E and B modes, synthesis of the filtered shear (if asked) and of the convergence
+ @param  <mapE> Gamma1 healpix map
+ @param  <mapB> Gamma2 healpix map
+ @param  <sigmaE> sigma of the gaussian kernel of the E-Mode, 0 for no smoothing
+ @param  <sigmaB> sigma of the gaussian kernel of the B-Mode, 0 for no smoothing
+ @param  <outGamma1> if not null, filtered Gamma1 healpix map
+ @param  <outGamma2> if not null, filtered Gamma2 healpix map
+ @param  <outKappaE> kappaE healpix map
+ @param  <outKappaB> kappaB healpix map
+ @param  <workspace> pool of the harmonic coefficients buffers
+ */
+ void sphFilterChain(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB, double sigmaE, double sigmaB,
+                     Healpix_Map<double>* outGamma1, Healpix_Map<double>* outGamma2,
+                     Healpix_Map<double>& outKappaE, Healpix_Map<double>& outKappaB, SphericalWorkspace& workspace);
+ /**
  @brief  This is Nside of input map for inversion
  */
  int m_nside;
+ /**
+ @brief  SphericalParam object with the parameters of the harmonic transforms
+ */
+ LE3_2D_MASS_WL_SPHERICAL::SphericalParam m_SphParam;
 };  // End of Sph_mass_mapping class
 }  // namespace LE3_2D_MASS_WL_SPHERICAL
 #endif
@@ -67,6 +67,29 @@ public:
   */
   bool write_Map (const std::string& filename, Healpix_Map<double>& map, const std::string &colname);
 
+  /**
+  @brief  This method writes up to 3 healpix maps in one Fits BinTable (according to DataModel), all
+          the columns in a single write. The values are written in float32 if the map single precision
+          is set in SphericalParam, and only the observed pixels with their PIXEL index (HEALPix explicit
+          indexing) if the partial sky maps are set
+  @param  <filename> name of the map in fits format, overwritten if it exists
+  @param  <maps> healpix maps in RING ordering, of same Nside
+  @param  <colnames> column name of each map in table
+  @retun  true if maps are written correctly
+  */
+  bool write_Maps (const std::string& filename, const std::vector<const Healpix_Map<double>*>& maps,
+                   const std::vector<std::string>& colnames);
+
+  /**
+  @brief  This method reads the healpix maps of a Fits BinTable written by write_Map or write_Maps, in
+          float32 or float64 and with implicit (full sky) or explicit (partial sky) indexing, the pixels
+          absent from a partial sky map being 0
+  @param  <filename> name of the map in fits format
+  @param  <colnames> column names of the maps (output)
+  @retun  the maps in the order of the columns
+  */
+  std::vector<Healpix_Map<double> > read_Maps (const std::string& filename, std::vector<std::string>& colnames);
+
   /**
   @brief  This method write Map using input healpix map and filename
   @param  <filename> name of the map in fits foramt
@@ -87,9 +110,16 @@ public:
  * @param[in] hdu (other than primary) to which records need to be written
  * This method writes records to the given header
  **/
-  void writeHdu(const RecordHdu &hdu, int Nside);
+  void writeHdu(const RecordHdu &hdu, int Nside, bool partialSky = false);
 
 private:
+  /**
+   * @brief   creates the map extension with all its columns in type T, preceded by the PIXEL column in partial sky
+   **/
+  template <typename T>
+  const BintableHdu& assignMapsExt(MefFile& SphFile, const std::vector<const Healpix_Map<double>*>& maps,
+                           const std::vector<std::string>& colnames, bool partialSky, const std::vector<int>& pixels);
+
   /**
    *  @brief <m_SphParam>, SphericalParam object with input parameters
   */
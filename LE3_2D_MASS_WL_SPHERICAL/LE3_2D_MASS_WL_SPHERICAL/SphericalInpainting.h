@@ -29,10 +29,13 @@
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalIO.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_mass_mapping.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalStarlet.h"
 
 #include "ElementsKernel/Logging.h"
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 #include <cmath>
 #include <complex>
@@ -71,6 +74,13 @@ public:
    */
   std::pair<Healpix_Map<double>, Healpix_Map<double> > performInpainting ();
 
+  /**
+   * @brief Method to perform inpainting on Sphere with the convergence kept in harmonic space:
+   * the thresholding and the mass mapping kernels are applied on the coefficients, and the
+   * mask projection costs one spin-2 synthesis and one spin-2 analysis per iteration
+   */
+  std::pair<Healpix_Map<double>, Healpix_Map<double> > performHarmonicInpainting ();
+
   /**
    * @brief perform mask inversion
    */
@@ -87,6 +97,12 @@ public:
   Healpix_Map<double> performWavelet(Healpix_Map<double>& map);
 
 private:
+  /**
+   * @brief perform mask inversion on the harmonic coefficients of the convergence, replaced
+   * by those of the convergence of the shear of the model completed by the observed shear
+   */
+  void harmonicMaskInversion(Alm<xcomplex<double> >& kE_lm, Alm<xcomplex<double> >& kB_lm);
+
   /**
    * @brief Minimum Threshold
    */
@@ -102,6 +118,11 @@ private:
    */
   int m_nlmax;
 
+  /**
+   * @brief MMax
+   */
+  int m_nmmax;
+
   /**
    * @brief Resolution of Map (Nside)
    */
@@ -152,6 +173,17 @@ private:
   */
  LE3_2D_MASS_WL_SPHERICAL::SphericalParam m_SphParam;
 
+  /**
+   *  @brief <m_workspace>, transforms and buffers reused by the iterations of the inpainting, full sky
+   *          even when the mass mapping is restricted to the footprint rings
+  */
+ LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace m_workspace;
+
+  /**
+   *  @brief <m_starlet>, wavelet decomposition with the filter bank of the scales of the inpainting
+  */
+ std::unique_ptr<LE3_2D_MASS_WL_SPHERICAL::SphericalStarlet> m_starlet;
+
 };  // End of SphericalInpainting class
 
 }  // namespace LE3_2D_MASS_WL_SPHERICAL
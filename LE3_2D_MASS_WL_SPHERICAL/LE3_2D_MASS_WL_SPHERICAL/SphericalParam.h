@@ -26,6 +26,8 @@
 #define _LE3_2D_MASS_WL_SPHERICAL_SPHERICALPARAM_H
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <boost/filesystem.hpp>
 #include "ElementsKernel/Logging.h"
 
@@ -181,13 +183,121 @@ public:
    * @return  Extension name (KAPPA_SPHERE or GALCOUNT_SPHERE or SNR_SPHERE ....)
   */
   void setExtName(std::string& name);
+
+  /**
+   * @brief   function to return the precision of the output maps
+   * @return  true if the map values are written in float32, false for float64
+  */
+  bool getMapSinglePrecision();
+
+  /**
+   * @brief   function to set the precision of the output maps
+  */
+  void setMapSinglePrecision(bool singlePrecision);
+
+  /**
+   * @brief   function to return the sky coverage of the output maps
+   * @return  true if only the observed pixels are written (HEALPix explicit indexing), false for full sky
+  */
+  bool getPartialSkyMaps();
+
+  /**
+   * @brief   function to set the sky coverage of the output maps
+  */
+  void setPartialSkyMaps(bool partialSky);
+
+  /**
+   * @brief   function to return the directory of the HEALPix ring weights files
+   * @return  directory of the weight_ring_n<nside>.fits files, empty to use unit weights and iterations
+  */
+  std::string getRingWeightsDir();
+
+  /**
+   * @brief   function to set the directory of the HEALPix ring weights files
+  */
+  void setRingWeightsDir(const std::string& weightsDir);
+
+  /**
+   * @brief   function to return the maximum multipole of the spherical harmonic transforms
+   * @return  lmax, 0 for the default 3*nside-1 of the maps
+  */
+  int getLmax();
+
+  /**
+   * @brief   function to return the maximum order of the spherical harmonic transforms
+   * @return  mmax, 0 for mmax = lmax
+  */
+  int getMmax();
+
+  /**
+   * @brief   function to set the band limit of the spherical harmonic transforms
+   * @param   <lmax> maximum multipole, 0 for the default 3*nside-1 of the maps
+   * @param   <mmax> maximum order, 0 for mmax = lmax
+  */
+  void setBandLimit(int lmax, int mmax = 0);
+
+  /**
+   * @brief   function to return the inpainting solver
+   * @return  true if the inpainting estimate is kept in harmonic space between the iterations
+  */
+  bool getHarmonicInpainting();
+
+  /**
+   * @brief   function to set the inpainting solver
+  */
+  void setHarmonicInpainting(bool harmonicInpainting);
+
+  /**
+   * @brief   function to return the number of maps transformed at the same time in the batched transforms
+   * @return  batch size, 0 for the default of Sph_mass_mapping (4 maps)
+  */
+  int getShtBatchSize();
+
+  /**
+   * @brief   function to set the number of maps transformed at the same time in the batched transforms
+  */
+  void setShtBatchSize(int batchSize);
+
+  /**
+   * @brief   function to return if the spherical harmonic transforms are restricted to the footprint rings
+   * @return  true if the transforms only process the rings of the maps intersecting the survey footprint
+  */
+  bool getRingRestrictedSHT();
+
+  /**
+   * @brief   function to set if the spherical harmonic transforms are restricted to the footprint rings,
+   *          which needs the HEALPix ring weights (the transforms are full sky otherwise). The
+   *          inpainting, which fills the pixels off the footprint, always runs full-sky transforms
+  */
+  void setRingRestrictedSHT(bool ringRestricted);
+
+  /**
+   * @brief   function to return the nside of the maps of the footprint rings
+   * @return  nside, 0 if no footprint is set
+  */
+  int getFootprintNside();
+
+  /**
+   * @brief   function to return the footprint rings, shared by the copies of the parameters
+   * @return  increasing ring numbers (1 to 4*nside-1) intersecting the footprint, nullptr if no footprint is set
+  */
+  std::shared_ptr<const std::vector<int> > getFootprintRings();
+
+  /**
+   * @brief   function to set the footprint rings used by the transforms of the maps of the given nside
+   * @param   <nside> resolution of the maps of the footprint
+   * @param   <rings> increasing ring numbers (1 to 4*nside-1) intersecting the footprint
+  */
+  void setFootprintRings(int nside, const std::vector<int>& rings);
 private:
 
-int m_nside, m_NInpaint, m_NItReducedShear, m_NInpScales, m_Nbins, m_NResamples;
+int m_nside, m_NInpaint, m_NItReducedShear, m_NInpScales, m_Nbins, m_NResamples, m_lmax, m_mmax, m_shtBatchSize, m_footprintNside;
 long m_BmodesZeros, m_EqualVarPerScale, m_balancedBins;
 float m_sigmaGauss, m_thresholdFDR, m_RSsigmaGauss;
 double m_Zmin, m_Zmax;
-std::string ExtName;
+std::string ExtName, m_ringWeightsDir;
+bool m_mapSinglePrecision, m_partialSkyMaps, m_harmonicInpainting, m_ringRestrictedSHT;
+std::shared_ptr<const std::vector<int> > m_footprintRings;
 
 }; /* End of SphericalParam class */
 
@@ -0,0 +1,115 @@
+/**
+ * @file LE3_2D_MASS_WL_SPHERICAL/SphericalStarlet.h
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _LE3_2D_MASS_WL_SPHERICAL_SPHERICALSTARLET_H
+#define _LE3_2D_MASS_WL_SPHERICAL_SPHERICALSTARLET_H
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
+#include <vector>
+#include <functional>
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+/**
+ * @class SphericalStarlet
+ * @brief Starlet (B3-spline) decomposition of healpix maps in harmonic space
+ *
+ * All the scales are low-pass filters of the coefficients of the same map: the
+ * map is analysed once, and the B3-spline profiles of the scales, computed once
+ * at construction, are applied on its coefficients. The smooth maps of the
+ * nbScales-1 filtered scales are then synthesised in a single batched transform.
+ * The decomposition visiting the bands in turn synthesises them one at a time
+ * instead, holding a single band: it is the low-memory form.
+ */
+class SphericalStarlet {
+
+public:
+
+  /**
+   * @brief Constructor
+   * @param[in] workspace transforms and buffers of the decomposition, must outlive the object
+   * @param[in] nside resolution of the decomposed maps
+   * @param[in] nbScales number of scales (bands) of the decomposition
+   */
+  SphericalStarlet(SphericalWorkspace& workspace, int nside, int nbScales);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~SphericalStarlet() = default;
+
+  /**
+   * @brief returns the number of scales
+   */
+  int getNbScales() const;
+
+  /**
+   * @brief returns the low-pass filter profile of a scale, from l=0 to lmax
+   * @param[in] scale scale of the filter, from 0 to nbScales-2
+   */
+  const std::vector<double>& getFilter(int scale) const;
+
+  /**
+   * @brief decomposes a map, the bands being given in turn to visit: low-memory form,
+   * with one synthesis per band instead of a batched one
+   * @param[in] map healpix map in RING scheme
+   * @param[in] visit called with the scale and the band, from the finest scale to the
+   * coarse residual (last scale); the band may be changed, it is valid during the call only
+   */
+  void decompose(const Healpix_Map<double>& map,
+                 const std::function<void(int, Healpix_Map<double>&)>& visit);
+
+  /**
+   * @brief decomposes a map, the smooth maps of all the scales being synthesised in one batch
+   * @param[in] map healpix map in RING scheme
+   * @return the nbScales bands, whose sum is the map
+   */
+  std::vector<Healpix_Map<double> > decompose(const Healpix_Map<double>& map);
+
+private:
+
+  /**
+   *  @brief <m_workspace>, transforms and buffers of the decomposition
+  */
+  SphericalWorkspace& m_workspace;
+
+  /**
+   *  @brief <m_nside>, resolution of the decomposed maps
+  */
+  int m_nside;
+
+  /**
+   *  @brief <m_nbScales>, number of scales
+  */
+  int m_nbScales;
+
+  /**
+   *  @brief <m_filters>, filter bank: low-pass profile of each scale but the last
+  */
+  std::vector<std::vector<double> > m_filters;
+
+};  // End of SphericalStarlet class
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
+
+#endif
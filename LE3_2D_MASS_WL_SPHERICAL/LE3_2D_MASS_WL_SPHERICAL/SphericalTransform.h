@@ -0,0 +1,278 @@
+/**
+ * @file LE3_2D_MASS_WL_SPHERICAL/SphericalTransform.h
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _LE3_2D_MASS_WL_SPHERICAL_SPHERICALTRANSFORM_H
+#define _LE3_2D_MASS_WL_SPHERICAL_SPHERICALTRANSFORM_H
+
+#include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+/**
+ * @class SphericalTransform
+ * @brief Spherical harmonic transforms of the healpix maps of a given nside
+ *
+ * The harmonic analysis is a quadrature over the rings of the map. With the
+ * standard HEALPix ring weights (weight_ring_n<nside>.fits of the HEALPix data
+ * directory, read once per nside) the analysis is done in a single transform.
+ * Without them, the unit weights are corrected by Jacobi iterations as before,
+ * each iteration costing one synthesis and one analysis more. As in Healpix_cxx,
+ * the spin-2 analyses reuse the temperature ring weights: the product of two
+ * spin-2 harmonics of the same order expands on Legendre polynomials of the
+ * same degrees as for the scalar harmonics, which the weights integrate.
+ *
+ * The band limit is 3*nside-1 unless a lower lmax is set in SphericalParam: the
+ * cost of a transform grows as lmax^3 while the shear beyond about 2*nside is
+ * dominated by the pixel noise.
+ *
+ * When footprint rings are set in SphericalParam for the nside of the maps and
+ * the ring weights are available, the transforms only process these rings (the
+ * rings of a partial-sky survey with at least one observed pixel), their cost
+ * being proportional to the number of rings. The synthesis onto the pixels of
+ * the footprint rings is the full-sky one, the other pixels being set to zero,
+ * and the analysis of a map vanishing outside the footprint rings is the
+ * full-sky one. Without the ring weights the footprint is ignored, as the Jacobi
+ * iterations of the unit weights fit the map on all the rings.
+ *
+ * The batched transforms run the transforms of several maps in a single libsharp
+ * job, sharing the Legendre recursion between the maps.
+ */
+class SphericalTransform {
+
+public:
+
+  /**
+   * @brief Constructor
+   * @param[in] nside resolution of the maps
+   * @param[in] params SphericalParam object giving the band limit (lmax, mmax) of the transforms and
+   *            the directory of the HEALPix ring weights
+   */
+  SphericalTransform(int nside, LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~SphericalTransform() = default;
+
+  /**
+   * @brief returns the nside of the maps
+   */
+  int getNside() const;
+
+  /**
+   * @brief returns the maximum multipole of the transforms
+   */
+  int getLmax() const;
+
+  /**
+   * @brief returns the maximum order of the transforms
+   */
+  int getMmax() const;
+
+  /**
+   * @brief returns a set of harmonic coefficients of the band limit of the transforms, set to zero
+   */
+  Alm<xcomplex<double> > createAlm() const;
+
+  /**
+   * @brief returns the number of Jacobi iterations of the analysis
+   */
+  int getNbIterations() const;
+
+  /**
+   * @brief returns true if the analysis uses the HEALPix ring weights
+   */
+  bool hasRingWeights() const;
+
+  /**
+   * @brief returns the ring weights of the analysis
+   */
+  const arr<double>& getWeights() const;
+
+  /**
+   * @brief returns true if the transforms only process the footprint rings
+   */
+  bool isRingRestricted() const;
+
+  /**
+   * @brief returns the number of rings processed by the transforms
+   */
+  int getNbRings() const;
+
+  /**
+   * @brief harmonic analysis of a scalar map
+   * @param[in] map healpix map in RING scheme
+   * @param[out] alm harmonic coefficients
+   */
+  void map2alm(const Healpix_Map<double>& map, Alm<xcomplex<double> >& alm) const;
+
+  /**
+   * @brief harmonic analysis of a spin field, e.g. the shear (gamma1, gamma2) for spin 2
+   * @param[in] map1 first component of the field, in RING scheme
+   * @param[in] map2 second component of the field, in RING scheme
+   * @param[out] alm1 E-mode (gradient) harmonic coefficients
+   * @param[out] alm2 B-mode (curl) harmonic coefficients
+   * @param[in] spin spin of the field
+   */
+  void map2alm_spin(const Healpix_Map<double>& map1, const Healpix_Map<double>& map2,
+                    Alm<xcomplex<double> >& alm1, Alm<xcomplex<double> >& alm2, int spin) const;
+
+  /**
+   * @brief harmonic synthesis of a scalar map
+   * @param[in] alm harmonic coefficients of the band limit of the transforms
+   * @param[out] map healpix map in RING scheme of the nside of the transforms
+   */
+  void alm2map(const Alm<xcomplex<double> >& alm, Healpix_Map<double>& map) const;
+
+  /**
+   * @brief harmonic synthesis of a spin field
+   * @param[in] alm1 E-mode (gradient) harmonic coefficients
+   * @param[in] alm2 B-mode (curl) harmonic coefficients
+   * @param[out] map1 first component of the field, in RING scheme
+   * @param[out] map2 second component of the field, in RING scheme
+   * @param[in] spin spin of the field
+   */
+  void alm2map_spin(const Alm<xcomplex<double> >& alm1, const Alm<xcomplex<double> >& alm2,
+                    Healpix_Map<double>& map1, Healpix_Map<double>& map2, int spin) const;
+
+  /**
+   * @brief batched harmonic analysis of spin fields, in a single libsharp job
+   * @param[in] maps1 first components of the fields, RING maps of the nside of the transforms
+   * @param[in] maps2 second components of the fields
+   * @param[out] alms1 E-mode harmonic coefficients of each field, of the band limit of the transforms
+   * @param[out] alms2 B-mode harmonic coefficients of each field
+   * @param[in] spin spin of the fields
+   */
+  void map2alm_spin(const std::vector<const Healpix_Map<double>*>& maps1,
+                    const std::vector<const Healpix_Map<double>*>& maps2,
+                    const std::vector<Alm<xcomplex<double> >*>& alms1,
+                    const std::vector<Alm<xcomplex<double> >*>& alms2, int spin) const;
+
+  /**
+   * @brief batched harmonic synthesis of scalar maps, in a single libsharp job
+   * @param[in] alms harmonic coefficients of each map, of the band limit of the transforms
+   * @param[out] maps RING maps of the nside of the transforms
+   */
+  void alm2map(const std::vector<const Alm<xcomplex<double> >*>& alms,
+               const std::vector<Healpix_Map<double>*>& maps) const;
+
+  /**
+   * @brief reads the HEALPix ring weights of the given nside, once per directory and nside
+   * @param[in] weightsDir directory of the HEALPix ring weights files
+   * @param[in] nside resolution of the maps
+   * @return the 2*nside ring weights, nullptr if the file is not available
+   */
+  static std::shared_ptr<const arr<double> > readRingWeights(const std::string& weightsDir, int nside);
+
+private:
+
+  /**
+   * @brief <m_nside>, resolution of the maps
+   */
+  int m_nside;
+
+  /**
+   * @brief <m_lmax>, maximum multipole of the transforms
+   */
+  int m_lmax;
+
+  /**
+   * @brief <m_mmax>, maximum order of the transforms
+   */
+  int m_mmax;
+
+  /**
+   * @brief <m_nbIterations>, number of Jacobi iterations of the analysis
+   */
+  int m_nbIterations;
+
+  /**
+   * @brief <m_weights>, ring weights of the analysis, shared between the transforms of the same nside
+   */
+  std::shared_ptr<const arr<double> > m_weights;
+
+  /**
+   * @brief <m_ringWeights>, true if m_weights are the HEALPix ring weights, false for unit weights
+   */
+  bool m_ringWeights;
+
+  /**
+   * @brief <m_ringRestricted>, true if the transforms only process the footprint rings
+   */
+  bool m_ringRestricted;
+
+  /**
+   * @brief <m_ringStart>, first pixel of each processed ring (a single range for the full sky)
+   */
+  std::vector<int> m_ringStart;
+
+  /**
+   * @brief <m_ringPixels>, number of pixels of each processed ring
+   */
+  std::vector<int> m_ringPixels;
+
+  struct Geometry;
+
+  /**
+   * @brief <m_geometry>, libsharp geometry and alm layout, shared by the copies of the transforms
+   */
+  std::shared_ptr<const Geometry> m_geometry;
+
+  /**
+   * @brief checks that the maps and the coefficients match the transforms
+   */
+  void checkMap(const Healpix_Map<double>& map, const Alm<xcomplex<double> >& alm) const;
+
+  /**
+   * @brief sets to zero the pixels outside the footprint rings
+   */
+  void clearOutsideFootprint(Healpix_Map<double>& map) const;
+
+  /**
+   * @brief runs the libsharp analysis or synthesis of the transforms, by jobs of at most 16 transforms
+   * @param[in] alms coefficients of each component of each transform, the components of a transform consecutive
+   * @param[in] maps maps of each component of each transform
+   */
+  void execute(bool analysis, int spin, std::vector<void*>& alms, std::vector<void*>& maps, bool add) const;
+
+  /**
+   * @brief analysis of the components (1 for spin 0, 2 otherwise) of several transforms, with the Jacobi iterations
+   */
+  void analyse(int spin, const std::vector<const Healpix_Map<double>*>& maps,
+               const std::vector<Alm<xcomplex<double> >*>& alms) const;
+
+  /**
+   * @brief synthesis of the components of several transforms
+   */
+  void synthesise(int spin, const std::vector<const Alm<xcomplex<double> >*>& alms,
+                  const std::vector<Healpix_Map<double>*>& maps) const;
+
+};  // End of SphericalTransform class
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
+
+#endif
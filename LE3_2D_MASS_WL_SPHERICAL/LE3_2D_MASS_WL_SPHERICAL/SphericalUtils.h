@@ -28,6 +28,7 @@
 #include "ElementsKernel/Logging.h"
 
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
 
 namespace Euclid {
  namespace WeakLensing {
@@ -49,6 +50,22 @@ namespace Euclid {
   */
   void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma);
 
+  /**
+  * @brief This method applies a gaussian filter, with the transforms and buffers of the workspace
+  * @param <sigma> sigma of the gaussian kernel
+  * @param <map> map in healpix format
+  * @param <workspace> transforms and pool of harmonic coefficients buffers
+  */
+  void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma,
+                              LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace);
+
+  /**
+  * @brief This method applies a gaussian filter on the harmonic coefficients of a map
+  * @param <alm> harmonic coefficients
+  * @param <sigma> sigma of the gaussian kernel
+  */
+  void applyGaussianFilter_alm(Alm<xcomplex<double> >& alm, double sigma);
+
   /**
    * @brief perform B-spline scaling function of order 3
    */
@@ -82,6 +99,12 @@ namespace Euclid {
    */
   std::vector<Healpix_Map<double> > transformBspline_hp(Healpix_Map<double>& map, int m_nbScales);
 
+  /**
+   * @brief performs b spline transformation, with the transforms and buffers of the workspace
+   */
+  std::vector<Healpix_Map<double> > transformBspline_hp(Healpix_Map<double>& map, int m_nbScales,
+                                                        LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace);
+
   /**
    * @brief reconstructs a healpix map from the vector of healpix maps for each scales
             (returned by the transformBspline method)
@@ -98,6 +121,19 @@ namespace Euclid {
    */
   Healpix_Map<double> smoothBspline_hp(Healpix_Map<double>& map, int scale);
 
+  /**
+   * @brief applies b spline transformation, with the transforms and buffers of the workspace
+   */
+  Healpix_Map<double> smoothBspline_hp(Healpix_Map<double>& map, int scale,
+                                       LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace);
+
+  /**
+   * @brief returns the rings of a footprint map, to restrict the spherical harmonic transforms
+   * @param[in] map footprint map, e.g. the binned galaxy count or the visibility mask at the nside of the maps
+   * @return increasing ring numbers (1 to 4*nside-1) with at least one non-zero pixel
+   */
+  std::vector<int> getFootprintRings(const Healpix_Map<double>& map);
+
    } /* namespace Spherical */
   } /* namespace TwoDMass */
  } /* namespace WeakLensing */
@@ -0,0 +1,124 @@
+/**
+ * @file LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _LE3_2D_MASS_WL_SPHERICAL_SPHERICALWORKSPACE_H
+#define _LE3_2D_MASS_WL_SPHERICAL_SPHERICALWORKSPACE_H
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalTransform.h"
+#include <map>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <functional>
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+/**
+ * @class SphericalWorkspace
+ * @brief Pool of the harmonic coefficients and map buffers of the spherical transforms
+ *
+ * The Alm of the band limit of a nside (about 300 MB at nside 2048) and the
+ * healpix maps are allocated at their first use and given back to the pool
+ * when the buffer returned by acquireAlm / acquireMap is destroyed, to be reused
+ * by the next transform. The peak memory is the maximum number of buffers in use
+ * at the same time, and the iterative algorithms (inpainting, wavelets) do not
+ * allocate and free them at each iteration. The content of an acquired buffer
+ * is undefined. The workspace must outlive the buffers it gives.
+ */
+class SphericalWorkspace {
+
+public:
+
+  typedef std::unique_ptr<Alm<xcomplex<double> >, std::function<void(Alm<xcomplex<double> >*)> > AlmBuffer;
+  typedef std::unique_ptr<Healpix_Map<double>, std::function<void(Healpix_Map<double>*)> > MapBuffer;
+
+  /**
+   * @brief Constructor
+   * @param[in] params SphericalParam object with the parameters of the harmonic transforms
+   */
+  explicit SphericalWorkspace(const LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~SphericalWorkspace() = default;
+
+  SphericalWorkspace(const SphericalWorkspace&) = delete;
+  SphericalWorkspace& operator=(const SphericalWorkspace&) = delete;
+
+  /**
+   * @brief returns the transforms of the maps of the given nside, created once
+   */
+  const SphericalTransform& getTransform(int nside);
+
+  /**
+   * @brief returns a set of harmonic coefficients of the band limit of the given nside
+   */
+  AlmBuffer acquireAlm(int nside);
+
+  /**
+   * @brief returns a healpix map of the given nside in RING scheme
+   */
+  MapBuffer acquireMap(int nside);
+
+  /**
+   * @brief returns the parameters of the transforms
+   */
+  LE3_2D_MASS_WL_SPHERICAL::SphericalParam& getParams();
+
+  /**
+   * @brief frees the buffers not in use
+   */
+  void release();
+
+private:
+
+  /**
+   * @brief transform and free buffers of a nside
+   */
+  struct NsideBuffers {
+    std::unique_ptr<SphericalTransform> transform;
+    std::vector<std::unique_ptr<Alm<xcomplex<double> > > > alms;
+    std::vector<std::unique_ptr<Healpix_Map<double> > > maps;
+  };
+
+  NsideBuffers& getBuffers(int nside);
+
+  /**
+   *  @brief <m_SphParam>, SphericalParam object with the parameters of the transforms
+  */
+  LE3_2D_MASS_WL_SPHERICAL::SphericalParam m_SphParam;
+
+  /**
+   *  @brief <m_buffers>, free buffers per nside
+  */
+  std::map<int, NsideBuffers> m_buffers;
+
+  std::mutex m_mutex;
+
+};  // End of SphericalWorkspace class
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
+
+#endif
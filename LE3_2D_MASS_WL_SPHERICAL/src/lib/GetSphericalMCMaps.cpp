@@ -51,37 +51,30 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
    //std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair =
    auto [ Shear1, Shear2, GalCount ] =
                               mapMaker.create_ShearMap(m_inData);
-   Sph_mass_mapping mapping;
-   std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair =
-                      mapping.create_SheartoConvMap(Shear1, Shear2);
-
-   int nside = kappaPair.first.Nside();
-
-   Healpix_Map<double> mapE;
-   mapE.SetNside(nside, RING);
-
-   Healpix_Map<double> mapB;
-   mapB.SetNside(nside, RING);
+   if (m_sphericalParam.getRingRestrictedSHT()) {
+     m_sphericalParam.setFootprintRings(GalCount.Nside(), getFootprintRings(GalCount));
+   }
+   SphericalWorkspace workspace(m_sphericalParam);
+   Sph_mass_mapping mapping(m_sphericalParam);
 
-   mapE = kappaPair.first;
-   mapB = kappaPair.second;
-   //Apply Filter
+   // Mass mapping, filter of the E-Mode and inverse mass mapping in a single harmonic pass
+   double sigma = 0.;
    if (fabs(m_sphericalParam.getSigmaGauss())>0.001){
-     applyGaussianFilter_hp(mapE, m_sphericalParam.getSigmaGauss());
-     //applyGaussianFilter_hp(mapB, m_sphericalParam.getSigmaGauss());
+     sigma = m_sphericalParam.getSigmaGauss();
    }
-
-   // Perform inverse mass mapping
-   //std::pair<Healpix_Map<double>, Healpix_Map<double> > k2shearPair =
-   //                     mapping.create_ConvtoShearMap(kappaPair.first, kappaPair.second);
-   std::pair<Healpix_Map<double>, Healpix_Map<double> > k2shearPair =
-                        mapping.create_ConvtoShearMap(mapE, mapB);
-   std::pair<Healpix_Map<double>, Healpix_Map<double> > convergencePair = std::make_pair(mapE, mapB);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > k2shearPair;
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > convergencePair;
+   mapping.create_DeNoisedShearMap(Shear1, Shear2, sigma, k2shearPair.first, k2shearPair.second,
+                                   convergencePair.first, convergencePair.second, workspace);
    mapping.computeReducedShear_hp(k2shearPair, convergencePair);
 
    return k2shearPair;
  }
 
+ LE3_2D_MASS_WL_SPHERICAL::SphericalParam GetSphericalMCMaps::getSphericalParam() {
+   return m_sphericalParam;
+ }
+
   std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > >
                            GetSphericalMCMaps::getNoisedShearMaps() {
     int Niter = m_sphericalParam.getNResamples();
@@ -127,8 +120,7 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
        g2_hmap[id_pix] = valB;
     }
     SphericalIO SphericalIO(m_sphericalParam);
-    SphericalIO.write_Map(ShearMap, g1_hmap, "GAMMA1");
-    SphericalIO.write_Map(ShearMap, g2_hmap, "GAMMA2");
+    SphericalIO.write_Maps(ShearMap, {&g1_hmap, &g2_hmap}, {"GAMMA1", "GAMMA2"});
     return true;
   }
 
@@ -23,6 +23,7 @@
 
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_map_maker.h"
 #include <cmath>
+#include <algorithm>
 //#define M_PI 3.141592653589793238462643383279502884197;
 
 using namespace Euclid::WeakLensing::TwoDMass;
@@ -32,66 +33,114 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
 
 Sph_map_maker::Sph_map_maker(LE3_2D_MASS_WL_SPHERICAL::SphericalParam &SphParam):npix(0), m_SphParam(SphParam) {}
 
-//std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_map_maker::create_ShearMap
-//                 (std::vector<std::vector<double> > &catData){
 std::tuple<Healpix_Map<double>, Healpix_Map<double>, Healpix_Map<double> > Sph_map_maker::create_ShearMap
                                                                 (std::vector<std::vector<double> > &catData) {
+  startBinning();
+  addCatalogChunk(catData);
+  return getBinnedShearMap();
+}
+
+void Sph_map_maker::startBinning() {
   int order = hb.nside2order(m_SphParam.getNside());
-  Healpix_Map<double> g1_hmap(order, RING);
-  Healpix_Map<double> g2_hmap(order, RING);
-  g1_hmap.fill(0.);
-  g2_hmap.fill(0.);
-  //npix = 12 * pow(nside,2);
-  npix = g1_hmap.Npix();
+  m_g1Sum.Set(order, RING);
+  m_g2Sum.Set(order, RING);
+  m_ngalSum.Set(order, RING);
+  m_g1Sum.fill(0.);
+  m_g2Sum.fill(0.);
+  m_ngalSum.fill(0.);
+  npix = m_g1Sum.Npix();
   logger.info()<<"npix: "<<npix;
+}
 
-  Healpix_Map<double> ngal_hp(order, RING);
-  ngal_hp.fill(0.);
-
-  int ngal=catData[0].size();
+void Sph_map_maker::addCatalogChunk(const std::vector<std::vector<double> > &chunk) {
+  long ngal=chunk[0].size();
   logger.info()<<"ngal: "<<ngal;
-  //logger.info()<<"catData[1][0]: "<<catData[1][0];
 
- for (int i= 0; i<ngal; i++) {
-  double theta, phi;
- /* if (m_SphParam.getZMin() < catData[5][i] < m_SphParam.getZMax()){
+  // pixel of each galaxy
+  std::vector<int> pixels(ngal);
+#pragma omp parallel for
+  for (long i= 0; i<ngal; i++) {
    //coordinates (theta and phi) in radian
-   theta = -M_PI/180.0 * catData[1][i] + M_PI*double(0.5);
-   phi = M_PI/180.0*(catData[0][i]);
-  } else {*/
-   //coordinates (theta and phi) in radian
-   double dec = catData[1][i];
+   double dec = chunk[1][i];
    if (isnan(dec)) {
      dec = 0.;
    }
-  // theta = -M_PI/180.0 * catData[1][i] + M_PI*double(0.5);
-   theta = -M_PI/180.0 * dec + M_PI*double(0.5);
-   //logger.info()<<"theta: "<< theta;
-   double ra = catData[0][i];
+   double theta = -M_PI/180.0 * dec + M_PI*double(0.5);
+   double ra = chunk[0][i];
    if (isnan(ra)) {
      ra = 0.;
    }
-  // phi = M_PI/180.0*(catData[0][i]);
-   phi = M_PI/180.0*(ra);
-  //}
+   double phi = M_PI/180.0*(ra);
 
    pointing ptg = pointing(theta, phi);
    ptg.normalize();
-   auto id_pix = g2_hmap.ang2pix(ptg);
-   auto id = g1_hmap.ang2pix(ptg);
-   g1_hmap[id] = g1_hmap[id] + catData[3][i];
-   g2_hmap[id_pix] = g2_hmap[id_pix] + catData[4][i];
-   ngal_hp[id_pix] = ngal_hp[id_pix] + 1.;
- }
+   pixels[i] = m_g1Sum.ang2pix(ptg);
+  }
+
+  // rows per range of pixels in each block of rows
+  long rangeSize = (long(npix) + nbPixelRanges - 1) / nbPixelRanges;
+  long nbRanges = (long(npix) + rangeSize - 1) / rangeSize;
+  long nbBlocks = (ngal + blockSize - 1) / blockSize;
+  std::vector<long> blockCounts(nbBlocks*nbRanges, 0);
+#pragma omp parallel for
+  for (long b = 0; b < nbBlocks; b++) {
+    long* counts = &blockCounts[b*nbRanges];
+    for (long i = b*blockSize; i < std::min(ngal, (b+1)*blockSize); i++) {
+      counts[pixels[i]/rangeSize]++;
+    }
+  }
+
+  // offsets of the blocks in the ranges, the rows of a range staying in the catalog order
+  std::vector<long> rangeStart(nbRanges+1, 0);
+  long offset = 0;
+  for (long r = 0; r < nbRanges; r++) {
+    rangeStart[r] = offset;
+    for (long b = 0; b < nbBlocks; b++) {
+      long count = blockCounts[b*nbRanges + r];
+      blockCounts[b*nbRanges + r] = offset;
+      offset += count;
+    }
+  }
+  rangeStart[nbRanges] = offset;
+
+  std::vector<long> rows(ngal);
+#pragma omp parallel for
+  for (long b = 0; b < nbBlocks; b++) {
+    long* offsets = &blockCounts[b*nbRanges];
+    for (long i = b*blockSize; i < std::min(ngal, (b+1)*blockSize); i++) {
+      rows[offsets[pixels[i]/rangeSize]++] = i;
+    }
+  }
+
+  // each range of pixels is summed by a single thread
+  const std::vector<double>& g1 = chunk[3];
+  const std::vector<double>& g2 = chunk[4];
+#pragma omp parallel for schedule(dynamic)
+  for (long r = 0; r < nbRanges; r++) {
+    for (long k = rangeStart[r]; k < rangeStart[r+1]; k++) {
+      long i = rows[k];
+      int id_pix = pixels[i];
+      m_g1Sum[id_pix] = m_g1Sum[id_pix] + g1[i];
+      m_g2Sum[id_pix] = m_g2Sum[id_pix] + g2[i];
+      m_ngalSum[id_pix] = m_ngalSum[id_pix] + 1.;
+    }
+  }
+}
+
+unsigned int Sph_map_maker::getCatalogColumns() {
+  return RA_COLUMN | DEC_COLUMN | G1_COLUMN | G2_COLUMN;
+}
+
+std::tuple<Healpix_Map<double>, Healpix_Map<double>, Healpix_Map<double> > Sph_map_maker::getBinnedShearMap() {
+ Healpix_Map<double> g1_hmap(m_g1Sum);
+ Healpix_Map<double> g2_hmap(m_g2Sum);
  for (unsigned int id_pix=0; id_pix<npix; id_pix++){
-   if (ngal_hp[id_pix] != 0){
-     g1_hmap[id_pix] = g1_hmap[id_pix]/ngal_hp[id_pix];
-     g2_hmap[id_pix] = g2_hmap[id_pix]/ngal_hp[id_pix];
+   if (m_ngalSum[id_pix] != 0){
+     g1_hmap[id_pix] = g1_hmap[id_pix]/m_ngalSum[id_pix];
+     g2_hmap[id_pix] = g2_hmap[id_pix]/m_ngalSum[id_pix];
    }
  }
- //free(ngal_hp);
- //return std::pair<Healpix_Map<double>, Healpix_Map<double> > (g1_hmap, g2_hmap);
- return std::make_tuple(g1_hmap, g2_hmap, ngal_hp);
+ return std::make_tuple(g1_hmap, g2_hmap, m_ngalSum);
 }
 
 } // namespace LE3_2D_MASS_WL_SPHERICAL
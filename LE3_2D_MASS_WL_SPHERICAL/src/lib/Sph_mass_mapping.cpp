@@ -22,9 +22,12 @@
  */
 
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_mass_mapping.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "ElementsKernel/Exception.h"
 
 #include <cmath>
 #include <complex>
+#include <algorithm>
 
 #include <iostream>
 #include <fstream>
@@ -37,6 +40,9 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
 
 Sph_mass_mapping::Sph_mass_mapping(): m_nside(2048) { }
 
+Sph_mass_mapping::Sph_mass_mapping(const LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params):
+                                   m_nside(2048), m_SphParam(params) { }
+
 std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_mass_mapping::create_SheartoConvMap
                                            (Healpix_Map<double>& mapE, Healpix_Map<double>& mapB){
  return sphMassMap (Euclid::WeakLensing::TwoDMass::mapType::shearMap, mapE, mapB);
@@ -47,6 +53,16 @@ std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_mass_mapping::create_Co
  return sphMassMap (Euclid::WeakLensing::TwoDMass::mapType::convMap, mapE, mapB);
 }
 
+void Sph_mass_mapping::create_SheartoConvMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                     Healpix_Map<double>& outE, Healpix_Map<double>& outB, SphericalWorkspace& workspace) {
+ sphMassMap (Euclid::WeakLensing::TwoDMass::mapType::shearMap, mapE, mapB, outE, outB, workspace);
+}
+
+void Sph_mass_mapping::create_ConvtoShearMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                     Healpix_Map<double>& outE, Healpix_Map<double>& outB, SphericalWorkspace& workspace) {
+ sphMassMap (Euclid::WeakLensing::TwoDMass::mapType::convMap, mapE, mapB, outE, outB, workspace);
+}
+
 void Sph_mass_mapping::correctScheme (Healpix_Map<double>* map) {
  if (map->Scheme()==NEST ) {
   map->swap_scheme();
@@ -55,43 +71,164 @@ void Sph_mass_mapping::correctScheme (Healpix_Map<double>* map) {
 
 std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_mass_mapping::sphMassMap
             (const Euclid::WeakLensing::TwoDMass::mapType type, Healpix_Map<double>& mapE, Healpix_Map<double>& mapB) {
+  SphericalWorkspace workspace(m_SphParam);
+  std::pair<Healpix_Map<double>, Healpix_Map<double> > outPair;
+  sphMassMap (type, mapE, mapB, outPair.first, outPair.second, workspace);
+  return outPair;
+}
+
+void Sph_mass_mapping::sphMassMap(const Euclid::WeakLensing::TwoDMass::mapType type, Healpix_Map<double>& mapE,
+                                  Healpix_Map<double>& mapB, Healpix_Map<double>& out_mapE,
+                                  Healpix_Map<double>& out_mapB, SphericalWorkspace& workspace) {
 
   correctScheme (&mapE);
   correctScheme (&mapB);
   m_nside = mapE.Nside();
-  int m_nlmax = 3*m_nside-1;
   logger.info()<<"nside: "<<m_nside;
 
-  Healpix_Map<double> T;
-  T.SetNside(m_nside, RING);
-  T.fill(0.);
+  // The output maps are reused when they already have the right size
+  if (out_mapE.Nside() != m_nside || out_mapE.Scheme() != RING) {
+    out_mapE.SetNside(m_nside, RING);
+  }
+  if (out_mapB.Nside() != m_nside || out_mapB.Scheme() != RING) {
+    out_mapB.SetNside(m_nside, RING);
+  }
+
+  const SphericalTransform& transform = workspace.getTransform(m_nside);
+
+  SphericalWorkspace::AlmBuffer alm_E = workspace.acquireAlm(m_nside);
+  SphericalWorkspace::AlmBuffer alm_B = workspace.acquireAlm(m_nside);
+  Alm<xcomplex<double> >& alm_mapE = *alm_E;
+  Alm<xcomplex<double> >& alm_mapB = *alm_B;
 
-  Healpix_Map<double> out_mapE;
-  out_mapE.SetNside(m_nside, RING);
-  out_mapE.fill(0.);
+ // The shear is a spin-2 field and the convergence a scalar one: the transforms are done
+ // by the spin-2 and spin-0 routines only, without carrying a temperature map of zeros
+ if (type==Euclid::WeakLensing::TwoDMass::mapType::shearMap){
+  transform.map2alm_spin(mapE, mapB, alm_mapE, alm_mapB, 2);
+  applyKernel(type, alm_mapE, alm_mapB);
+  transform.alm2map(alm_mapE, out_mapE);
+  transform.alm2map(alm_mapB, out_mapB);
+ }
+ if (type==Euclid::WeakLensing::TwoDMass::mapType::convMap){
+  //map2alm(mapE, alm_mapE, weight);
+  //map2alm(mapB, alm_mapB, weight);
+  transform.map2alm(mapE, alm_mapE);
+  transform.map2alm(mapB, alm_mapB);
+  applyKernel(type, alm_mapE, alm_mapB);
+  transform.alm2map_spin(alm_mapE, alm_mapB, out_mapE, out_mapB, 2);
+ }
+}
 
-  Healpix_Map<double> out_mapB;
-  out_mapB.SetNside(m_nside, RING);
-  out_mapB.fill(0.);
+std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > Sph_mass_mapping::create_SheartoConvMaps
+                (std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > >& shearPairs,
+                 SphericalWorkspace& workspace, int batchSize) {
+ if (batchSize <= 0) {
+  batchSize = defaultBatchSize;
+ }
+ int nbMaps = shearPairs.size();
+ std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > kappaPairs(nbMaps);
+ logger.info()<<"Mass mapping of "<<nbMaps<<" maps by batches of "<<batchSize;
 
-  arr<double> weight;
-  weight.alloc(3*m_nside-1);
-  weight.fill(1.);
+ // The maps of a batch are transformed by a single libsharp job: one spin-2 analysis of all the shear
+ // maps and one spin-0 synthesis of all the convergence maps, the Legendre recursion being shared
+ for (int first = 0; first < nbMaps; first += batchSize) {
+  int last = std::min(first + batchSize, nbMaps);
+  m_nside = shearPairs[first].first.Nside();
+  const SphericalTransform& transform = workspace.getTransform(m_nside);
 
-  Alm<xcomplex<double> > almT( m_nlmax, m_nlmax);
-  Alm<xcomplex<double> > alm_mapE( m_nlmax, m_nlmax);
-  Alm<xcomplex<double> > alm_mapB( m_nlmax, m_nlmax);
-  almT.SetToZero();
-  alm_mapE.SetToZero();
-  alm_mapB.SetToZero();
+  std::vector<const Healpix_Map<double>*> maps1, maps2;
+  std::vector<SphericalWorkspace::AlmBuffer> almBuffers;
+  std::vector<Alm<xcomplex<double> >*> almsE, almsB;
+  std::vector<const Alm<xcomplex<double> >*> alms;
+  std::vector<Healpix_Map<double>*> outMaps;
+  for (int i = first; i < last; i++) {
+   correctScheme (&shearPairs[i].first);
+   correctScheme (&shearPairs[i].second);
+   if (shearPairs[i].first.Nside() != m_nside || shearPairs[i].second.Nside() != m_nside) {
+    throw Elements::Exception() << "Shear maps of nside " << shearPairs[i].first.Nside()
+                                << " in a batch of nside " << m_nside;
+   }
+   maps1.push_back(&shearPairs[i].first);
+   maps2.push_back(&shearPairs[i].second);
+   almBuffers.push_back(workspace.acquireAlm(m_nside));
+   almsE.push_back(almBuffers.back().get());
+   almBuffers.push_back(workspace.acquireAlm(m_nside));
+   almsB.push_back(almBuffers.back().get());
+   alms.push_back(almsE.back());
+   alms.push_back(almsB.back());
+   kappaPairs[i].first.SetNside(m_nside, RING);
+   kappaPairs[i].second.SetNside(m_nside, RING);
+   outMaps.push_back(&kappaPairs[i].first);
+   outMaps.push_back(&kappaPairs[i].second);
+  }
 
- if (type==Euclid::WeakLensing::TwoDMass::mapType::shearMap){
-  map2alm_pol_iter(T, mapE, mapB, almT, alm_mapE, alm_mapB, 3, weight);
- // map2alm_pol(T, mapE, mapB, almT, alm_mapE, alm_mapB, weight, false);
-  almT.SetToZero();
+  transform.map2alm_spin(maps1, maps2, almsE, almsB, 2);
+  for (size_t k = 0; k < almsE.size(); k++) {
+   applyKernel(Euclid::WeakLensing::TwoDMass::mapType::shearMap, *almsE[k], *almsB[k]);
+  }
+  transform.alm2map(alms, outMaps);
+ }
+ return kappaPairs;
+}
+
+void Sph_mass_mapping::create_SmoothedSheartoConvMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                     double sigma, Healpix_Map<double>& outE, Healpix_Map<double>& outB,
+                     SphericalWorkspace& workspace, Healpix_Map<double>* smoothedE, Healpix_Map<double>* smoothedB) {
+ sphFilterChain(mapE, mapB, sigma, sigma, smoothedE, smoothedB, outE, outB, workspace);
+}
+
+void Sph_mass_mapping::create_DeNoisedShearMap(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB, double sigma,
+                     Healpix_Map<double>& outGamma1, Healpix_Map<double>& outGamma2,
+                     Healpix_Map<double>& outKappaE, Healpix_Map<double>& outKappaB, SphericalWorkspace& workspace) {
+ // The kernels and the smoothing are diagonal in (l,m): the shear of the smoothed convergence
+ // is the shear of the smoothed E-Mode, without the convergence-to-shear pass
+ sphFilterChain(mapE, mapB, sigma, 0., &outGamma1, &outGamma2, outKappaE, outKappaB, workspace);
+}
+
+void Sph_mass_mapping::sphFilterChain(Healpix_Map<double>& mapE, Healpix_Map<double>& mapB,
+                     double sigmaE, double sigmaB, Healpix_Map<double>* outGamma1, Healpix_Map<double>* outGamma2,
+                     Healpix_Map<double>& outKappaE, Healpix_Map<double>& outKappaB, SphericalWorkspace& workspace) {
+
+  correctScheme (&mapE);
+  correctScheme (&mapB);
+  m_nside = mapE.Nside();
+  logger.info()<<"nside: "<<m_nside;
+
+  const SphericalTransform& transform = workspace.getTransform(m_nside);
+  SphericalWorkspace::AlmBuffer alm_E = workspace.acquireAlm(m_nside);
+  SphericalWorkspace::AlmBuffer alm_B = workspace.acquireAlm(m_nside);
+  Alm<xcomplex<double> >& alm_mapE = *alm_E;
+  Alm<xcomplex<double> >& alm_mapB = *alm_B;
 
+  transform.map2alm_spin(mapE, mapB, alm_mapE, alm_mapB, 2);
+  if (sigmaE != 0.) {
+    applyGaussianFilter_alm(alm_mapE, sigmaE);
+  }
+  if (sigmaB != 0.) {
+    applyGaussianFilter_alm(alm_mapB, sigmaB);
+  }
+
+  std::vector<Healpix_Map<double>*> outMaps = {outGamma1, outGamma2, &outKappaE, &outKappaB};
+  for (Healpix_Map<double>* map : outMaps) {
+    if (map != nullptr && (map->Nside() != m_nside || map->Scheme() != RING)) {
+      map->SetNside(m_nside, RING);
+    }
+  }
+  if (outGamma1 != nullptr && outGamma2 != nullptr) {
+    transform.alm2map_spin(alm_mapE, alm_mapB, *outGamma1, *outGamma2, 2);
+  }
+  applyKernel(Euclid::WeakLensing::TwoDMass::mapType::shearMap, alm_mapE, alm_mapB);
+  transform.alm2map(alm_mapE, outKappaE);
+  transform.alm2map(alm_mapB, outKappaB);
+}
+
+void Sph_mass_mapping::applyKernel(const Euclid::WeakLensing::TwoDMass::mapType type,
+                                   Alm<xcomplex<double> >& alm_mapE, Alm<xcomplex<double> >& alm_mapB) {
+ int m_nlmax = alm_mapE.Lmax();
+ int m_nmmax = alm_mapE.Mmax();
+ if (type==Euclid::WeakLensing::TwoDMass::mapType::shearMap){
   for (int l_index = 0; l_index<=m_nlmax; ++l_index) {
-   for (int m_index = 0; m_index<=l_index; ++m_index){
+   for (int m_index = 0; m_index<=std::min(l_index, m_nmmax); ++m_index){
     if (l_index!=1){
      double temp = sqrt(((l_index+1.0)*l_index) / ((l_index+2.)*(l_index-1.)));
      if (isnan(temp)) {
@@ -107,17 +244,10 @@ std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_mass_mapping::sphMassMa
     }
    }
   }
-  alm2map( alm_mapE, out_mapE);
-  alm2map( alm_mapB, out_mapB);
  }
  if (type==Euclid::WeakLensing::TwoDMass::mapType::convMap){
-  //map2alm(mapE, alm_mapE, weight);
-  //map2alm(mapB, alm_mapB, weight);
-  map2alm_iter(mapE, alm_mapE, 3, weight);
-  map2alm_iter(mapB, alm_mapB, 3, weight);
-
   for (int l_index =0; l_index<=m_nlmax; ++l_index) {
-   for (int m_index = 0; m_index<=l_index; ++m_index){
+   for (int m_index = 0; m_index<=std::min(l_index, m_nmmax); ++m_index){
     if (l_index!=0){
      double temp = sqrt(((l_index+2.)*(l_index-1.)) / ((l_index+1.0)*l_index));
      if (isnan(temp)) {
@@ -133,10 +263,7 @@ std::pair<Healpix_Map<double>, Healpix_Map<double> > Sph_mass_mapping::sphMassMa
     }
    }
   }
-  alm2map_pol(almT, alm_mapE, alm_mapB, T, out_mapE, out_mapB);
  }
- weight.dealloc();
- return std::pair<Healpix_Map<double>, Healpix_Map<double> > (out_mapE, out_mapB);
 }
 
  int Sph_mass_mapping::getNside() {
@@ -22,6 +22,9 @@
  */
 
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalIO.h"
+#include "ElementsKernel/Exception.h"
+
+#include <algorithm>
 
 using namespace Euclid::WeakLensing::TwoDMass;
 
@@ -65,16 +68,16 @@ void SphericalIO::writePrimaryHeader(const RecordHdu &hdu) {
   hdu.writeRecords(records);
 }
 
-void SphericalIO::writeHdu(const RecordHdu &hdu, int Nside) {
+void SphericalIO::writeHdu(const RecordHdu &hdu, int Nside, bool partialSky) {
 
   std::vector<Record<boost::any>> records = {
     { "PIXTYPE", "HEALPIX", "", "HEALPIX Pixelisation" },
     { "ORDERING", "RING", "", "Pixel ordering scheme, either RING or NESTED" },
     { "NSIDE", Nside, "", "Resolution parameter of HEALPIX" },
     { "FIRSTPIX", "0", "", "First pixel # (0 based)" },
-    { "LASTPIX", "", "", "Last pixel # (0 based)" },
-    { "INDXSCHM","", "", "Indexing: IMPLICIT or EXPLICIT" },
-    { "OBJECT", "0", "", "Sky coverage, either FULLSKY or PARTIAL" },
+    { "LASTPIX", 12L*Nside*Nside-1, "", "Last pixel # (0 based)" },
+    { "INDXSCHM", partialSky ? "EXPLICIT" : "IMPLICIT", "", "Indexing: IMPLICIT or EXPLICIT" },
+    { "OBJECT", partialSky ? "PARTIAL" : "FULLSKY", "", "Sky coverage, either FULLSKY or PARTIAL" },
     { "ZMIN", "", "", "" },
     { "ZMAX","", "", "" },
   };
@@ -137,6 +140,86 @@ bool SphericalIO::write_Map (const std::string& filename, Healpix_Map<double>& m
 
  return true;
 }
+bool SphericalIO::write_Maps (const std::string& filename, const std::vector<const Healpix_Map<double>*>& maps,
+                              const std::vector<std::string>& colnames) {
+  if (maps.empty() || maps.size() > 3 || maps.size() != colnames.size()) {
+    throw Elements::Exception() << "Between 1 and 3 maps with their column names are written in a file, got "
+                                << maps.size() << " maps and " << colnames.size() << " column names";
+  }
+  const int npix = maps[0]->Npix();
+  for (const Healpix_Map<double>* map : maps) {
+    if (map->Npix() != npix || map->Scheme() != RING) {
+      throw Elements::Exception() << "The maps written in " << filename << " must share Nside and RING ordering";
+    }
+  }
+  if (colnames[0].compare("GALCOUNT") == 0 ) {
+    std::string GalExt = "GALCOUNT_SPHERE";
+    m_SphParam.setExtName(GalExt);
+  }
+  const bool partialSky = m_SphParam.getPartialSkyMaps();
+
+  // explicit indexing: only the pixels observed (non zero in one of the maps) are written, with their index
+  std::vector<int> pixels;
+  if (partialSky) {
+    for (int pix = 0; pix < npix; pix++) {
+      for (const Healpix_Map<double>* map : maps) {
+        if ((*map)[pix] != 0.) {
+          pixels.push_back(pix);
+          break;
+        }
+      }
+    }
+  }
+
+  MefFile SphFile(filename, MefFile::Permission::Overwrite);
+  const auto &primary = SphFile.accessPrimary<>();
+  writePrimaryHeader(primary);
+  if (m_SphParam.getMapSinglePrecision()) {
+    const auto &ext = assignMapsExt<float>(SphFile, maps, colnames, partialSky, pixels);
+    writeHdu(ext, maps[0]->Nside(), partialSky);
+  } else {
+    const auto &ext = assignMapsExt<double>(SphFile, maps, colnames, partialSky, pixels);
+    writeHdu(ext, maps[0]->Nside(), partialSky);
+  }
+
+ return true;
+}
+
+template <typename T>
+const BintableHdu& SphericalIO::assignMapsExt(MefFile& SphFile, const std::vector<const Healpix_Map<double>*>& maps,
+                           const std::vector<std::string>& colnames, bool partialSky, const std::vector<int>& pixels) {
+  std::vector<VecColumn<T> > columns;
+  for (size_t i = 0; i < maps.size(); i++) {
+    const Healpix_Map<double>& map = *maps[i];
+    std::vector<T> values(partialSky ? pixels.size() : size_t(map.Npix()));
+    for (size_t pix = 0; pix < values.size(); pix++) {
+      values[pix] = T(map[partialSky ? pixels[pix] : int(pix)]);
+    }
+    columns.push_back(VecColumn<T>({ colnames[i], "", 1 }, std::move(values)));
+  }
+
+  // all the columns in a single table write
+  const std::string extName = m_SphParam.getExtName();
+  if (partialSky) {
+    const VecColumn<int> pixelColumn({ "PIXEL", "", 1 }, pixels);
+    switch (columns.size()) {
+      case 1: return SphFile.assignBintableExt(extName, pixelColumn, columns[0]);
+      case 2: return SphFile.assignBintableExt(extName, pixelColumn, columns[0], columns[1]);
+      default: return SphFile.assignBintableExt(extName, pixelColumn, columns[0], columns[1], columns[2]);
+    }
+  }
+  switch (columns.size()) {
+    case 1: return SphFile.assignBintableExt(extName, columns[0]);
+    case 2: return SphFile.assignBintableExt(extName, columns[0], columns[1]);
+    default: return SphFile.assignBintableExt(extName, columns[0], columns[1], columns[2]);
+  }
+}
+
+std::vector<Healpix_Map<double> > SphericalIO::read_Maps (const std::string& filename,
+                                                          std::vector<std::string>& colnames) {
+  return readHealpixMaps(filename, colnames);
+}
+
    } /* namespace Spherical */
   } /* namespace TwoDMass */
  } /* namespace WeakLensing */
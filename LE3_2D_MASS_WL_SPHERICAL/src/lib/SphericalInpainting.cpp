@@ -29,13 +29,26 @@ static Elements::Logging logger = Elements::Logging::getLogger("Spherical Inpain
 
 namespace LE3_2D_MASS_WL_SPHERICAL {
 
+namespace {
+ // The inpainting estimates the maps in the masked pixels, the pixels off the footprint included:
+ // its transforms are full sky, whatever the footprint rings of the mass mapping
+ LE3_2D_MASS_WL_SPHERICAL::SphericalParam fullSkyParams(const LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params) {
+  LE3_2D_MASS_WL_SPHERICAL::SphericalParam fullSky(params);
+  fullSky.setFootprintRings(0, {});
+  return fullSky;
+ }
+}
+
  SphericalInpainting::SphericalInpainting(std::pair<Healpix_Map<double>, Healpix_Map<double> >& shear,
                                     std::pair<Healpix_Map<double>, Healpix_Map<double> >& convergence,
                 LE3_2D_MASS_WL_SPHERICAL::SphericalParam &SphericalParam): m_SphParam(SphericalParam),
-          ShearE(shear.first), ShearB(shear.second), KappaE(convergence.first), KappaB(convergence.second) {
+          ShearE(shear.first), ShearB(shear.second), KappaE(convergence.first), KappaB(convergence.second),
+          m_workspace(fullSkyParams(SphericalParam)) {
 
    m_nside = ShearE.Nside();
-   m_nlmax = 3*m_nside-1;
+   const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+   m_nlmax = transform.getLmax();
+   m_nmmax = transform.getMmax();
    m_npix = ShearE.Npix();
    m_order = ShearE.Order();
    m_minThreshold = 0.;
@@ -47,6 +60,7 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
       m_nbScales = int (log10(m_nside)/log10(2.));
    }
    logger.info()<<"nbScales: "<< m_nbScales;
+   m_starlet.reset(new SphericalStarlet(m_workspace, m_nside, std::max(m_nbScales, 1)));
    unsigned int count(0);
    Mask.SetNside(m_nside, RING);
    Mask.fill(1);
@@ -65,35 +79,27 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
  std::pair<Healpix_Map<double>, Healpix_Map<double> > SphericalInpainting::maskInversion(Healpix_Map<double>& kE,
                                                                             Healpix_Map<double>& kB){
     bool bModeZeros = m_SphParam.getBmodesZeros();
-    Healpix_Map<double> mapE;
-    Healpix_Map<double> mapB;
-    mapE.SetNside(m_nside, RING);
-    mapE.fill(0.);
-    mapB.SetNside(m_nside, RING);
-    mapB.fill(0.);
+    SphericalWorkspace::MapBuffer mapE = m_workspace.acquireMap(m_nside);
+    SphericalWorkspace::MapBuffer mapB = m_workspace.acquireMap(m_nside);
     for (int it = 0; it<m_npix; it++) {
-      mapE[it] = kE[it];
+      (*mapE)[it] = kE[it];
       if ((bModeZeros == true) && (Mask[it] == 0)) {
-        mapB[it] = 0.;
+        (*mapB)[it] = 0.;
       } else {
-        mapB[it] = kB[it];
+        (*mapB)[it] = kB[it];
       }
     }
 
-    LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping mapping;
-    std::pair<Healpix_Map<double>, Healpix_Map<double> > gammaPair =
-                      mapping.create_ConvtoShearMap(mapE, mapB);
-    Healpix_Map<double> gamma1, gamma2;
-    gamma1.SetNside(m_nside, RING);
-    gamma1.fill(0.);
-    gamma2.SetNside(m_nside, RING);
-    gamma2.fill(0.);
+    LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping mapping(m_SphParam);
+    SphericalWorkspace::MapBuffer gamma1 = m_workspace.acquireMap(m_nside);
+    SphericalWorkspace::MapBuffer gamma2 = m_workspace.acquireMap(m_nside);
+    mapping.create_ConvtoShearMap(*mapE, *mapB, *gamma1, *gamma2, m_workspace);
     for (int it = 0; it<m_npix; it++) {
-      gamma1[it] = gammaPair.first[it] * (1-Mask[it]) + ShearE[it] * Mask[it];
-      gamma2[it] = gammaPair.second[it] * (1-Mask[it]) + ShearB[it] * Mask[it];
+      (*gamma1)[it] = (*gamma1)[it] * (1-Mask[it]) + ShearE[it] * Mask[it];
+      (*gamma2)[it] = (*gamma2)[it] * (1-Mask[it]) + ShearB[it] * Mask[it];
     }
-    std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair =
-                      mapping.create_SheartoConvMap(gamma1, gamma2);
+    std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair;
+    mapping.create_SheartoConvMap(*gamma1, *gamma2, kappaPair.first, kappaPair.second, m_workspace);
     return kappaPair;
  }
 
@@ -148,75 +154,31 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
 
  Healpix_Map<double> SphericalInpainting::performWavelet(Healpix_Map<double>& map) {
 
-   arr<double> weight;
-   weight.alloc(3*m_nside-1);
-   weight.fill(1.);
-
-   Alm<xcomplex<double> > map_lm(m_nlmax, m_nlmax);
-   map_lm.SetToZero();
-
-   map2alm_iter (map, map_lm, 3, weight);
-
    Healpix_Map<double> Result;
-   Healpix_Map<double> Resi;
-   Healpix_Map<double> Band;
    Result.SetNside(m_nside, RING);
-   Resi.SetNside(m_nside, RING);
-   Band.SetNside(m_nside, RING);
    Result.fill(0.);
-   Resi.fill(0.);
-   Band.fill(0.);
-
-   for (int it = 0; it<m_npix; it++) {
-       Result[it] = map[it];
-   }
-
-   for (int b=0; b < m_nbScales; b++) {
-
-     double lc = m_nlmax*pow(0.5, b);
-     double* Filter = new double[m_nlmax+1];
-     std::fill_n(Filter, m_nlmax+1, 0);
-     getFilter(Filter, lc, m_nlmax);
+   int lastScale = m_starlet->getNbScales()-1;
 
-     if (b == m_nbScales-1) {
-       for (int it = 0; it<m_npix; it++) {
-         Band[it] = Result[it];
-       }
-     } else {
-       Alm<xcomplex<double> > Band_lm(m_nlmax, m_nlmax);
-       Band_lm.SetToZero();
-
-       for (int l=0; l<=m_nlmax; ++l) {
-         for (int m=0; m<=l; ++m) {
-            Band_lm(l,m) = Filter[l] * map_lm(l,m);
-         }
-       }
-       alm2map(Band_lm, Band);
-
-       delete[] Filter;
-
-       for (int it = 0; it<m_npix; it++) {
-         double val = Band[it];
-         Band[it] = Result[it] - val;
-         Result[it] = val;
-       }
-       applyConstraintsOnWavelets(Band);
-     } // end of if-else
+   // The bands come from one batched synthesis, the constrained bands being summed
+   std::vector<Healpix_Map<double> > Bands = m_starlet->decompose(map);
+   for (int scale = 0; scale <= lastScale; scale++) {
+     if (scale < lastScale) {
+       applyConstraintsOnWavelets(Bands[scale]);
+     }
      for (int it = 0; it<m_npix; it++) {
-         Resi[it] += Band[it];
+       Result[it] += Bands[scale][it];
      }
-   }// end of for (nbSclaes)
-
-   for (int it = 0; it<m_npix; it++) {
-      Result[it] = Resi[it];
    }
-   weight.dealloc();
   return Result;
  }
 
 
  std::pair<Healpix_Map<double>, Healpix_Map<double> > SphericalInpainting::performInpainting () {
 
+   if (m_SphParam.getHarmonicInpainting() == true) {
+     return performHarmonicInpainting();
+   }
+
    int nbIter = m_SphParam.getNInpaint();
    bool sigmaBounds = m_SphParam.getEqualVarPerScale();
    //logger.info()<<"sigmaBounds: "<<sigmaBounds;
@@ -232,24 +194,16 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
 
    outKappaE = KappaE;
    outKappaB = KappaB;
+   const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+   SphericalWorkspace::AlmBuffer kE_buffer = m_workspace.acquireAlm(m_nside);
+   SphericalWorkspace::AlmBuffer kB_buffer = m_workspace.acquireAlm(m_nside);
+   Alm<xcomplex<double> >& kE_lm = *kE_buffer;
+   Alm<xcomplex<double> >& kB_lm = *kB_buffer;
    for (int iter = 0; iter<nbIter; iter++) {
     logger.info()<<"start of iteration: "<<iter;
 
-   arr<double> weightE;
-   weightE.alloc(3*m_nside-1);
-   weightE.fill(1.);
-
-   arr<double> weightB;
-   weightB.alloc(3*m_nside-1);
-   weightB.fill(1.);
-
-    Alm<xcomplex<double> > kE_lm( m_nlmax, m_nlmax);
-    Alm<xcomplex<double> > kB_lm( m_nlmax, m_nlmax);
-    kE_lm.SetToZero();
-    kB_lm.SetToZero();
-
-    map2alm_iter (outKappaE, kE_lm, 3, weightE);
-    map2alm_iter (outKappaB, kB_lm, 3, weightB);
+    transform.map2alm(outKappaE, kE_lm);
+    transform.map2alm(outKappaB, kB_lm);
 
     //if (maxThreshold <=0 || iter == 0) {
     if (iter == 0) {
@@ -271,8 +225,8 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
     kE_lm(0,0) = kE_lm_0;
     kB_lm(0,0) = kB_lm_0;
 
-    alm2map(kE_lm, outKappaE);
-    alm2map(kB_lm, outKappaB);
+    transform.alm2map(kE_lm, outKappaE);
+    transform.alm2map(kB_lm, outKappaB);
 
      if (sigmaBounds) {
       outKappaE = performWavelet(outKappaE);
@@ -287,11 +241,103 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
     outKappaB = outMapPair.second;
 
     logger.info()<<"end of iteration: "<<iter;
+   } //end of for loop => max iter for inpainting
+
+  return std::pair<Healpix_Map<double>, Healpix_Map<double> > (outKappaE, outKappaB);
+ }
+
+ void SphericalInpainting::harmonicMaskInversion(Alm<xcomplex<double> >& kE_lm, Alm<xcomplex<double> >& kB_lm) {
+
+   bool bModeZeros = m_SphParam.getBmodesZeros();
+   const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+   LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping mapping(m_SphParam);
+
+   // The B-mode is set to zero inside the mask in pixel space
+   if (bModeZeros == true) {
+     SphericalWorkspace::MapBuffer mapB = m_workspace.acquireMap(m_nside);
+     transform.alm2map(kB_lm, *mapB);
+     for (int it = 0; it<m_npix; it++) {
+       if (Mask[it] == 0) {
+         (*mapB)[it] = 0.;
+       }
+     }
+     transform.map2alm(*mapB, kB_lm);
+   }
+
+   // Shear of the model, replaced by the observed shear outside the mask
+   mapping.applyKernel(Euclid::WeakLensing::TwoDMass::mapType::convMap, kE_lm, kB_lm);
+   SphericalWorkspace::MapBuffer gamma1 = m_workspace.acquireMap(m_nside);
+   SphericalWorkspace::MapBuffer gamma2 = m_workspace.acquireMap(m_nside);
+   transform.alm2map_spin(kE_lm, kB_lm, *gamma1, *gamma2, 2);
+   for (int it = 0; it<m_npix; it++) {
+     (*gamma1)[it] = (*gamma1)[it] * (1-Mask[it]) + ShearE[it] * Mask[it];
+     (*gamma2)[it] = (*gamma2)[it] * (1-Mask[it]) + ShearB[it] * Mask[it];
+   }
+   transform.map2alm_spin(*gamma1, *gamma2, kE_lm, kB_lm, 2);
+   mapping.applyKernel(Euclid::WeakLensing::TwoDMass::mapType::shearMap, kE_lm, kB_lm);
+ }
 
-    weightE.dealloc();
-    weightB.dealloc();
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > SphericalInpainting::performHarmonicInpainting () {
+
+   int nbIter = m_SphParam.getNInpaint();
+   if (nbIter <= 0) {
+     return std::pair<Healpix_Map<double>, Healpix_Map<double> > (KappaE, KappaB);
+   }
+   bool sigmaBounds = m_SphParam.getEqualVarPerScale();
+   double maxThreshold(m_maxThreshold);
+   double minThreshold(m_minThreshold);
+
+   const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+   SphericalWorkspace::AlmBuffer kE_buffer = m_workspace.acquireAlm(m_nside);
+   SphericalWorkspace::AlmBuffer kB_buffer = m_workspace.acquireAlm(m_nside);
+   Alm<xcomplex<double> >& kE_lm = *kE_buffer;
+   Alm<xcomplex<double> >& kB_lm = *kB_buffer;
+
+   // The estimate is analysed once, then stays in harmonic space
+   transform.map2alm(KappaE, kE_lm);
+   transform.map2alm(KappaB, kB_lm);
+
+   for (int iter = 0; iter<nbIter; iter++) {
+    logger.info()<<"start of iteration: "<<iter;
+
+    if (iter == 0) {
+     maxThreshold = max_abs_alm (kE_lm, m_nlmax);
+    }
+    double lambda = minThreshold + (maxThreshold - minThreshold) * (erfc(2.8*iter/nbIter));
+    if (iter==nbIter-1) {
+      lambda = minThreshold;
+    }
+
+    std::complex<double> kE_lm_0 = kE_lm(0,0);
+    std::complex<double> kB_lm_0 = kB_lm(0,0);
+    logger.info()<<"threshold: "<< lambda;
+
+    applyThreshold(kE_lm, lambda, m_nlmax);
+    applyThreshold(kB_lm, lambda, m_nlmax);
+
+    kE_lm(0,0) = kE_lm_0;
+    kB_lm(0,0) = kB_lm_0;
+
+    // The constraints on the wavelets are applied in pixel space
+    if (sigmaBounds) {
+     SphericalWorkspace::MapBuffer mapE = m_workspace.acquireMap(m_nside);
+     transform.alm2map(kE_lm, *mapE);
+     Healpix_Map<double> waveE = performWavelet(*mapE);
+     transform.map2alm(waveE, kE_lm);
+    }
+
+    harmonicMaskInversion(kE_lm, kB_lm);
+
+    logger.info()<<"end of iteration: "<<iter;
    } //end of for loop => max iter for inpainting
 
+   Healpix_Map<double> outKappaE;
+   Healpix_Map<double> outKappaB;
+   outKappaE.SetNside(m_nside, RING);
+   outKappaB.SetNside(m_nside, RING);
+   transform.alm2map(kE_lm, outKappaE);
+   transform.alm2map(kB_lm, outKappaB);
+
   return std::pair<Healpix_Map<double>, Healpix_Map<double> > (outKappaE, outKappaB);
  }
 
@@ -37,7 +37,8 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
  SphericalParam::SphericalParam():m_nside(2048), m_NItReducedShear(0), m_NInpaint(10), m_BmodesZeros(0),
                                   m_EqualVarPerScale(0), m_NInpScales(1), m_Nbins(1), m_Zmin(0.0), m_Zmax(10.0),
                                   m_balancedBins(1), m_sigmaGauss(0.0), m_thresholdFDR(0.0), m_NResamples(0),
-                                  m_RSsigmaGauss(0.0), ExtName("KAPPA_SPHERE")
+                                  m_RSsigmaGauss(0.0), ExtName("KAPPA_SPHERE"), m_ringWeightsDir(""), m_lmax(0), m_mmax(0), m_shtBatchSize(0), m_footprintNside(0),
+                                  m_mapSinglePrecision(false), m_partialSkyMaps(false), m_harmonicInpainting(false), m_ringRestrictedSHT(false)
  {}
 
  SphericalParam::SphericalParam (int nside, int NItReducedShear, int NInpaint, long BmodesZeros, long EqualVarPerScale,
@@ -46,7 +47,8 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
                    m_NItReducedShear(NItReducedShear), m_NInpaint(NInpaint), m_BmodesZeros(BmodesZeros),
                    m_EqualVarPerScale(EqualVarPerScale), m_NInpScales(NInpScales), m_Nbins(Nbins), m_Zmin(Zmin),
                    m_Zmax(Zmax), m_balancedBins(balancedBins), m_RSsigmaGauss(RSsigmaGauss), m_sigmaGauss(sigmaGauss),
-                   m_thresholdFDR(threshold), m_NResamples(NResamples), ExtName(ExtensionName)
+                   m_thresholdFDR(threshold), m_NResamples(NResamples), ExtName(ExtensionName), m_ringWeightsDir(""), m_lmax(0), m_mmax(0), m_shtBatchSize(0), m_footprintNside(0),
+                   m_mapSinglePrecision(false), m_partialSkyMaps(false), m_harmonicInpainting(false), m_ringRestrictedSHT(false)
  {}
 
  SphericalParam SphericalParam::getConvergenceSphereParam(const std::string& paramConvFile) {
@@ -168,4 +170,60 @@ namespace LE3_2D_MASS_WL_SPHERICAL {
  void SphericalParam::setExtName(std::string& name) {
   ExtName = name;
  }
+ bool SphericalParam::getMapSinglePrecision(){
+  return m_mapSinglePrecision;
+ }
+ void SphericalParam::setMapSinglePrecision(bool singlePrecision) {
+  m_mapSinglePrecision = singlePrecision;
+ }
+ bool SphericalParam::getPartialSkyMaps(){
+  return m_partialSkyMaps;
+ }
+ void SphericalParam::setPartialSkyMaps(bool partialSky) {
+  m_partialSkyMaps = partialSky;
+ }
+ std::string SphericalParam::getRingWeightsDir(){
+  return m_ringWeightsDir;
+ }
+ void SphericalParam::setRingWeightsDir(const std::string& weightsDir) {
+  m_ringWeightsDir = weightsDir;
+ }
+ int SphericalParam::getLmax(){
+  return m_lmax;
+ }
+ int SphericalParam::getMmax(){
+  return m_mmax;
+ }
+ void SphericalParam::setBandLimit(int lmax, int mmax) {
+  m_lmax = lmax;
+  m_mmax = mmax;
+ }
+ bool SphericalParam::getHarmonicInpainting(){
+  return m_harmonicInpainting;
+ }
+ void SphericalParam::setHarmonicInpainting(bool harmonicInpainting) {
+  m_harmonicInpainting = harmonicInpainting;
+ }
+ int SphericalParam::getShtBatchSize(){
+  return m_shtBatchSize;
+ }
+ void SphericalParam::setShtBatchSize(int batchSize) {
+  m_shtBatchSize = batchSize;
+ }
+ bool SphericalParam::getRingRestrictedSHT(){
+  return m_ringRestrictedSHT;
+ }
+ void SphericalParam::setRingRestrictedSHT(bool ringRestricted) {
+  m_ringRestrictedSHT = ringRestricted;
+ }
+ int SphericalParam::getFootprintNside(){
+  return m_footprintNside;
+ }
+ std::shared_ptr<const std::vector<int> > SphericalParam::getFootprintRings(){
+  return m_footprintRings;
+ }
+ void SphericalParam::setFootprintRings(int nside, const std::vector<int>& rings) {
+  m_footprintNside = nside;
+  m_footprintRings = std::make_shared<const std::vector<int> >(rings);
+ }
 } // LE3_2D_MASS_WL_SPHERICAL namespace
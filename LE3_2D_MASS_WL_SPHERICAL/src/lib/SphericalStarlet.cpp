@@ -0,0 +1,149 @@
+/**
+ * @file src/lib/SphericalStarlet.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalStarlet.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "ElementsKernel/Exception.h"
+#include <algorithm>
+#include <cmath>
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalStarlet");
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+SphericalStarlet::SphericalStarlet(SphericalWorkspace& workspace, int nside, int nbScales):
+  m_workspace(workspace), m_nside(nside), m_nbScales(nbScales) {
+  if (m_nbScales < 1) {
+    throw Elements::Exception() << "Number of scales of the starlet decomposition must be positive: "
+                                << m_nbScales;
+  }
+  int nlmax = m_workspace.getTransform(m_nside).getLmax();
+  for (int b = 0; b < m_nbScales-1; b++) {
+    double lc = nlmax*pow(0.5, b);
+    m_filters.push_back(std::vector<double>(nlmax+1, 0.));
+    Euclid::WeakLensing::TwoDMass::Spherical::getFilter(m_filters.back().data(), lc, nlmax);
+  }
+  logger.debug() << "Starlet filter bank of " << m_filters.size() << " scales up to lmax " << nlmax;
+}
+
+int SphericalStarlet::getNbScales() const {
+  return m_nbScales;
+}
+
+const std::vector<double>& SphericalStarlet::getFilter(int scale) const {
+  if (scale < 0 || scale >= int(m_filters.size())) {
+    throw Elements::Exception() << "No filter for the scale " << scale << " of the starlet decomposition";
+  }
+  return m_filters[scale];
+}
+
+void SphericalStarlet::decompose(const Healpix_Map<double>& map,
+                                 const std::function<void(int, Healpix_Map<double>&)>& visit) {
+  int npix = map.Npix();
+  SphericalWorkspace::MapBuffer smoothBuffer = m_workspace.acquireMap(m_nside);
+  Healpix_Map<double>& smooth = *smoothBuffer;
+  for (int it = 0; it < npix; it++) {
+    smooth[it] = map[it];
+  }
+
+  if (m_nbScales > 1) {
+    const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+    int nmmax = transform.getMmax();
+    SphericalWorkspace::AlmBuffer mapBuffer = m_workspace.acquireAlm(m_nside);
+    SphericalWorkspace::AlmBuffer bandBuffer = m_workspace.acquireAlm(m_nside);
+    SphericalWorkspace::MapBuffer bandMapBuffer = m_workspace.acquireMap(m_nside);
+    Alm<xcomplex<double> >& map_lm = *mapBuffer;
+    Alm<xcomplex<double> >& band_lm = *bandBuffer;
+    Healpix_Map<double>& band = *bandMapBuffer;
+
+    // Single analysis: every scale is a filter of the same coefficients
+    transform.map2alm(map, map_lm);
+
+    for (int b = 0; b < m_nbScales-1; b++) {
+      const std::vector<double>& filter = m_filters[b];
+      for (int l = 0; l < int(filter.size()); l++) {
+        for (int m = 0; m <= std::min(l, nmmax); m++) {
+          band_lm(l, m) = filter[l] * map_lm(l, m);
+        }
+      }
+      transform.alm2map(band_lm, band);
+
+      // band = previous scale - this scale, the smooth map becoming this scale
+      for (int it = 0; it < npix; it++) {
+        double val = band[it];
+        band[it] = smooth[it] - val;
+        smooth[it] = val;
+      }
+      visit(b, band);
+    }
+  }
+  visit(m_nbScales-1, smooth);
+}
+
+std::vector<Healpix_Map<double> > SphericalStarlet::decompose(const Healpix_Map<double>& map) {
+  int npix = map.Npix();
+  std::vector<Healpix_Map<double> > bands(m_nbScales, Healpix_Map<double>(m_nside, RING, SET_NSIDE));
+  if (m_nbScales == 1) {
+    bands[0] = map;
+    return bands;
+  }
+
+  const SphericalTransform& transform = m_workspace.getTransform(m_nside);
+  int nmmax = transform.getMmax();
+  SphericalWorkspace::AlmBuffer mapBuffer = m_workspace.acquireAlm(m_nside);
+  Alm<xcomplex<double> >& map_lm = *mapBuffer;
+  transform.map2alm(map, map_lm);
+
+  // Every scale is a filter of the same coefficients: the smooth maps of all the scales
+  // are synthesised in one batch, bands[b] receiving the smooth map of the scale b
+  std::vector<SphericalWorkspace::AlmBuffer> bandBuffers;
+  std::vector<const Alm<xcomplex<double> >*> bandAlms;
+  std::vector<Healpix_Map<double>*> smoothMaps;
+  for (int b = 0; b < m_nbScales-1; b++) {
+    bandBuffers.push_back(m_workspace.acquireAlm(m_nside));
+    Alm<xcomplex<double> >& band_lm = *bandBuffers.back();
+    const std::vector<double>& filter = m_filters[b];
+    for (int l = 0; l < int(filter.size()); l++) {
+      for (int m = 0; m <= std::min(l, nmmax); m++) {
+        band_lm(l, m) = filter[l] * map_lm(l, m);
+      }
+    }
+    bandAlms.push_back(&band_lm);
+    smoothMaps.push_back(&bands[b]);
+  }
+  transform.alm2map(bandAlms, smoothMaps);
+
+  // The coarse residual is the last smooth map, each band the previous smooth map minus its own,
+  // from the coarsest band so that the previous smooth map is still there
+  bands[m_nbScales-1] = bands[m_nbScales-2];
+  for (int b = m_nbScales-2; b >= 0; b--) {
+    const Healpix_Map<double>& previous = (b == 0) ? map : bands[b-1];
+    Healpix_Map<double>& band = bands[b];
+    for (int it = 0; it < npix; it++) {
+      band[it] = previous[it] - band[it];
+    }
+  }
+  return bands;
+}
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
@@ -0,0 +1,343 @@
+/**
+ * @file src/lib/SphericalTransform.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalTransform.h"
+#include "ElementsKernel/Exception.h"
+#include "libsharp/sharp_lowlevel.h"
+#include "libsharp/sharp_geomhelpers.h"
+#include "libsharp/sharp_almhelpers.h"
+#include <map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalTransform");
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+namespace {
+ // Jacobi iterations correcting the unit weights, as used so far by all the spherical analyses
+ const int unitWeightsIterations = 3;
+ // maximum number of transforms of a single libsharp job, below its limit of simultaneous transforms
+ const int maxTransforms = 16;
+}
+
+// libsharp geometry and alm layout of the transforms
+struct SphericalTransform::Geometry {
+  sharp_geom_info* geometry = nullptr;
+  sharp_alm_info* almInfo = nullptr;
+  ~Geometry() {
+    if (almInfo != nullptr) {
+      sharp_destroy_alm_info(almInfo);
+    }
+    if (geometry != nullptr) {
+      sharp_destroy_geom_info(geometry);
+    }
+  }
+};
+
+SphericalTransform::SphericalTransform(int nside, LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params):
+  m_nside(nside), m_lmax(3*nside-1), m_mmax(3*nside-1), m_nbIterations(unitWeightsIterations),
+  m_ringWeights(false), m_ringRestricted(false) {
+  if (params.getLmax() > 0) {
+    if (params.getLmax() > m_lmax) {
+      throw Elements::Exception() << "lmax " << params.getLmax() << " above 3*nside-1 for nside " << m_nside;
+    }
+    m_lmax = params.getLmax();
+  }
+  m_mmax = (params.getMmax() > 0 && params.getMmax() < m_lmax) ? params.getMmax() : m_lmax;
+  if (params.getRingWeightsDir().empty() == false) {
+    m_weights = readRingWeights(params.getRingWeightsDir(), m_nside);
+    if (m_weights != nullptr) {
+      m_ringWeights = true;
+      m_nbIterations = 0;
+    } else {
+      logger.warn() << "No HEALPix ring weights for nside " << m_nside << " in " << params.getRingWeightsDir()
+                    << ", using unit weights with " << unitWeightsIterations << " iterations";
+    }
+  }
+  if (m_weights == nullptr) {
+    std::shared_ptr<arr<double> > weights(new arr<double>(2*m_nside));
+    weights->fill(1.);
+    m_weights = weights;
+  }
+
+  std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>();
+  sharp_make_triangular_alm_info(m_lmax, m_mmax, 1, &geometry->almInfo);
+  std::shared_ptr<const std::vector<int> > rings = params.getFootprintRings();
+  bool footprint = rings != nullptr && rings->empty() == false && params.getFootprintNside() == m_nside;
+  if (footprint == true && m_ringWeights == false) {
+    // the Jacobi iterations of the unit weights fit the map on all the pixels, the rings outside the
+    // footprint included: restricting them would change the analysis
+    logger.warn() << "Footprint rings of nside " << m_nside << " ignored without the HEALPix ring weights, "
+                  << "the spherical transforms are full sky";
+    footprint = false;
+  }
+  if (footprint == false) {
+    // weighted HEALPix geometry of all the rings, as used by Healpix_cxx
+    sharp_make_weighted_healpix_geom_info(m_nside, 1, &(*m_weights)[0], &geometry->geometry);
+    m_ringStart.assign(1, 0);
+    m_ringPixels.assign(1, 12*m_nside*m_nside);
+    m_geometry = geometry;
+    return;
+  }
+  // geometry of the footprint rings, as libsharp builds the weighted HEALPix geometry of all the rings
+  Healpix_Base base(m_nside, RING, SET_NSIDE);
+  int nbRings = static_cast<int>(rings->size());
+  std::vector<int> nph(nbRings), stride(nbRings, 1);
+  std::vector<ptrdiff_t> ofs(nbRings);
+  std::vector<double> phi0(nbRings), theta(nbRings), wgt(nbRings);
+  double pixelArea = 4.*M_PI/base.Npix();
+  for (int i = 0; i < nbRings; i++) {
+    int ring = (*rings)[i];
+    if (ring < 1 || ring >= 4*m_nside || (i > 0 && ring <= (*rings)[i-1])) {
+      throw Elements::Exception() << "Footprint rings of nside " << m_nside << " not increasing in [1, "
+                                  << 4*m_nside-1 << "]";
+    }
+    int startpix, ringpix;
+    bool shifted;
+    base.get_ring_info2(ring, startpix, ringpix, theta[i], shifted);
+    nph[i] = ringpix;
+    ofs[i] = startpix;
+    phi0[i] = shifted ? M_PI/ringpix : 0.;
+    int northRing = (ring > 2*m_nside) ? 4*m_nside-ring : ring;
+    wgt[i] = pixelArea*(*m_weights)[northRing-1];
+    m_ringStart.push_back(startpix);
+    m_ringPixels.push_back(ringpix);
+  }
+  sharp_make_geom_info(nbRings, nph.data(), ofs.data(), stride.data(), phi0.data(), theta.data(), wgt.data(),
+                       &geometry->geometry);
+  m_geometry = geometry;
+  m_ringRestricted = true;
+  logger.info() << "Spherical transforms of nside " << m_nside << " restricted to " << nbRings << " of the "
+                << 4*m_nside-1 << " rings";
+}
+
+int SphericalTransform::getNside() const {
+  return m_nside;
+}
+
+int SphericalTransform::getLmax() const {
+  return m_lmax;
+}
+
+int SphericalTransform::getMmax() const {
+  return m_mmax;
+}
+
+Alm<xcomplex<double> > SphericalTransform::createAlm() const {
+  Alm<xcomplex<double> > alm(m_lmax, m_mmax);
+  alm.SetToZero();
+  return alm;
+}
+
+int SphericalTransform::getNbIterations() const {
+  return m_nbIterations;
+}
+
+bool SphericalTransform::hasRingWeights() const {
+  return m_ringWeights;
+}
+
+const arr<double>& SphericalTransform::getWeights() const {
+  return *m_weights;
+}
+
+bool SphericalTransform::isRingRestricted() const {
+  return m_ringRestricted;
+}
+
+int SphericalTransform::getNbRings() const {
+  return m_ringRestricted ? static_cast<int>(m_ringStart.size()) : 4*m_nside-1;
+}
+
+void SphericalTransform::checkMap(const Healpix_Map<double>& map, const Alm<xcomplex<double> >& alm) const {
+  if (map.Nside() != m_nside || map.Scheme() != RING) {
+    throw Elements::Exception() << "Spherical transforms need RING maps of nside " << m_nside;
+  }
+  if (alm.Lmax() != m_lmax || alm.Mmax() != m_mmax) {
+    throw Elements::Exception() << "Spherical transforms need harmonic coefficients of lmax " << m_lmax
+                                << " and mmax " << m_mmax;
+  }
+}
+
+void SphericalTransform::clearOutsideFootprint(Healpix_Map<double>& map) const {
+  int first = 0;
+  for (size_t i = 0; i < m_ringStart.size(); i++) {
+    std::fill(&map[0] + first, &map[0] + m_ringStart[i], 0.);
+    first = m_ringStart[i] + m_ringPixels[i];
+  }
+  std::fill(&map[0] + first, &map[0] + map.Npix(), 0.);
+}
+
+void SphericalTransform::execute(bool analysis, int spin, std::vector<void*>& alms, std::vector<void*>& maps,
+                                 bool add) const {
+  // the geometry is only read by libsharp, it is shared by the threads
+  int nbComponents = (spin == 0) ? 1 : 2;
+  int nbTransforms = static_cast<int>(alms.size())/nbComponents;
+  for (int first = 0; first < nbTransforms; first += maxTransforms) {
+    int count = std::min(maxTransforms, nbTransforms - first);
+    sharp_execute(analysis ? SHARP_MAP2ALM : SHARP_ALM2MAP, spin, &alms[first*nbComponents],
+                  &maps[first*nbComponents], m_geometry->geometry, m_geometry->almInfo, count,
+                  SHARP_DP | (add ? SHARP_ADD : 0), nullptr, nullptr);
+  }
+}
+
+void SphericalTransform::analyse(int spin, const std::vector<const Healpix_Map<double>*>& maps,
+                                 const std::vector<Alm<xcomplex<double> >*>& alms) const {
+  std::vector<void*> almPointers, mapPointers;
+  for (size_t i = 0; i < maps.size(); i++) {
+    checkMap(*maps[i], *alms[i]);
+    mapPointers.push_back(const_cast<double*>(&(*maps[i])[0]));
+    almPointers.push_back(&(*alms[i])(0, 0));
+  }
+  execute(true, spin, almPointers, mapPointers, false);
+  if (m_nbIterations == 0) {
+    return;
+  }
+  // Jacobi iterations, as map2alm_iter: the residual of the synthesis is analysed again
+  std::vector<Healpix_Map<double> > residuals(maps.size(), Healpix_Map<double>(m_nside, RING, SET_NSIDE));
+  std::vector<void*> residualPointers;
+  for (Healpix_Map<double>& residual : residuals) {
+    residualPointers.push_back(&residual[0]);
+  }
+  for (int iter = 0; iter < m_nbIterations; iter++) {
+    execute(false, spin, almPointers, residualPointers, false);
+    for (size_t k = 0; k < maps.size(); k++) {
+      for (size_t i = 0; i < m_ringStart.size(); i++) {
+        for (int p = m_ringStart[i]; p < m_ringStart[i] + m_ringPixels[i]; p++) {
+          residuals[k][p] = (*maps[k])[p] - residuals[k][p];
+        }
+      }
+    }
+    execute(true, spin, almPointers, residualPointers, true);
+  }
+}
+
+void SphericalTransform::synthesise(int spin, const std::vector<const Alm<xcomplex<double> >*>& alms,
+                                    const std::vector<Healpix_Map<double>*>& maps) const {
+  std::vector<void*> almPointers, mapPointers;
+  for (size_t i = 0; i < maps.size(); i++) {
+    checkMap(*maps[i], *alms[i]);
+    mapPointers.push_back(&(*maps[i])[0]);
+    almPointers.push_back(const_cast<xcomplex<double>*>(&(*alms[i])(0, 0)));
+  }
+  execute(false, spin, almPointers, mapPointers, false);
+  for (Healpix_Map<double>* map : maps) {
+    clearOutsideFootprint(*map);
+  }
+}
+
+void SphericalTransform::map2alm(const Healpix_Map<double>& map, Alm<xcomplex<double> >& alm) const {
+  if (m_ringRestricted) {
+    analyse(0, {&map}, {&alm});
+  } else if (m_nbIterations > 0) {
+    map2alm_iter(map, alm, m_nbIterations, *m_weights);
+  } else {
+    ::map2alm(map, alm, *m_weights, false);
+  }
+}
+
+void SphericalTransform::map2alm_spin(const Healpix_Map<double>& map1, const Healpix_Map<double>& map2,
+                                      Alm<xcomplex<double> >& alm1, Alm<xcomplex<double> >& alm2, int spin) const {
+  if (m_ringRestricted) {
+    analyse(spin, {&map1, &map2}, {&alm1, &alm2});
+  } else if (m_nbIterations > 0) {
+    map2alm_spin_iter(map1, map2, alm1, alm2, spin, m_nbIterations, *m_weights);
+  } else {
+    ::map2alm_spin(map1, map2, alm1, alm2, spin, *m_weights, false);
+  }
+}
+
+void SphericalTransform::alm2map(const Alm<xcomplex<double> >& alm, Healpix_Map<double>& map) const {
+  if (m_ringRestricted) {
+    synthesise(0, {&alm}, {&map});
+  } else {
+    ::alm2map(alm, map);
+  }
+}
+
+void SphericalTransform::alm2map_spin(const Alm<xcomplex<double> >& alm1, const Alm<xcomplex<double> >& alm2,
+                                      Healpix_Map<double>& map1, Healpix_Map<double>& map2, int spin) const {
+  if (m_ringRestricted) {
+    synthesise(spin, {&alm1, &alm2}, {&map1, &map2});
+  } else {
+    ::alm2map_spin(alm1, alm2, map1, map2, spin);
+  }
+}
+
+void SphericalTransform::map2alm_spin(const std::vector<const Healpix_Map<double>*>& maps1,
+                                      const std::vector<const Healpix_Map<double>*>& maps2,
+                                      const std::vector<Alm<xcomplex<double> >*>& alms1,
+                                      const std::vector<Alm<xcomplex<double> >*>& alms2, int spin) const {
+  if (maps2.size() != maps1.size() || alms1.size() != maps1.size() || alms2.size() != maps1.size()) {
+    throw Elements::Exception() << "Batched spin transform of " << maps1.size() << " maps with "
+                                << maps2.size() << " second components and " << alms1.size() << " coefficients";
+  }
+  // the two components of each transform are consecutive in the libsharp job
+  std::vector<const Healpix_Map<double>*> maps;
+  std::vector<Alm<xcomplex<double> >*> alms;
+  for (size_t i = 0; i < maps1.size(); i++) {
+    maps.push_back(maps1[i]);
+    maps.push_back(maps2[i]);
+    alms.push_back(alms1[i]);
+    alms.push_back(alms2[i]);
+  }
+  analyse(spin, maps, alms);
+}
+
+void SphericalTransform::alm2map(const std::vector<const Alm<xcomplex<double> >*>& alms,
+                                 const std::vector<Healpix_Map<double>*>& maps) const {
+  if (alms.size() != maps.size()) {
+    throw Elements::Exception() << "Batched synthesis of " << alms.size() << " coefficients in "
+                                << maps.size() << " maps";
+  }
+  synthesise(0, alms, maps);
+}
+
+std::shared_ptr<const arr<double> > SphericalTransform::readRingWeights(const std::string& weightsDir, int nside) {
+  static std::mutex cacheMutex;
+  static std::map<std::pair<std::string, int>, std::shared_ptr<const arr<double> > > cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  std::pair<std::string, int> key(weightsDir, nside);
+  auto found = cache.find(key);
+  if (found != cache.end()) {
+    return found->second;
+  }
+  char filename[32];
+  snprintf(filename, sizeof(filename), "weight_ring_n%05d.fits", nside);
+  std::shared_ptr<arr<double> > weights;
+  if (boost::filesystem::is_regular_file(boost::filesystem::path(weightsDir) / filename)) {
+    weights.reset(new arr<double>);
+    // read_weight_ring returns the weights (the file stores the weights minus one)
+    read_weight_ring(weightsDir, nside, *weights);
+    logger.info() << "Read HEALPix ring weights " << filename;
+  }
+  cache[key] = weights;
+  return weights;
+}
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
@@ -22,6 +22,8 @@
  */
 
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalStarlet.h"
+#include <algorithm>
 
 static Elements::Logging logger = Elements::Logging::getLogger("SphericalUtils");
 
@@ -46,16 +48,29 @@ void readSphericalParameterFile (const boost::filesystem::path& ParamFile,
 }
 
 void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
+  LE3_2D_MASS_WL_SPHERICAL::SphericalParam params;
+  LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace workspace(params);
+  applyGaussianFilter_hp(map, sigma, workspace);
+}
+
+void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma,
+                            LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace) {
   int nside = map.Nside();
-  arr<double> weight;
-  weight.alloc(3*nside-1);
-  weight.fill(1.);
+  const LE3_2D_MASS_WL_SPHERICAL::SphericalTransform& transform = workspace.getTransform(nside);
+
+  LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace::AlmBuffer almBuffer = workspace.acquireAlm(nside);
+  Alm<xcomplex<double> >& map_lm = *almBuffer;
+
+  transform.map2alm(map, map_lm);
 
-  int nlmax = 3*nside-1;
+  applyGaussianFilter_alm(map_lm, sigma);
 
-  Alm<xcomplex<double> > map_lm(nlmax, nlmax);
-  map_lm.SetToZero();
+  map.fill(0.);
+
+  transform.alm2map(map_lm, map);
+}
 
+void applyGaussianFilter_alm(Alm<xcomplex<double> >& alm, double sigma) {
  // TODO Change sigma from pixel to radian
   double sigma2fwhm = sigma * SIGMA2FWHM;
  // double fwhm2sigma= fwhm / SIGMA2FWHM;
@@ -63,13 +78,7 @@ void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
   logger.info()<<"sigma2fwhm: " << sigma2fwhm;
   //logger.info()<<"fwhm2sigma: " << fwhm2sigma;
 
-  map2alm_iter (map, map_lm, 3, weight);
-
-  smoothWithGauss( map_lm, sigma2fwhm); //fwhm needs to be in radian
-
-  map.fill(0.);
-
-  alm2map(map_lm, map);
+  smoothWithGauss( alm, sigma2fwhm); //fwhm needs to be in radian
 }
 
  double b3_spline (double val) {
@@ -84,7 +93,7 @@ void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
 
  void applyThreshold (Alm<xcomplex<double> >& alphaT, double threshVal, int m_nlmax) {
    for (int l =0; l<=m_nlmax; ++l) {
-    for (int m = 0; m<=l; ++m){
+    for (int m = 0; m<=std::min(l, alphaT.Mmax()); ++m){
       if (fabs(alphaT(l, m)) < threshVal) {
          alphaT(l, m) = 0.;
         // alphaT(l, m).real(0.);
@@ -97,7 +106,7 @@ void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
  double max_abs_alm(Alm<xcomplex<double> >& alm, int m_nlmax) {
     double max=0.;
     for (int l=0; l <= m_nlmax; ++l) {	
-      for (int m=0; m <= l; ++m) {
+      for (int m=0; m <= std::min(l, alm.Mmax()); ++m) {
          if (fabs (real(alm (l,m))) > max) {
             max = fabs (real(alm (l,m)));
          }
@@ -132,56 +141,47 @@ void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
  }
 
  std::vector<Healpix_Map<double> > transformBspline_hp(Healpix_Map<double>& map, int m_nbScales) {
-   int m_npix = map.Npix();
-   std::vector<Healpix_Map<double> > band;
-   band.push_back(map);
-   for (int b=0; b<m_nbScales-1; b++) {
-     Healpix_Map<double> map_out = smoothBspline_hp(map, b);
-     band.push_back(map_out);
-     for (int it = 0; it<m_npix; it++) {
-       band[b][it] = band[b][it] - band[b+1][it];
-       //if (isnan(band[b][it])) {
-        // band[b][it]=band[b][it];
-       //}
-     }
-   }
-   return band;
+   LE3_2D_MASS_WL_SPHERICAL::SphericalParam params;
+   LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace workspace(params);
+   return transformBspline_hp(map, m_nbScales, workspace);
+ }
+
+ std::vector<Healpix_Map<double> > transformBspline_hp(Healpix_Map<double>& map, int m_nbScales,
+                                                       LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace) {
+   LE3_2D_MASS_WL_SPHERICAL::SphericalStarlet starlet(workspace, map.Nside(), std::max(m_nbScales, 1));
+   return starlet.decompose(map);
  }
 
  Healpix_Map<double> smoothBspline_hp(Healpix_Map<double>& map, int scale) {
+   LE3_2D_MASS_WL_SPHERICAL::SphericalParam params;
+   LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace workspace(params);
+   return smoothBspline_hp(map, scale, workspace);
+ }
+
+ Healpix_Map<double> smoothBspline_hp(Healpix_Map<double>& map, int scale,
+                                      LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace& workspace) {
    int m_nside = map.Nside();
-   int m_nlmax = 3*m_nside-1;
-   Alm<xcomplex<double> > map_lm(m_nlmax, m_nlmax);
-   map_lm.SetToZero();
-   arr<double> weight;
-   weight.alloc(2*m_nside);
-   weight.fill(1.);
-
-   map2alm_iter (map, map_lm, 3, weight);
-   double lc = m_nlmax*pow(0.5, scale);
-   //int nalm = int(m_nlmax*(m_nlmax+1)/2+(m_nlmax+1));
+   const LE3_2D_MASS_WL_SPHERICAL::SphericalTransform& transform = workspace.getTransform(m_nside);
+   int m_nlmax = transform.getLmax();
+   int m_nmmax = transform.getMmax();
+   LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace::AlmBuffer almBuffer = workspace.acquireAlm(m_nside);
+   Alm<xcomplex<double> >& map_lm = *almBuffer;
 
-   double* Filter = new double[m_nlmax+1];
-   std::fill_n(Filter, m_nlmax+1, 0);
-   //double* Filter = new double[nalm];
-   //std::fill_n(Filter, nalm, 0);
-   getFilter(Filter, lc, m_nlmax);
+   transform.map2alm(map, map_lm);
+   double lc = m_nlmax*pow(0.5, scale);
 
-   Alm<xcomplex<double> > smoothmap_lm(m_nlmax, m_nlmax);
+   std::vector<double> Filter(m_nlmax+1, 0.);
+   getFilter(Filter.data(), lc, m_nlmax);
 
-   smoothmap_lm.SetToZero();
+   // The filter is applied in place on the coefficients of the map
    for (int l=0; l<=m_nlmax; l++) {
-     for (int m=0; m<=l; m++) {
-       //smoothmap_lm(l,m) = Filter[getidx_lm(m_nlmax, l, m)] * map_lm(l,m);
-       smoothmap_lm(l,m) = Filter[l] * map_lm(l,m);
+     for (int m=0; m<=std::min(l, m_nmmax); m++) {
+       map_lm(l,m) = Filter[l] * map_lm(l,m);
      }
    }
    Healpix_Map<double> smooth_map;
    smooth_map.SetNside(m_nside, RING);
-   smooth_map.fill(0.);
-   alm2map(smoothmap_lm, smooth_map);
-   delete[] Filter;
-   weight.dealloc();
+   transform.alm2map(map_lm, smooth_map);
    return smooth_map;
  }
 
@@ -200,6 +200,23 @@ void applyGaussianFilter_hp(Healpix_Map<double>& map, double sigma) {
    return map_out;
  }
 
+ std::vector<int> getFootprintRings(const Healpix_Map<double>& map) {
+   int nside = map.Nside();
+   std::vector<char> observed(4*nside, 0);
+   for (int it = 0; it<map.Npix(); it++) {
+     if (map[it] != 0.) {
+       observed[map.pix2ring(it)] = 1;
+     }
+   }
+   std::vector<int> rings;
+   for (int ring = 1; ring<4*nside; ring++) {
+     if (observed[ring]) {
+       rings.push_back(ring);
+     }
+   }
+   return rings;
+ }
+
    } /* namespace Spherical */
   } /* namespace TwoDMass */
  } /* namespace WeakLensing */
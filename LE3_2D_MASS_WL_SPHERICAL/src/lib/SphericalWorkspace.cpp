@@ -0,0 +1,92 @@
+/**
+ * @file src/lib/SphericalWorkspace.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
+#include <utility>
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalWorkspace");
+
+namespace LE3_2D_MASS_WL_SPHERICAL {
+
+SphericalWorkspace::SphericalWorkspace(const LE3_2D_MASS_WL_SPHERICAL::SphericalParam& params):
+  m_SphParam(params) {
+}
+
+SphericalWorkspace::NsideBuffers& SphericalWorkspace::getBuffers(int nside) {
+  NsideBuffers& buffers = m_buffers[nside];
+  if (buffers.transform == nullptr) {
+    buffers.transform.reset(new SphericalTransform(nside, m_SphParam));
+  }
+  return buffers;
+}
+
+const SphericalTransform& SphericalWorkspace::getTransform(int nside) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return *getBuffers(nside).transform;
+}
+
+SphericalWorkspace::AlmBuffer SphericalWorkspace::acquireAlm(int nside) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  NsideBuffers& buffers = getBuffers(nside);
+  Alm<xcomplex<double> >* alm;
+  if (buffers.alms.empty() == false) {
+    alm = buffers.alms.back().release();
+    buffers.alms.pop_back();
+  } else {
+    alm = new Alm<xcomplex<double> >(buffers.transform->getLmax(), buffers.transform->getMmax());
+  }
+  return AlmBuffer(alm, [this, nside] (Alm<xcomplex<double> >* released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers[nside].alms.emplace_back(released);
+  });
+}
+
+SphericalWorkspace::MapBuffer SphericalWorkspace::acquireMap(int nside) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  NsideBuffers& buffers = getBuffers(nside);
+  Healpix_Map<double>* map;
+  if (buffers.maps.empty() == false) {
+    map = buffers.maps.back().release();
+    buffers.maps.pop_back();
+  } else {
+    map = new Healpix_Map<double>(nside, RING, SET_NSIDE);
+  }
+  return MapBuffer(map, [this, nside] (Healpix_Map<double>* released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers[nside].maps.emplace_back(released);
+  });
+}
+
+LE3_2D_MASS_WL_SPHERICAL::SphericalParam& SphericalWorkspace::getParams() {
+  return m_SphParam;
+}
+
+void SphericalWorkspace::release() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& buffers : m_buffers) {
+    buffers.second.alms.clear();
+    buffers.second.maps.clear();
+  }
+}
+
+}  // namespace LE3_2D_MASS_WL_SPHERICAL
@@ -25,6 +25,9 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <memory>
+#include <algorithm>
+#include <mutex>
 
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -33,6 +36,7 @@
 
 #include "LE3_2D_MASS_WL_UTILITIES/DmInput.h"
 #include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
+#include "LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/GetSphericalMCMaps.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_mass_mapping.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
@@ -60,6 +64,7 @@ using LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
 using Euclid::WeakLensing::TwoDMass::Spherical::SphericalIO;
 using LE3_2D_MASS_WL_SPHERICAL::GetSphericalMCMaps;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace;
 
 static Elements::Logging logger = Elements::Logging::getLogger("LE3_2D_MASS_WL_SphericalMCMaps");
 
@@ -90,6 +95,33 @@ public:
    options.add_options()
    ("MCConvergenceMaps", po::value<string>()->default_value(""), "MC convergence Maps Name in txt/jason file");
 
+   // output maps format: default is full sky in double precision
+   options.add_options()
+   ("mapSinglePrecision", po::value<int>()->default_value(0),
+    "output maps values in float32 (0-> False and 1-> True)");
+   options.add_options()
+   ("partialSkyMaps", po::value<int>()->default_value(0),
+    "output maps restricted to the observed pixels with HEALPix explicit indexing (0-> False and 1-> True)");
+   // harmonic analysis: HEALPix ring weights (single transform) instead of unit weights and 3 iterations
+   options.add_options()
+   ("ringWeightsDir", po::value<string>()->default_value(""),
+    "directory of the HEALPix ring weights files weight_ring_n<nside>.fits (relative to workdir)");
+   // band limit of the spherical harmonic transforms: default is 3*nside-1
+   options.add_options()
+   ("lmax", po::value<int>()->default_value(0), "maximum multipole of the harmonic transforms (0-> 3*nside-1)");
+   options.add_options()
+   ("mmax", po::value<int>()->default_value(0), "maximum order of the harmonic transforms (0-> lmax)");
+   // batched mass mapping of the realisations
+   options.add_options()
+   ("shtBatchSize", po::value<int>()->default_value(0),
+    "number of realisations transformed by a single libsharp job (0-> 4), each realisation of a batch "
+    "holding up to 6 full sky maps (shear, convergence and convergence of the previous batch being written)");
+   // harmonic transforms restricted to the rings of the survey footprint
+   options.add_options()
+   ("ringRestrictedSHT", po::value<int>()->default_value(0),
+    "harmonic transforms on the rings with galaxies only, with the HEALPix ring weights "
+    "(0-> False and 1-> True)");
+
     return options;
   }
 
@@ -133,6 +165,14 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    SphericalParam SphParam;
    readSphericalParameterFile((workdir/inSphParamFile), SphParam);
+   SphParam.setMapSinglePrecision(args["mapSinglePrecision"].as<int>() != 0);
+   SphParam.setPartialSkyMaps(args["partialSkyMaps"].as<int>() != 0);
+   if (args["ringWeightsDir"].as<string>().empty() == false) {
+     SphParam.setRingWeightsDir((workdir / args["ringWeightsDir"].as<string>()).native());
+   }
+   SphParam.setBandLimit(args["lmax"].as<int>(), args["mmax"].as<int>());
+   SphParam.setShtBatchSize(args["shtBatchSize"].as<int>());
+   SphParam.setRingRestrictedSHT(args["ringRestrictedSHT"].as<int>() != 0);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Object to Write Spherical Map
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -140,7 +180,7 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Object to perform Spherical Mass Mapping
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-    Sph_mass_mapping mapping;
+    Sph_mass_mapping mapping(SphParam);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Variable to save input catalog name
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -172,6 +212,11 @@ public:
   GetSphericalMCMaps MCMaps(inData, SphParam);
   std::pair<Healpix_Map<double>, Healpix_Map<double> > DeNoisedShearPair;
   DeNoisedShearPair = MCMaps.getDeNoisedShearMap();
+  if (SphParam.getRingRestrictedSHT()) {
+    // footprint rings of the galaxy count map, for the transforms of the realisations
+    SphParam = MCMaps.getSphericalParam();
+    mapping = Sph_mass_mapping(SphParam);
+  }
 
    /*fs::path gamma = "EUC_LE3_WL_DeNoisedGamma_" + getDateTimeString() + ".fits";
    SphericalIO.write_Map((workdir/gamma).native(), DeNoisedShearPair.first, "GAMMA1");
@@ -200,24 +245,53 @@ public:
  // perform mass mapping on N shear Maps
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   logger.info("Running Spherical KS Mass Mapping");
-  for (int i = 0; i<MCShearMaps.size(); i++) {
-    fs::path Kappa =  datadir / fs::path("EUC_LE3_WL_MC_Kappa_0" + std::to_string(i)+ "_" +
-                                  getDateTimeString() + ".fits");
-    Healpix_Map<double> mapShearE;
-    read_Healpix_map_from_fits(MCShearMaps[i].native(), mapShearE);
-
-    std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair =
-                      mapping.create_SheartoConvMap(mapShearE, DeNoisedShearPair.second);
-
-   SphericalIO.write_Map(Kappa.native(), kappaPair.first, "KappaE");
-   SphericalIO.write_Map(Kappa.native(), kappaPair.second, "KappaB");
+  // The realisations are mass mapped by batches, the maps of a batch sharing the transforms,
+  // and the convergence maps are written in the background while the next batch is computed:
+  // the memory is about 6 full sky maps per realisation of the batch
+  int batchSize = SphParam.getShtBatchSize();
+  if (batchSize <= 0) {
+    batchSize = Sph_mass_mapping::defaultBatchSize;
+  }
+  SphericalWorkspace workspace(SphParam);
+  // CFITSIO is not reentrant: the reads of the main thread and the writes of the writer thread,
+  // which has its own SphericalIO, are serialised
+  std::mutex fitsMutex;
+  std::shared_ptr<Euclid::WeakLensing::TwoDMass::Spherical::SphericalIO> writerIO(
+                               new Euclid::WeakLensing::TwoDMass::Spherical::SphericalIO(SphParam));
+  AsyncWriter writer;
+  for (int first = 0; first < MCShearMaps.size(); first += batchSize) {
+    int last = std::min(first + batchSize, int(MCShearMaps.size()));
+    std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > shearPairs;
+    for (int i = first; i < last; i++) {
+      std::vector<std::string> colnames;
+      std::unique_lock<std::mutex> fitsLock(fitsMutex);
+      Healpix_Map<double> mapShearE = SphericalIO.read_Maps(MCShearMaps[i].native(), colnames)[0];
+      fitsLock.unlock();
+      shearPairs.push_back(std::make_pair(mapShearE, DeNoisedShearPair.second));
+    }
 
-   MCConvergenceMaps.push_back(Kappa);
+    std::shared_ptr<std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > > kappaPairs(
+       new std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > >(
+                      mapping.create_SheartoConvMaps(shearPairs, workspace, batchSize)));
+
+    for (int i = first; i < last; i++) {
+      fs::path Kappa =  datadir / fs::path("EUC_LE3_WL_MC_Kappa_0" + std::to_string(i)+ "_" +
+                                    getDateTimeString() + ".fits");
+      std::string kappaFile = Kappa.native();
+      size_t index = i - first;
+      writer.submit([&fitsMutex, writerIO, kappaPairs, index, kappaFile] {
+        std::lock_guard<std::mutex> fitsLock(fitsMutex);
+        writerIO->write_Maps(kappaFile, {&(*kappaPairs)[index].first, &(*kappaPairs)[index].second},
+                             {"KappaE", "KappaB"});
+      });
+      MCConvergenceMaps.push_back(Kappa);
+    }
   }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Generate the jason/txt product
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+  writer.wait();
   fs::path outFilenames = args["MCConvergenceMaps"].as<string>();
   std::ofstream outSphConvfile ((workdir /outFilenames).string());
   outSphConvfile << "[";
@@ -99,6 +99,19 @@ public:
    ("GalCountMap", po::value<string>()->default_value(""),
     "output Galaxy count Map which conatins number of Galaxies per pixel for each redshift bin in json format");
 
+   // catalog read by chunks of rows: default is the whole catalog at once
+   options.add_options()
+   ("chunkRows", po::value<long>()->default_value(0),
+    "number of catalog rows binned at a time, 0 to read the whole catalog in memory");
+
+   // output maps format: default is full sky in double precision
+   options.add_options()
+   ("mapSinglePrecision", po::value<int>()->default_value(0),
+    "output maps values in float32 (0-> False and 1-> True)");
+   options.add_options()
+   ("partialSkyMaps", po::value<int>()->default_value(0),
+    "output maps restricted to the observed pixels with HEALPix explicit indexing (0-> False and 1-> True)");
+
     return options;
   }
 
@@ -126,12 +139,6 @@ public:
    fs::path gamma {args["outShearMap"].as<string>()};
    fs::path GalCountFilename {};
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////
- // Reading input catalog
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-   std::vector<std::vector<double> > Data;
-   ReadCatalog read;
-   read.readShearCatalog(workdir, InputCatalog, Data);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   // check parameter file exists
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -144,17 +151,35 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    SphericalParam SphParam;
    readSphericalParameterFile((workdir/fileParam), SphParam);
+   SphParam.setMapSinglePrecision(args["mapSinglePrecision"].as<int>() != 0);
+   SphParam.setPartialSkyMaps(args["partialSkyMaps"].as<int>() != 0);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Object to Write Spherical Map
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    SphericalIO SphericalIO(SphParam);
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
- // Creating healpix Shear Map from input catalog
+ // Reading input catalog and creating healpix Shear Map from it
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+   std::vector<std::vector<double> > Data;
+   ReadCatalog read;
+   read.setColumns(Sph_map_maker::getCatalogColumns());
    logger.info("# Running Map Maker: Creating Healpix Gamma Maps");
    Sph_map_maker mapMaker(SphParam);
-   //std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair = mapMaker.create_ShearMap(Data);
-   auto [ Shear1, Shear2, GalCount ] = mapMaker.create_ShearMap(Data);
+   std::tuple<Healpix_Map<double>, Healpix_Map<double>, Healpix_Map<double> > shearMaps;
+   long chunkRows = args["chunkRows"].as<long>();
+   if (chunkRows > 0) {
+     // Constant memory: the catalog is binned chunk by chunk while it is read
+     mapMaker.startBinning();
+     read.readShearCatalogChunks(workdir, InputCatalog, chunkRows,
+                                 [&mapMaker](std::vector<std::vector<double> >& chunk, long) {
+       mapMaker.addCatalogChunk(chunk);
+     });
+     shearMaps = mapMaker.getBinnedShearMap();
+   } else {
+     read.readShearCatalog(workdir, InputCatalog, Data);
+     shearMaps = mapMaker.create_ShearMap(Data);
+   }
+   auto& [ Shear1, Shear2, GalCount ] = shearMaps;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // set FITS filenames
@@ -178,9 +203,8 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    logger.info("# Writing healpix Gamma Maps");
 
-   SphericalIO.write_Map((workdir/gamma).native(), Shear1, "GAMMA1");
-   SphericalIO.write_Map((workdir/gamma).native(), Shear2, "GAMMA2");
-   SphericalIO.write_Map((datadir/GalCountFilename).native(), GalCount, "GALCOUNT");
+   SphericalIO.write_Maps((workdir/gamma).native(), {&Shear1, &Shear2}, {"GAMMA1", "GAMMA2"});
+   SphericalIO.write_Maps((datadir/GalCountFilename).native(), {&GalCount}, {"GALCOUNT"});
 
     std::ofstream outfile;
     outfile.open ((workdir / GalCountMap).string(), std::ios_base::app);
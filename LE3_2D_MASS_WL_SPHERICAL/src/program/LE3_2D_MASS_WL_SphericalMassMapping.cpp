@@ -55,6 +55,7 @@ using std::vector;
 using LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalInpainting;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace;
 using Euclid::WeakLensing::TwoDMass::Spherical::SphericalIO;
 
 // Input namespace and classes
@@ -77,21 +78,31 @@ static Elements::Logging logger = Elements::Logging::getLogger("LE3_2D_MASS_WL_S
  *  @param    mapPair, Gamma1 and Gamma2 in healpix format
  *  @param    kappaPair, kappaE and kappaB in healpix format (output)
  *  @param    SphericalParam, object that points to parameters
+ *  @param    sigma, sigma of the gaussian kernel applied on the shear, 0 for no smoothing
  *  @return   None
 */
 
 void getSphericalConvergenceMap (std::pair<Healpix_Map<double>, Healpix_Map<double> >& mapPair,
-    std::pair<Healpix_Map<double>, Healpix_Map<double> >& kappaPair, SphericalParam &SphericalParam) {
+    std::pair<Healpix_Map<double>, Healpix_Map<double> >& kappaPair, SphericalParam &SphericalParam,
+    double sigma = 0.) {
 
-  Sph_mass_mapping mapping;
+  Sph_mass_mapping mapping(SphericalParam);
+  SphericalWorkspace workspace(SphericalParam);
+  bool inpainting = SphericalParam.getNInpaint() > 0;
 
-  kappaPair = mapping.create_SheartoConvMap(mapPair.first, mapPair.second);
+ // Smoothing and mass mapping in a single harmonic pass, the smoothed shear
+ // being synthesised only when the inpainting needs it
+  std::pair<Healpix_Map<double>, Healpix_Map<double> > smoothedPair;
+  bool smoothedShear = inpainting && sigma != 0.;
+  mapping.create_SmoothedSheartoConvMap(mapPair.first, mapPair.second, sigma, kappaPair.first, kappaPair.second,
+                                        workspace, smoothedShear ? &smoothedPair.first : nullptr,
+                                        smoothedShear ? &smoothedPair.second : nullptr);
 
  // Perform Inpainting
 
-  if (SphericalParam.getNInpaint() > 0) {
+  if (inpainting) {
 
-   SphericalInpainting Inpainting ( mapPair, kappaPair, SphericalParam);
+   SphericalInpainting Inpainting ( smoothedShear ? smoothedPair : mapPair, kappaPair, SphericalParam);
    kappaPair = Inpainting.performInpainting();
 
   }
@@ -140,6 +151,31 @@ public:
    // output XML for convergance Map E and B mode
    options.add_options()
    ("outputKappaXML", po::value<string>()->default_value(""), "Output XML product for Spherical convergence map");
+   // output maps format: default is full sky in double precision
+   options.add_options()
+   ("mapSinglePrecision", po::value<int>()->default_value(0),
+    "output maps values in float32 (0-> False and 1-> True)");
+   options.add_options()
+   ("partialSkyMaps", po::value<int>()->default_value(0),
+    "output maps restricted to the observed pixels with HEALPix explicit indexing (0-> False and 1-> True)");
+   // harmonic analysis: HEALPix ring weights (single transform) instead of unit weights and 3 iterations
+   options.add_options()
+   ("ringWeightsDir", po::value<string>()->default_value(""),
+    "directory of the HEALPix ring weights files weight_ring_n<nside>.fits (relative to workdir)");
+   // band limit of the spherical harmonic transforms: default is 3*nside-1
+   options.add_options()
+   ("lmax", po::value<int>()->default_value(0), "maximum multipole of the harmonic transforms (0-> 3*nside-1)");
+   options.add_options()
+   ("mmax", po::value<int>()->default_value(0), "maximum order of the harmonic transforms (0-> lmax)");
+   // inpainting solver: the estimate is kept in harmonic space between the iterations
+   options.add_options()
+   ("harmonicInpainting", po::value<int>()->default_value(0),
+    "inpainting with one spin-2 synthesis and analysis per iteration (0-> False and 1-> True)");
+   // harmonic transforms restricted to the rings of the survey footprint
+   options.add_options()
+   ("ringRestrictedSHT", po::value<int>()->default_value(0),
+    "harmonic transforms on the rings with observed pixels only, with the HEALPix ring weights "
+    "(0-> False and 1-> True)");
     return options;
   }
 
@@ -186,21 +222,41 @@ public:
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    SphericalParam SphParam;
    readSphericalParameterFile((workdir/ParamFile), SphParam);
+   SphParam.setMapSinglePrecision(args["mapSinglePrecision"].as<int>() != 0);
+   SphParam.setPartialSkyMaps(args["partialSkyMaps"].as<int>() != 0);
+   if (args["ringWeightsDir"].as<string>().empty() == false) {
+     SphParam.setRingWeightsDir((workdir / args["ringWeightsDir"].as<string>()).native());
+   }
+   SphParam.setBandLimit(args["lmax"].as<int>(), args["mmax"].as<int>());
+   SphParam.setHarmonicInpainting(args["harmonicInpainting"].as<int>() != 0);
+   SphParam.setRingRestrictedSHT(args["ringRestrictedSHT"].as<int>() != 0);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Object to Read/Write Spherical Map
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
    SphericalIO SphericalIO(SphParam);
    std::pair<Healpix_Map<double>, Healpix_Map<double> > mapPair;
-   if((false == inputKappa.string().empty())) {
-      mapPair= readHealpixMap((workdir/inputKappa).native());
-   } else {
-      mapPair= readHealpixMap((workdir/inputGamma).native());
+   // full or partial sky input maps, in float32 or float64
+   std::vector<std::string> inColnames;
+   std::vector<Healpix_Map<double> > inMaps = SphericalIO.read_Maps((workdir/(inputKappa.string().empty() ?
+                                                                     inputGamma : inputKappa)).native(), inColnames);
+   if (inMaps.size() < 2) {
+     logger.info()<< "Input map should contain the E and B modes ....";
+     return Elements::ExitCode::NOINPUT;
    }
+   mapPair = std::make_pair(inMaps[0], inMaps[1]);
 
    Healpix_Map<double> mapE = mapPair.first;
    Healpix_Map<double> mapB = mapPair.second;
 
+   if (SphParam.getRingRestrictedSHT()) {
+     // the pixels with galaxies are the non-zero pixels of the binned input map
+     std::vector<int> footprintRings = getFootprintRings(mapE);
+     SphParam.setFootprintRings(mapE.Nside(), footprintRings);
+     logger.info() << "Harmonic transforms on " << footprintRings.size() << " of the " << 4*mapE.Nside()-1
+                   << " rings";
+   }
+
     std::ofstream outfile;
     outfile.open ((workdir / outputKappa).string(), std::ios_base::app);
     outfile << "[";
@@ -213,7 +269,7 @@ if((false == inputKappa.string().empty())) {
   logger.info("# Running Spherical inverse KS Mass Mapping");
   logger.info("#");
 
-   Sph_mass_mapping mapping;
+   Sph_mass_mapping mapping(SphParam);
    std::pair<Healpix_Map<double>, Healpix_Map<double> > k2shearPair =
                         mapping.create_ConvtoShearMap(mapE, mapB);
 
@@ -229,8 +285,8 @@ if((false == inputKappa.string().empty())) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
   logger.info("# Writing Spherical Gamma Map got from Convergence Map");
 
-   SphericalIO.write_Map((datadir/outputGamma).native(), k2shearPair.first, "GAMMA1");
-   SphericalIO.write_Map((datadir/outputGamma).native(), k2shearPair.second, "GAMMA2");
+   SphericalIO.write_Maps((datadir/outputGamma).native(), {&k2shearPair.first, &k2shearPair.second},
+                          {"GAMMA1", "GAMMA2"});
 } else {
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Creating Convergence Map from Shear Map (Perform mass mapping KS)
@@ -251,26 +307,24 @@ if((false == inputKappa.string().empty())) {
 
  // Writing output Fits files
   logger.info("# Writing Spherical Noisy Convergence Map");
-  SphericalIO.write_Map((datadir/outputKappaFits).native(), kappaPair.first, "KAPPA_E");
-  SphericalIO.write_Map((datadir/outputKappaFits).native(), kappaPair.second, "KAPPA_B");
+  SphericalIO.write_Maps((datadir/outputKappaFits).native(), {&kappaPair.first, &kappaPair.second},
+                         {"KAPPA_E", "KAPPA_B"});
   outfile << outputKappaFits.filename();
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
  // Get De-Noisy Kappa Maps
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
    if (fabs(SphParam.getSigmaGauss())>0.001){//Apply gaussian filter on the map
-     applyGaussianFilter_hp(mapE, SphParam.getSigmaGauss()); //this will update contents by applying filter
-     applyGaussianFilter_hp(mapB, SphParam.getSigmaGauss()); //this will update contents by applying filter
      outputKappaFits.clear();
      mapPair = std::make_pair (mapE, mapB);
-     getSphericalConvergenceMap (mapPair, kappaPair, SphParam);
+     getSphericalConvergenceMap (mapPair, kappaPair, SphParam, SphParam.getSigmaGauss());
    // Generate the output FITS filenames
      outputKappaFits = fs::path("EUC_LE3_WL_DenoisedSphereConvergence_" + getDateTimeString() + ".fits");
      outfile << ",";
    // Writing output Fits files
      logger.info("# Writing Spherical DeNoised Convergence Map");
-     SphericalIO.write_Map((datadir/outputKappaFits).native(), kappaPair.first, "KAPPA_E");
-     SphericalIO.write_Map((datadir/outputKappaFits).native(), kappaPair.second, "KAPPA_B");
+     SphericalIO.write_Maps((datadir/outputKappaFits).native(), {&kappaPair.first, &kappaPair.second},
+                            {"KAPPA_E", "KAPPA_B"});
      outfile << outputKappaFits.filename();
    }
 }
@@ -27,6 +27,8 @@
 #include "ElementsKernel/Auxiliary.h"
 #include "ElementsKernel/Temporary.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_map_maker.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
 
@@ -95,6 +97,76 @@ BOOST_AUTO_TEST_CASE( SphMapMaker_test ) {
   BOOST_CHECK(true);
 }
 
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( SphMapMakerChunks_test ) {
+  std::cout << "-- SphMapMakerChunks_Test"<<std::endl;
+  Sph_map_maker mapMaker(params);
+  auto [ Shear1, Shear2, GalCount ] = mapMaker.create_ShearMap(catData);
+
+  // Bin the same catalog by chunks of 100 rows
+  Sph_map_maker chunkMapMaker(params);
+  chunkMapMaker.startBinning();
+  for (size_t first = 0; first < catData[0].size(); first += 100) {
+    size_t last = std::min(first + 100, catData[0].size());
+    std::vector<std::vector<double> > chunk;
+    for (const auto& column : catData) {
+      chunk.emplace_back(column.begin() + first, column.begin() + last);
+    }
+    chunkMapMaker.addCatalogChunk(chunk);
+  }
+  auto [ ChunkShear1, ChunkShear2, ChunkGalCount ] = chunkMapMaker.getBinnedShearMap();
+
+  BOOST_CHECK_EQUAL(ChunkShear1.Npix(), Shear1.Npix());
+  int nbDifferences = 0;
+  for (int i = 0; i < Shear1.Npix(); i++) {
+    nbDifferences += (ChunkShear1[i] != Shear1[i]) + (ChunkShear2[i] != Shear2[i]) + (ChunkGalCount[i] != GalCount[i]);
+  }
+  BOOST_CHECK_EQUAL(nbDifferences, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( SphMapMakerParallel_test ) {
+  std::cout << "-- SphMapMakerParallel_Test"<<std::endl;
+  // Catalog of several blocks of rows, binned serially as reference
+  size_t ngal = 200000;
+  std::vector<std::vector<double> > bigCatalog(5, std::vector<double>(ngal));
+  Healpix_Map<double> g1Ref, g2Ref, countRef;
+  g1Ref.SetNside(params.getNside(), RING);
+  g2Ref.SetNside(params.getNside(), RING);
+  countRef.SetNside(params.getNside(), RING);
+  g1Ref.fill(0.);
+  g2Ref.fill(0.);
+  countRef.fill(0.);
+  for (size_t i = 0; i < ngal; i++) {
+    bigCatalog[0][i] = fmod(i*137.508, 360.);
+    bigCatalog[1][i] = asin(fmod(i*0.618034, 2.) - 1.)*180./M_PI;
+    bigCatalog[3][i] = sin(0.1*i);
+    bigCatalog[4][i] = cos(0.3*i);
+    pointing ptg(M_PI*0.5 - bigCatalog[1][i]*M_PI/180., bigCatalog[0][i]*M_PI/180.);
+    ptg.normalize();
+    int id_pix = g1Ref.ang2pix(ptg);
+    g1Ref[id_pix] += bigCatalog[3][i];
+    g2Ref[id_pix] += bigCatalog[4][i];
+    countRef[id_pix] += 1.;
+  }
+  for (int i = 0; i < g1Ref.Npix(); i++) {
+    if (countRef[i] != 0) {
+      g1Ref[i] = g1Ref[i]/countRef[i];
+      g2Ref[i] = g2Ref[i]/countRef[i];
+    }
+  }
+
+  Sph_map_maker mapMaker(params);
+  auto [ Shear1, Shear2, GalCount ] = mapMaker.create_ShearMap(bigCatalog);
+  int nbDifferences = 0;
+  for (int i = 0; i < Shear1.Npix(); i++) {
+    nbDifferences += (Shear1[i] != g1Ref[i]) + (Shear2[i] != g2Ref[i]) + (GalCount[i] != countRef[i]);
+  }
+  BOOST_CHECK_EQUAL(nbDifferences, 0);
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END ()
@@ -29,8 +29,11 @@
 #include "ElementsKernel/Auxiliary.h"
 #include "ElementsKernel/Temporary.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_map_maker.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
 using LE3_2D_MASS_WL_SPHERICAL::Sph_map_maker;
 using LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
@@ -151,4 +154,127 @@ BOOST_AUTO_TEST_CASE( reduceShearHealpix_test ) {
  BOOST_REQUIRE(true);
 }
 //-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( SpinRoundTrip_test ) {
+ std::cout << "-- SphMassMapping: SpinRoundTrip_Test"<<std::endl;
+ // Band limited convergence maps, without monopole and dipole that the KS inversion removes
+ int testNside = 16;
+ int lmax = 2*testNside;
+ Alm<xcomplex<double> > almE(lmax, lmax), almB(lmax, lmax);
+ almE.SetToZero();
+ almB.SetToZero();
+ for (int l = 2; l <= lmax; l++) {
+  for (int m = 0; m <= l; m++) {
+   double im = (m == 0) ? 0. : cos(0.3*l + m);
+   almE(l, m) = xcomplex<double>(sin(0.7*l + 1.3*m), im) / double(l);
+   almB(l, m) = xcomplex<double>(cos(1.1*l + 0.5*m), 0.5*im) / double(l*l);
+  }
+ }
+ Healpix_Map<double> kE(testNside, RING, SET_NSIDE), kB(testNside, RING, SET_NSIDE);
+ alm2map(almE, kE);
+ alm2map(almB, kB);
+
+ Sph_mass_mapping massmapping;
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair = massmapping.create_ConvtoShearMap(kE, kB);
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > convPair =
+                      massmapping.create_SheartoConvMap(shearPair.first, shearPair.second);
+
+ double maxKappa = 0., maxDiff = 0.;
+ for (int it = 0; it < kE.Npix(); it++) {
+  maxKappa = std::max(maxKappa, std::max(fabs(kE[it]), fabs(kB[it])));
+  maxDiff = std::max(maxDiff, std::max(fabs(convPair.first[it] - kE[it]), fabs(convPair.second[it] - kB[it])));
+ }
+ BOOST_CHECK(maxKappa > 0.);
+ BOOST_CHECK(maxDiff < 1e-2 * maxKappa);
+}
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( FusedDeNoisedShear_test ) {
+ std::cout << "-- SphMassMapping: FusedDeNoisedShear_Test"<<std::endl;
+ // Band limited shear maps
+ int testNside = 16;
+ int lmax = 2*testNside;
+ SphericalParam params;
+ params.setBandLimit(lmax);
+ Alm<xcomplex<double> > almE(lmax, lmax), almB(lmax, lmax);
+ almE.SetToZero();
+ almB.SetToZero();
+ for (int l = 2; l <= lmax; l++) {
+  for (int m = 0; m <= l; m++) {
+   double im = (m == 0) ? 0. : cos(0.3*l + m);
+   almE(l, m) = xcomplex<double>(sin(0.7*l + 1.3*m), im) / double(l);
+   almB(l, m) = xcomplex<double>(cos(1.1*l + 0.5*m), 0.5*im) / double(l*l);
+  }
+ }
+ Healpix_Map<double> g1(testNside, RING, SET_NSIDE), g2(testNside, RING, SET_NSIDE);
+ alm2map_spin(almE, almB, g1, g2, 2);
+ double sigma = 0.05;
+
+ // Chain of separate transforms: mass mapping, smoothing of kappaE, inverse mass mapping
+ Sph_mass_mapping massmapping(params);
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair = massmapping.create_SheartoConvMap(g1, g2);
+ LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace workspace(params);
+ Euclid::WeakLensing::TwoDMass::Spherical::applyGaussianFilter_hp(kappaPair.first, sigma, workspace);
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair =
+                      massmapping.create_ConvtoShearMap(kappaPair.first, kappaPair.second);
+
+ // Single harmonic pass
+ Healpix_Map<double> outG1, outG2, outKE, outKB;
+ massmapping.create_DeNoisedShearMap(g1, g2, sigma, outG1, outG2, outKE, outKB, workspace);
+
+ double maxShear = 0., maxKappa = 0., maxShearDiff = 0., maxKappaDiff = 0.;
+ for (int it = 0; it < g1.Npix(); it++) {
+  maxShear = std::max(maxShear, std::max(fabs(shearPair.first[it]), fabs(shearPair.second[it])));
+  maxKappa = std::max(maxKappa, std::max(fabs(kappaPair.first[it]), fabs(kappaPair.second[it])));
+  maxShearDiff = std::max(maxShearDiff, std::max(fabs(outG1[it] - shearPair.first[it]),
+                                                 fabs(outG2[it] - shearPair.second[it])));
+  maxKappaDiff = std::max(maxKappaDiff, std::max(fabs(outKE[it] - kappaPair.first[it]),
+                                                 fabs(outKB[it] - kappaPair.second[it])));
+ }
+ BOOST_CHECK(maxShear > 0.);
+ BOOST_CHECK(maxKappa > 0.);
+ BOOST_CHECK(maxShearDiff < 1e-2 * maxShear);
+ BOOST_CHECK(maxKappaDiff < 1e-2 * maxKappa);
+
+ // Without smoothing, same convergence as the mass mapping
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > rawKappa = massmapping.create_SheartoConvMap(g1, g2);
+ massmapping.create_SmoothedSheartoConvMap(g1, g2, 0., outKE, outKB, workspace);
+ for (int it = 0; it < g1.Npix(); it++) {
+  BOOST_CHECK_SMALL(outKE[it] - rawKappa.first[it], 1e-10);
+  BOOST_CHECK_SMALL(outKB[it] - rawKappa.second[it], 1e-10);
+ }
+}
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( BatchedMassMapping_test ) {
+ std::cout << "-- SphMassMapping: BatchedMassMapping_Test"<<std::endl;
+ int testNside = 16;
+ SphericalParam params;
+ std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > shearPairs;
+ for (int r = 0; r < 5; r++) {
+  Healpix_Map<double> g1(testNside, RING, SET_NSIDE), g2(testNside, RING, SET_NSIDE);
+  for (int it = 0; it < g1.Npix(); it++) {
+   g1[it] = 0.01 * cos(0.05 * it + r);
+   g2[it] = 0.01 * sin(0.03 * it - r);
+  }
+  shearPairs.push_back(std::make_pair(g1, g2));
+ }
+
+ Sph_mass_mapping massmapping(params);
+ std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > expected;
+ for (size_t r = 0; r < shearPairs.size(); r++) {
+  expected.push_back(massmapping.create_SheartoConvMap(shearPairs[r].first, shearPairs[r].second));
+ }
+
+ // Batches of 2 maps, the last one being incomplete
+ LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace workspace(params);
+ std::vector<std::pair<Healpix_Map<double>, Healpix_Map<double> > > kappaPairs =
+                      massmapping.create_SheartoConvMaps(shearPairs, workspace, 2);
+ BOOST_CHECK_EQUAL(kappaPairs.size(), shearPairs.size());
+ for (size_t r = 0; r < kappaPairs.size(); r++) {
+  BOOST_CHECK_EQUAL(kappaPairs[r].first.Nside(), testNside);
+  for (int it = 0; it < kappaPairs[r].first.Npix(); it++) {
+   BOOST_CHECK_SMALL(kappaPairs[r].first[it] - expected[r].first[it], 1e-12);
+   BOOST_CHECK_SMALL(kappaPairs[r].second[it] - expected[r].second[it], 1e-12);
+  }
+ }
+}
+//-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_SUITE_END ()
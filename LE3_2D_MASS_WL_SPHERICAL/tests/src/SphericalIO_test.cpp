@@ -117,6 +117,58 @@ BOOST_AUTO_TEST_CASE( wrtieMap_test ) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE( writeMaps_test ) {
+ std::cout << "-- SphericalIO: writeMaps_Test"<<std::endl;
+
+ using Elements::TempDir;
+ TempDir one;
+ test_path = one.path();
+
+ Sph_map_maker mapMaker(params);
+ auto [ Shear1, Shear2, GalCount ] = mapMaker.create_ShearMap(catData);
+
+ // full sky in double precision: the maps are read back unchanged
+ SphericalIO fullSkyIO(params);
+ boost::filesystem::path filename = test_path / "GMaps.fits";
+ BOOST_CHECK(fullSkyIO.write_Maps(filename.native(), {&Shear1, &Shear2}, {"GAMMA1", "GAMMA2"}));
+ std::vector<std::string> colnames;
+ std::vector<Healpix_Map<double> > maps = fullSkyIO.read_Maps(filename.native(), colnames);
+ BOOST_REQUIRE_EQUAL(maps.size(), 2);
+ BOOST_CHECK_EQUAL(colnames[0], "GAMMA1");
+ BOOST_CHECK_EQUAL(maps[0].Nside(), Shear1.Nside());
+ int differences = 0;
+ for (int pix = 0; pix < Shear1.Npix(); pix++) {
+   differences += (maps[0][pix] != Shear1[pix]) + (maps[1][pix] != Shear2[pix]);
+ }
+ BOOST_CHECK_EQUAL(differences, 0);
+
+ // partial sky in float32: the observed pixels are read back in single precision, the others are 0
+ SphericalParam partialParams(params);
+ partialParams.setMapSinglePrecision(true);
+ partialParams.setPartialSkyMaps(true);
+ SphericalIO partialSkyIO(partialParams);
+ filename = test_path / "GMapsPartial.fits";
+ BOOST_CHECK(partialSkyIO.write_Maps(filename.native(), {&Shear1, &Shear2}, {"GAMMA1", "GAMMA2"}));
+ maps = partialSkyIO.read_Maps(filename.native(), colnames);
+ BOOST_REQUIRE_EQUAL(maps.size(), 2);
+ BOOST_CHECK_EQUAL(colnames[1], "GAMMA2");
+ differences = 0;
+ for (int pix = 0; pix < Shear1.Npix(); pix++) {
+   differences += (maps[0][pix] != double(float(Shear1[pix]))) + (maps[1][pix] != double(float(Shear2[pix])));
+ }
+ BOOST_CHECK_EQUAL(differences, 0);
+
+ // readHealpixMap scatters the explicit indexing in the E and B maps
+ std::pair<Healpix_Map<double>, Healpix_Map<double> > mapPair = readHealpixMap(filename.native());
+ BOOST_REQUIRE_EQUAL(mapPair.first.Npix(), Shear1.Npix());
+ BOOST_REQUIRE_EQUAL(mapPair.second.Npix(), Shear2.Npix());
+ differences = 0;
+ for (int pix = 0; pix < Shear1.Npix(); pix++) {
+   differences += (mapPair.first[pix] != maps[0][pix]) + (mapPair.second[pix] != maps[1][pix]);
+ }
+ BOOST_CHECK_EQUAL(differences, 0);
+}
+
 //-----------------------------------------------------------------------------
 
 BOOST_AUTO_TEST_SUITE_END ()
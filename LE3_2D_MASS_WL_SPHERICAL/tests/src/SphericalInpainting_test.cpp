@@ -31,8 +31,14 @@
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalInpainting.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
 #include "LE3_2D_MASS_WL_SPHERICAL/Sph_mass_mapping.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalTransform.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
 
 #include <ios>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <iostream>
 
@@ -40,6 +46,7 @@ using std::string;
 using LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
 using LE3_2D_MASS_WL_SPHERICAL::SphericalInpainting;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalTransform;
 using Euclid::WeakLensing::TwoDMass::Spherical::SphericalIO;
 using namespace Euclid::WeakLensing::TwoDMass;
 using namespace Euclid::WeakLensing::TwoDMass::Spherical;
@@ -49,6 +56,14 @@ using boost::filesystem::path;
 
 static Elements::Logging logger = Elements::Logging::getLogger("SphericalInpainting_test");
 
+// Writes the HEALPix ring weights file of the given nside in the given directory
+static void writeRingWeights(const boost::filesystem::path& dir, int nside, const std::vector<double>& weights) {
+  char filename[32];
+  std::snprintf(filename, sizeof(filename), "weight_ring_n%05d.fits", nside);
+  MefFile outfile((dir / filename).native(), MefFile::Permission::Overwrite);
+  outfile.assignBintableExt("WEIGHTS", generateColumn<double>("TEMPERATURE WEIGHTS", weights));
+}
+
 //-----------------------------------------------------------------------------
 
 struct SphericalInpaintingDataSyncFixture {
@@ -118,4 +133,145 @@ BOOST_AUTO_TEST_CASE( Overall_SphericalInpainting_test) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE( Harmonic_SphericalInpainting_test) {
+   SphericalParam params;
+   if (true == fileHasField(testParamFile, "DpdTwoDMassParamsConvergenceSphere")) {
+    params.getConvergenceSphereParam(testParamFile.native());
+   }
+   params.setHarmonicInpainting(true);
+
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > mapPair;
+   mapPair = readHealpixMap(gamma.native());
+
+   int m_npix = mapPair.first.Npix();
+   std::vector<int> masked;
+   for (int it = 0; it<m_npix; it++) {
+     if (fabs(mapPair.first[it])==0. && fabs(mapPair.second[it])==0.) {
+       masked.push_back(it);
+     }
+   }
+
+   Sph_mass_mapping massmapping(params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair = massmapping.create_SheartoConvMap(mapPair.first, mapPair.second);
+
+   SphericalInpainting Inpainting ( mapPair, kappaPair, params);
+   kappaPair = Inpainting.performInpainting();
+
+   for (size_t i = 0; i<masked.size(); i++) {
+     BOOST_CHECK(kappaPair.first[masked[i]] != 0.);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( HarmonicEquivalence_test) {
+   // Without thresholding (single iteration), the two solvers do the same mask projection
+   int nside = 16;
+   SphericalParam params(nside, 0, 1, 0, 0, 1, 1, 0., 10., 1, "KAPPA_SPHERE", 0., 0., 0., 0);
+   params.setBandLimit(2*nside);
+
+   Healpix_Map<double> gamma1, gamma2;
+   gamma1.SetNside(nside, RING);
+   gamma2.SetNside(nside, RING);
+   Alm<xcomplex<double> > almE(2*nside, 2*nside), almB(2*nside, 2*nside);
+   almE.SetToZero();
+   almB.SetToZero();
+   for (int l = 2; l <= 2*nside; l++) {
+    for (int m = 0; m <= l; m++) {
+     double im = (m == 0) ? 0. : sin(0.9*l + 0.4*m);
+     almE(l, m) = xcomplex<double>(cos(0.5*l + 1.7*m), im) / double(l*l);
+     almB(l, m) = 0.1 * almE(l, m);
+    }
+   }
+   alm2map_spin(almE, almB, gamma1, gamma2, 2);
+   // masked cap around the north pole
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     if (gamma1.pix2ang(it).theta < 0.5) {
+       gamma1[it] = 0.;
+       gamma2[it] = 0.;
+     }
+   }
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair(gamma1, gamma2);
+
+   Sph_mass_mapping massmapping(params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair = massmapping.create_SheartoConvMap(gamma1, gamma2);
+
+   SphericalInpainting pixelInpainting(shearPair, kappaPair, params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > pixelPair = pixelInpainting.performInpainting();
+
+   params.setHarmonicInpainting(true);
+   SphericalInpainting harmonicInpainting(shearPair, kappaPair, params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > harmonicPair = harmonicInpainting.performInpainting();
+
+   double maxKappa = 0.;
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     maxKappa = std::max(maxKappa, fabs(pixelPair.first[it]));
+   }
+   BOOST_CHECK(maxKappa > 0.);
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     BOOST_CHECK_SMALL(harmonicPair.first[it] - pixelPair.first[it], 0.05*maxKappa);
+     BOOST_CHECK_SMALL(harmonicPair.second[it] - pixelPair.second[it], 0.05*maxKappa);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( FootprintRings_test) {
+   // The inpainting fills the pixels off the footprint: its transforms ignore the footprint rings
+   int nside = 16;
+   SphericalParam params(nside, 0, 1, 0, 0, 1, 1, 0., 10., 1, "KAPPA_SPHERE", 0., 0., 0., 0);
+   params.setBandLimit(2*nside);
+   Elements::TempDir tempDir;
+   writeRingWeights(tempDir.path(), nside, std::vector<double>(2*nside, 0.));
+   params.setRingWeightsDir(tempDir.path().native());
+
+   Healpix_Map<double> gamma1, gamma2;
+   gamma1.SetNside(nside, RING);
+   gamma2.SetNside(nside, RING);
+   Alm<xcomplex<double> > almE(2*nside, 2*nside), almB(2*nside, 2*nside);
+   almE.SetToZero();
+   almB.SetToZero();
+   for (int l = 2; l <= 2*nside; l++) {
+    for (int m = 0; m <= l; m++) {
+     double im = (m == 0) ? 0. : sin(0.9*l + 0.4*m);
+     almE(l, m) = xcomplex<double>(cos(0.5*l + 1.7*m), im) / double(l*l);
+    }
+   }
+   alm2map_spin(almE, almB, gamma1, gamma2, 2);
+   // observed cap around the north pole
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     if (gamma1.pix2ang(it).theta > 1.) {
+       gamma1[it] = 0.;
+       gamma2[it] = 0.;
+     }
+   }
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > shearPair(gamma1, gamma2);
+   Sph_mass_mapping massmapping(params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > kappaPair = massmapping.create_SheartoConvMap(gamma1, gamma2);
+
+   SphericalInpainting fullSkyInpainting(shearPair, kappaPair, params);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > fullSkyPair = fullSkyInpainting.performInpainting();
+
+   // the mass mapping transforms of these parameters are restricted to the rings of the cap
+   SphericalParam restrictedParams(params);
+   restrictedParams.setFootprintRings(nside, Spherical::getFootprintRings(gamma1));
+   BOOST_REQUIRE(SphericalTransform(nside, restrictedParams).isRingRestricted());
+   SphericalInpainting restrictedInpainting(shearPair, kappaPair, restrictedParams);
+   std::pair<Healpix_Map<double>, Healpix_Map<double> > restrictedPair = restrictedInpainting.performInpainting();
+
+   double maxKappa = 0., maxOutside = 0.;
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     maxKappa = std::max(maxKappa, fabs(fullSkyPair.first[it]));
+     if (gamma1.pix2ang(it).theta > 1.) {
+       maxOutside = std::max(maxOutside, fabs(restrictedPair.first[it]));
+     }
+   }
+   BOOST_CHECK(maxKappa > 0.);
+   BOOST_CHECK(maxOutside > 0.);
+   for (int it = 0; it < gamma1.Npix(); it++) {
+     BOOST_CHECK_SMALL(restrictedPair.first[it] - fullSkyPair.first[it], 1e-10*maxKappa);
+     BOOST_CHECK_SMALL(restrictedPair.second[it] - fullSkyPair.second[it], 1e-10*maxKappa);
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END ()
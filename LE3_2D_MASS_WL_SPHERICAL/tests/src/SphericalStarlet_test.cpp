@@ -0,0 +1,135 @@
+/**
+ * @file tests/src/SphericalStarlet_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalStarlet.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "ElementsKernel/Logging.h"
+#include "ElementsKernel/Exception.h"
+#include <cmath>
+#include <iostream>
+
+using LE3_2D_MASS_WL_SPHERICAL::SphericalStarlet;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
+using namespace Euclid::WeakLensing::TwoDMass::Spherical;
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalStarlet_test");
+
+//-----------------------------------------------------------------------------
+
+struct SphericalStarletFixture {
+  SphericalStarletFixture(): nside(16), nbScales(4), workspace(params) {
+   map.SetNside(nside, RING);
+   for (int it = 0; it < map.Npix(); it++) {
+     pointing ptg = map.pix2ang(it);
+     map[it] = cos(3.*ptg.theta) * sin(2.*ptg.phi) + 0.1*cos(0.7*it);
+   }
+  }
+  ~SphericalStarletFixture()
+  { }
+  int nside;
+  int nbScales;
+  SphericalParam params;
+  SphericalWorkspace workspace;
+  Healpix_Map<double> map;
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_SUITE (SphericalStarlet_test, SphericalStarletFixture)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( FilterBank_test ) {
+  std::cout << "-- SphericalStarlet: FilterBank_test"<<std::endl;
+  SphericalStarlet starlet(workspace, nside, nbScales);
+  BOOST_CHECK_EQUAL(starlet.getNbScales(), nbScales);
+  int nlmax = workspace.getTransform(nside).getLmax();
+  for (int b = 0; b < nbScales-1; b++) {
+    std::vector<double> filter(nlmax+1, 0.);
+    getFilter(filter.data(), nlmax*pow(0.5, b), nlmax);
+    BOOST_CHECK_EQUAL(starlet.getFilter(b).size(), filter.size());
+    for (int l = 0; l <= nlmax; l++) {
+      BOOST_CHECK_EQUAL(starlet.getFilter(b)[l], filter[l]);
+    }
+  }
+  BOOST_CHECK_THROW(starlet.getFilter(nbScales-1), Elements::Exception);
+  BOOST_CHECK_THROW(SphericalStarlet noScale(workspace, nside, 0), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Decomposition_test ) {
+  std::cout << "-- SphericalStarlet: Decomposition_test"<<std::endl;
+  SphericalStarlet starlet(workspace, nside, nbScales);
+  std::vector<Healpix_Map<double> > bands = starlet.decompose(map);
+  BOOST_CHECK_EQUAL(bands.size(), nbScales);
+
+  // Same bands as the differences of the smoothed maps of each scale
+  Healpix_Map<double> previous = map;
+  for (int b = 0; b < nbScales-1; b++) {
+    Healpix_Map<double> smooth = smoothBspline_hp(map, b, workspace);
+    for (int it = 0; it < map.Npix(); it++) {
+      BOOST_CHECK_SMALL(bands[b][it] - (previous[it] - smooth[it]), 1e-10);
+    }
+    previous = smooth;
+  }
+
+  // The sum of the bands is the map
+  Healpix_Map<double> mapBack = reconsBspline_hp(bands);
+  for (int it = 0; it < map.Npix(); it++) {
+    BOOST_CHECK_SMALL(mapBack[it] - map[it], 1e-10);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Visit_test ) {
+  std::cout << "-- SphericalStarlet: Visit_test"<<std::endl;
+  SphericalStarlet starlet(workspace, nside, nbScales);
+  std::vector<Healpix_Map<double> > bands = starlet.decompose(map);
+  int count = 0;
+  // the visited bands are synthesised one at a time, the returned ones in a batch
+  starlet.decompose(map, [&] (int scale, Healpix_Map<double>& band) {
+    BOOST_CHECK_EQUAL(scale, count);
+    for (int it = 0; it < map.Npix(); it++) {
+      BOOST_CHECK_SMALL(band[it] - bands[scale][it], 1e-10);
+    }
+    count++;
+  });
+  BOOST_CHECK_EQUAL(count, nbScales);
+
+  SphericalStarlet single(workspace, nside, 1);
+  std::vector<Healpix_Map<double> > identity = single.decompose(map);
+  BOOST_CHECK_EQUAL(identity.size(), 1);
+  for (int it = 0; it < map.Npix(); it++) {
+    BOOST_CHECK_EQUAL(identity[0][it], map[it]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
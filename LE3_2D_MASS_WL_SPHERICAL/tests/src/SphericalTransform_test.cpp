@@ -0,0 +1,360 @@
+/**
+ * @file tests/src/SphericalTransform_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalTransform.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalUtils.h"
+#include "ElementsKernel/Logging.h"
+#include "ElementsKernel/Temporary.h"
+#include "ElementsKernel/Exception.h"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using LE3_2D_MASS_WL_SPHERICAL::SphericalTransform;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
+using namespace Euclid::WeakLensing::TwoDMass;
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalTransform_test");
+
+// Writes the HEALPix ring weights file of the given nside in the given directory
+static void writeRingWeights(const boost::filesystem::path& dir, int nside, const std::vector<double>& weights) {
+  char filename[32];
+  std::snprintf(filename, sizeof(filename), "weight_ring_n%05d.fits", nside);
+  MefFile outfile((dir / filename).native(), MefFile::Permission::Overwrite);
+  outfile.assignBintableExt("WEIGHTS", generateColumn<double>("TEMPERATURE WEIGHTS", weights));
+}
+
+//-----------------------------------------------------------------------------
+
+struct SphericalTransformFixture {
+  SphericalTransformFixture(): nside(8), lmax(2*nside), almIn(lmax, lmax) {
+   // Band limited map
+   almIn.SetToZero();
+   for (int l = 0; l <= lmax; l++) {
+    for (int m = 0; m <= l; m++) {
+     double im = (m == 0) ? 0. : sin(0.9*l + 0.4*m);
+     almIn(l, m) = xcomplex<double>(cos(0.5*l + 1.7*m), im) / double(l+1);
+    }
+   }
+   map.SetNside(nside, RING);
+   alm2map(almIn, map);
+  }
+  ~SphericalTransformFixture()
+  { }
+  int nside;
+  int lmax;
+  Alm<xcomplex<double> > almIn;
+  Healpix_Map<double> map;
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_SUITE (SphericalTransform_test, SphericalTransformFixture)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( UnitWeights_test ) {
+  std::cout << "-- SphericalTransform: UnitWeights_test"<<std::endl;
+  SphericalParam params;
+  SphericalTransform transform(nside, params);
+  BOOST_CHECK_EQUAL(transform.getNside(), nside);
+  BOOST_CHECK_EQUAL(transform.getLmax(), 3*nside-1);
+  BOOST_CHECK(transform.hasRingWeights() == false);
+  BOOST_CHECK_EQUAL(transform.getNbIterations(), 3);
+  BOOST_CHECK_EQUAL(transform.getWeights().size(), 2*nside);
+
+  // Missing weights files: same as unit weights
+  params.setRingWeightsDir("/nonexistent");
+  SphericalTransform noWeights(nside, params);
+  BOOST_CHECK(noWeights.hasRingWeights() == false);
+  BOOST_CHECK_EQUAL(noWeights.getNbIterations(), 3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( BandLimit_test ) {
+  std::cout << "-- SphericalTransform: BandLimit_test"<<std::endl;
+  SphericalParam params;
+  params.setBandLimit(lmax);
+  SphericalTransform transform(nside, params);
+  BOOST_CHECK_EQUAL(transform.getLmax(), lmax);
+  BOOST_CHECK_EQUAL(transform.getMmax(), lmax);
+  Alm<xcomplex<double> > alm = transform.createAlm();
+  BOOST_CHECK_EQUAL(alm.Lmax(), lmax);
+  BOOST_CHECK_EQUAL(alm.Mmax(), lmax);
+
+  // The band limited map is analysed exactly at its band limit
+  transform.map2alm(map, alm);
+  double maxDiff = 0.;
+  for (int l = 0; l <= lmax; l++) {
+   for (int m = 0; m <= l; m++) {
+    maxDiff = std::max(maxDiff, std::abs(alm(l, m) - almIn(l, m)));
+   }
+  }
+  BOOST_CHECK(maxDiff < 5e-3);
+
+  params.setBandLimit(lmax, 4);
+  SphericalTransform lowM(nside, params);
+  BOOST_CHECK_EQUAL(lowM.getMmax(), 4);
+  BOOST_CHECK_EQUAL(lowM.createAlm().Mmax(), 4);
+
+  params.setBandLimit(3*nside);
+  BOOST_CHECK_THROW(SphericalTransform tooHigh(nside, params), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( RingWeights_test ) {
+  std::cout << "-- SphericalTransform: RingWeights_test"<<std::endl;
+  Elements::TempDir tempDir;
+  // HEALPix ring weights files store the weights minus one
+  writeRingWeights(tempDir.path(), nside, std::vector<double>(2*nside, 0.));
+
+  SphericalParam params;
+  params.setRingWeightsDir(tempDir.path().native());
+  SphericalTransform transform(nside, params);
+  BOOST_CHECK(transform.hasRingWeights() == true);
+  BOOST_CHECK_EQUAL(transform.getNbIterations(), 0);
+  BOOST_REQUIRE_EQUAL(transform.getWeights().size(), 2*nside);
+  BOOST_CHECK_CLOSE(transform.getWeights()[0], 1., 1e-12);
+
+  // The weights are read once per nside and shared
+  SphericalTransform other(nside, params);
+  BOOST_CHECK(&other.getWeights() == &transform.getWeights());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( WeightedAnalysis_test ) {
+  std::cout << "-- SphericalTransform: WeightedAnalysis_test"<<std::endl;
+  // Ring weights integrating exactly the Legendre polynomials up to 4*nside-2 (the odd ones vanish by
+  // symmetry): the analysis without iterations of a zonal map of band limit 2*nside-1 is then exact
+  const int zonalLmax = 2*nside-1;
+  const int nbWeights = 2*nside;
+  Healpix_Base base(nside, RING, SET_NSIDE);
+  std::vector<std::vector<double> > system(nbWeights, std::vector<double>(nbWeights + 1, 0.));
+  for (int ring = 1; ring <= nbWeights; ring++) {
+   int startpix, ringpix;
+   double theta;
+   bool shifted;
+   base.get_ring_info2(ring, startpix, ringpix, theta, shifted);
+   // pixels of the ring and of its southern mirror
+   double pixels = (ring < nbWeights ? 2. : 1.) * ringpix;
+   double z = cos(theta), p0 = 1., p1 = z;
+   system[0][ring-1] = pixels;
+   for (int l = 2; l <= 2*(nbWeights-1); l++) {
+    double p2 = ((2*l-1)*z*p1 - (l-1)*p0)/l;
+    p0 = p1;
+    p1 = p2;
+    if (l % 2 == 0) {
+     system[l/2][ring-1] = pixels*p1;
+    }
+   }
+  }
+  system[0][nbWeights] = base.Npix();
+  // Gaussian elimination with partial pivoting
+  for (int col = 0; col < nbWeights; col++) {
+   int pivot = col;
+   for (int row = col+1; row < nbWeights; row++) {
+    if (std::abs(system[row][col]) > std::abs(system[pivot][col])) {
+     pivot = row;
+    }
+   }
+   std::swap(system[col], system[pivot]);
+   for (int row = col+1; row < nbWeights; row++) {
+    double factor = system[row][col]/system[col][col];
+    for (int k = col; k <= nbWeights; k++) {
+     system[row][k] -= factor*system[col][k];
+    }
+   }
+  }
+  std::vector<double> weights(nbWeights);
+  for (int col = nbWeights-1; col >= 0; col--) {
+   double sum = system[col][nbWeights];
+   for (int k = col+1; k < nbWeights; k++) {
+    sum -= system[col][k]*(weights[k] + 1.);
+   }
+   // HEALPix ring weights files store the weights minus one
+   weights[col] = sum/system[col][col] - 1.;
+  }
+  Elements::TempDir tempDir;
+  writeRingWeights(tempDir.path(), nside, weights);
+
+  SphericalParam params;
+  params.setBandLimit(zonalLmax);
+  params.setRingWeightsDir(tempDir.path().native());
+  SphericalTransform transform(nside, params);
+  BOOST_REQUIRE(transform.hasRingWeights() == true);
+  BOOST_REQUIRE_EQUAL(transform.getNbIterations(), 0);
+
+  // Zonal scalar field and spin-2 field of E and B modes
+  Alm<xcomplex<double> > almZonal = transform.createAlm(), almE = transform.createAlm();
+  Alm<xcomplex<double> > almB = transform.createAlm();
+  for (int l = 0; l <= zonalLmax; l++) {
+   almZonal(l, 0) = cos(0.5*l + 0.3) / double(l+1);
+   if (l >= 2) {
+    almE(l, 0) = sin(0.7*l) / double(l+1);
+    almB(l, 0) = cos(1.1*l) / double(l+1);
+   }
+  }
+  Healpix_Map<double> zonalMap(nside, RING, SET_NSIDE);
+  Healpix_Map<double> gamma1(nside, RING, SET_NSIDE), gamma2(nside, RING, SET_NSIDE);
+  alm2map(almZonal, zonalMap);
+  alm2map_spin(almE, almB, gamma1, gamma2, 2);
+
+  // Single and batched analyses: the spin-2 ones reuse the temperature weights
+  Alm<xcomplex<double> > alm = transform.createAlm(), alm1 = transform.createAlm();
+  Alm<xcomplex<double> > alm2 = transform.createAlm(), batchAlm1 = transform.createAlm();
+  Alm<xcomplex<double> > batchAlm2 = transform.createAlm();
+  transform.map2alm(zonalMap, alm);
+  transform.map2alm_spin(gamma1, gamma2, alm1, alm2, 2);
+  transform.map2alm_spin({&gamma1}, {&gamma2}, {&batchAlm1}, {&batchAlm2}, 2);
+  // the m > 0 coefficients are aliased by the rings of less than 2*lmax pixels, as for any weights
+  double maxDiff = 0.;
+  for (int l = 0; l <= zonalLmax; l++) {
+   maxDiff = std::max(maxDiff, std::abs(alm(l, 0) - almZonal(l, 0)));
+   maxDiff = std::max(maxDiff, std::abs(alm1(l, 0) - almE(l, 0)));
+   maxDiff = std::max(maxDiff, std::abs(alm2(l, 0) - almB(l, 0)));
+   maxDiff = std::max(maxDiff, std::abs(batchAlm1(l, 0) - almE(l, 0)));
+   maxDiff = std::max(maxDiff, std::abs(batchAlm2(l, 0) - almB(l, 0)));
+  }
+  BOOST_CHECK(maxDiff < 1e-8);
+}
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Analysis_test ) {
+  std::cout << "-- SphericalTransform: Analysis_test"<<std::endl;
+  SphericalParam params;
+  SphericalTransform transform(nside, params);
+  Alm<xcomplex<double> > almOut(transform.getLmax(), transform.getLmax());
+  almOut.SetToZero();
+  transform.map2alm(map, almOut);
+  double maxDiff = 0.;
+  for (int l = 0; l <= lmax; l++) {
+   for (int m = 0; m <= l; m++) {
+    maxDiff = std::max(maxDiff, std::abs(almOut(l, m) - almIn(l, m)));
+   }
+  }
+  BOOST_CHECK(maxDiff < 5e-3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( RingRestricted_test ) {
+  std::cout << "-- SphericalTransform: RingRestricted_test"<<std::endl;
+  // Footprint: cap of the northern hemisphere
+  Healpix_Map<double> footprint(nside, RING, SET_NSIDE);
+  for (int it = 0; it < footprint.Npix(); it++) {
+   footprint[it] = (footprint.pix2ang(it).theta < 1.) ? 1. : 0.;
+  }
+  std::vector<int> rings = Spherical::getFootprintRings(footprint);
+  BOOST_CHECK(rings.empty() == false);
+  BOOST_CHECK(int(rings.size()) < 4*nside-1);
+  for (int it = 0; it < footprint.Npix(); it++) {
+   if (footprint[it] != 0.) {
+    BOOST_CHECK(std::binary_search(rings.begin(), rings.end(), footprint.pix2ring(it)));
+   }
+  }
+
+  // The restriction needs the ring weights: the Jacobi iterations of the unit weights are full sky
+  SphericalParam params;
+  params.setBandLimit(lmax);
+  params.setFootprintRings(nside, rings);
+  SphericalTransform unitWeights(nside, params);
+  BOOST_CHECK(unitWeights.isRingRestricted() == false);
+  BOOST_CHECK_EQUAL(unitWeights.getNbRings(), 4*nside-1);
+
+  Elements::TempDir tempDir;
+  writeRingWeights(tempDir.path(), nside, std::vector<double>(2*nside, 0.));
+  writeRingWeights(tempDir.path(), 2*nside, std::vector<double>(4*nside, 0.));
+  params.setRingWeightsDir(tempDir.path().native());
+  SphericalTransform restricted(nside, params);
+  BOOST_CHECK(restricted.isRingRestricted());
+  BOOST_CHECK_EQUAL(restricted.getNbRings(), int(rings.size()));
+  SphericalTransform otherNside(2*nside, params);
+  BOOST_CHECK(otherNside.isRingRestricted() == false);
+
+  // Synthesis: full-sky values on the footprint rings, zero elsewhere
+  Healpix_Map<double> restrictedMap(nside, RING, SET_NSIDE);
+  restrictedMap.fill(1.);
+  restricted.alm2map(almIn, restrictedMap);
+  Healpix_Map<double> gamma1(nside, RING, SET_NSIDE), gamma2(nside, RING, SET_NSIDE);
+  Healpix_Map<double> restrictedGamma1(nside, RING, SET_NSIDE), restrictedGamma2(nside, RING, SET_NSIDE);
+  alm2map_spin(almIn, almIn, gamma1, gamma2, 2);
+  restricted.alm2map_spin(almIn, almIn, restrictedGamma1, restrictedGamma2, 2);
+  double maxDiff = 0.;
+  double maxOutside = 0.;
+  for (int it = 0; it < map.Npix(); it++) {
+   if (std::binary_search(rings.begin(), rings.end(), map.pix2ring(it))) {
+    maxDiff = std::max(maxDiff, std::abs(restrictedMap[it] - map[it]));
+    maxDiff = std::max(maxDiff, std::abs(restrictedGamma1[it] - gamma1[it]));
+    maxDiff = std::max(maxDiff, std::abs(restrictedGamma2[it] - gamma2[it]));
+   } else {
+    maxOutside = std::max(maxOutside, std::abs(restrictedMap[it]) + std::abs(restrictedGamma1[it]));
+   }
+  }
+  BOOST_CHECK(maxDiff < 1e-10);
+  BOOST_CHECK_EQUAL(maxOutside, 0.);
+
+  // Analysis of maps vanishing outside the footprint rings: the full-sky one with the same weights
+  SphericalParam fullSkyParams(params);
+  fullSkyParams.setFootprintRings(0, {});
+  SphericalTransform fullSky(nside, fullSkyParams);
+  BOOST_REQUIRE(fullSky.isRingRestricted() == false);
+  Alm<xcomplex<double> > alm = fullSky.createAlm(), restrictedAlm = restricted.createAlm();
+  Alm<xcomplex<double> > almE = fullSky.createAlm(), restrictedAlmE = restricted.createAlm();
+  Alm<xcomplex<double> > almB = fullSky.createAlm(), restrictedAlmB = restricted.createAlm();
+  fullSky.map2alm(restrictedMap, alm);
+  restricted.map2alm(restrictedMap, restrictedAlm);
+  fullSky.map2alm_spin(restrictedGamma1, restrictedGamma2, almE, almB, 2);
+  restricted.map2alm_spin(restrictedGamma1, restrictedGamma2, restrictedAlmE, restrictedAlmB, 2);
+  // the spin-0 and spin-2 analyses are compared separately, each against its own amplitude
+  double maxDiffScalar = 0., maxAlmScalar = 0.;
+  double maxDiffSpin = 0., maxAlmSpin = 0.;
+  for (int l = 0; l <= lmax; l++) {
+   for (int m = 0; m <= l; m++) {
+    maxDiffScalar = std::max(maxDiffScalar, std::abs(restrictedAlm(l, m) - alm(l, m)));
+    maxAlmScalar = std::max(maxAlmScalar, std::abs(alm(l, m)));
+    maxDiffSpin = std::max(maxDiffSpin, std::abs(restrictedAlmE(l, m) - almE(l, m)));
+    maxDiffSpin = std::max(maxDiffSpin, std::abs(restrictedAlmB(l, m) - almB(l, m)));
+    maxAlmSpin = std::max(maxAlmSpin, std::max(std::abs(almE(l, m)), std::abs(almB(l, m))));
+   }
+  }
+  BOOST_CHECK(maxAlmScalar > 0.);
+  BOOST_CHECK(maxDiffScalar < 1e-10*maxAlmScalar);
+  BOOST_CHECK(maxAlmSpin > 0.);
+  BOOST_CHECK(maxDiffSpin < 1e-10*maxAlmSpin);
+
+  // The rings must be increasing
+  params.setFootprintRings(nside, {3, 2});
+  BOOST_CHECK_THROW(SphericalTransform unsorted(nside, params), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
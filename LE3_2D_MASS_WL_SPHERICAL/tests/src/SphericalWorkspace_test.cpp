@@ -0,0 +1,114 @@
+/**
+ * @file tests/src/SphericalWorkspace_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalWorkspace.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/SphericalParam.h"
+#include "LE3_2D_MASS_WL_SPHERICAL/Sph_mass_mapping.h"
+#include "ElementsKernel/Logging.h"
+#include <cmath>
+#include <iostream>
+
+using LE3_2D_MASS_WL_SPHERICAL::SphericalWorkspace;
+using LE3_2D_MASS_WL_SPHERICAL::SphericalParam;
+using LE3_2D_MASS_WL_SPHERICAL::Sph_mass_mapping;
+
+static Elements::Logging logger = Elements::Logging::getLogger("SphericalWorkspace_test");
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (SphericalWorkspace_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Reuse_test ) {
+  std::cout << "-- SphericalWorkspace: Reuse_test"<<std::endl;
+  SphericalParam params;
+  SphericalWorkspace workspace(params);
+  int nside = 8;
+
+  BOOST_CHECK(&workspace.getTransform(nside) == &workspace.getTransform(nside));
+  BOOST_CHECK_EQUAL(workspace.getTransform(nside).getNside(), nside);
+
+  Alm<xcomplex<double> >* first;
+  Healpix_Map<double>* firstMap;
+  {
+    SphericalWorkspace::AlmBuffer alm = workspace.acquireAlm(nside);
+    SphericalWorkspace::MapBuffer map = workspace.acquireMap(nside);
+    BOOST_CHECK_EQUAL(alm->Lmax(), 3*nside-1);
+    BOOST_CHECK_EQUAL(map->Nside(), nside);
+    BOOST_CHECK(map->Scheme() == RING);
+    first = alm.get();
+    firstMap = map.get();
+
+    // A buffer in use is not given twice
+    SphericalWorkspace::AlmBuffer other = workspace.acquireAlm(nside);
+    BOOST_CHECK(other.get() != first);
+  }
+  // The released buffers are reused
+  SphericalWorkspace::AlmBuffer alm = workspace.acquireAlm(nside);
+  SphericalWorkspace::MapBuffer map = workspace.acquireMap(nside);
+  BOOST_CHECK(alm.get() == first);
+  BOOST_CHECK(map.get() == firstMap);
+
+  // Buffers of another nside are distinct
+  SphericalWorkspace::AlmBuffer almOther = workspace.acquireAlm(2*nside);
+  BOOST_CHECK_EQUAL(almOther->Lmax(), 6*nside-1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( MassMapping_test ) {
+  std::cout << "-- SphericalWorkspace: MassMapping_test"<<std::endl;
+  SphericalParam params;
+  SphericalWorkspace workspace(params);
+  int nside = 16;
+
+  Healpix_Map<double> mapE, mapB;
+  mapE.SetNside(nside, RING);
+  mapB.SetNside(nside, RING);
+  for (int it = 0; it < mapE.Npix(); it++) {
+    mapE[it] = 0.01 * cos(0.05 * it);
+    mapB[it] = 0.01 * sin(0.03 * it);
+  }
+
+  Sph_mass_mapping mapping(params);
+  std::pair<Healpix_Map<double>, Healpix_Map<double> > expected = mapping.create_SheartoConvMap(mapE, mapB);
+
+  // Same maps when the buffers of the workspace are reused
+  Healpix_Map<double> outE, outB;
+  for (int i = 0; i < 2; i++) {
+    mapping.create_SheartoConvMap(mapE, mapB, outE, outB, workspace);
+    BOOST_CHECK_EQUAL(outE.Nside(), nside);
+    for (int it = 0; it < outE.Npix(); it++) {
+      BOOST_CHECK_CLOSE(outE[it] + 1., expected.first[it] + 1., 1e-9);
+      BOOST_CHECK_CLOSE(outB[it] + 1., expected.second[it] + 1., 1e-9);
+    }
+  }
+  workspace.release();
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
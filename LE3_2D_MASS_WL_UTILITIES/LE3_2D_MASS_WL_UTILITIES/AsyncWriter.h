@@ -0,0 +1,115 @@
+/**
+ * @file LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _ASYNCWRITER_H
+#define _ASYNCWRITER_H
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstddef>
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+/**
+ * @class AsyncWriter
+ * @brief Background thread writing the products while the next ones are computed
+ *
+ * The write tasks are run one after the other, in the order of submission, by a
+ * single thread. The tasks own the buffers they write (moved or shared into the
+ * task), so the caller can compute the next map at once. The queue is bounded:
+ * submit blocks while maxPending tasks are waiting, which limits the memory held
+ * by the finished buffers. The first exception thrown by a task is rethrown by
+ * the next call to submit or wait, the tasks still queued being dropped.
+ */
+class AsyncWriter {
+
+public:
+
+  /**
+   * @brief Constructor: starts the writer thread
+   * @param[in] <maxPending> maximum number of tasks waiting to be run (at least 1)
+   */
+  explicit AsyncWriter(size_t maxPending = 2);
+
+  /**
+   * @brief Destructor: runs the pending tasks then stops the writer thread,
+   *        an error not yet reported being logged
+   */
+  virtual ~AsyncWriter();
+
+  AsyncWriter(const AsyncWriter&) = delete;
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+  /**
+   * @brief queues a write task, blocking while the queue is full
+   * @param[in] <task> task to run in the writer thread
+   */
+  void submit(std::function<void()> task);
+
+  /**
+   * @brief blocks until all the submitted tasks are run, rethrows the first error of the tasks
+   */
+  void wait();
+
+  /**
+   * @brief returns the maximum number of tasks waiting to be run
+   */
+  size_t getMaxPending() const;
+
+private:
+
+  /**
+   * @brief loop of the writer thread
+   */
+  void run();
+
+  /**
+   * @brief rethrows and clears the error of the tasks, the lock on m_mutex being held
+   */
+  void rethrowError();
+
+  size_t m_maxPending;
+  std::deque<std::function<void()> > m_tasks;
+  /**
+   * @brief <m_busy>, true while the writer thread runs a task
+   */
+  bool m_busy;
+  bool m_stop;
+  std::exception_ptr m_error;
+  std::mutex m_mutex;
+  std::condition_variable m_taskReady;
+  std::condition_variable m_taskDone;
+  std::thread m_thread;
+};
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
+#endif
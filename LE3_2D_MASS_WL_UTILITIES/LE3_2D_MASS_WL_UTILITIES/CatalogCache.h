@@ -0,0 +1,146 @@
+/**
+ * @file LE3_2D_MASS_WL_UTILITIES/CatalogCache.h
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _CATALOGCACHE_H
+#define _CATALOGCACHE_H
+
+#include "ElementsKernel/Logging.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+/**
+ * @struct CatalogColumn
+ * @brief  read-only view on a column of a memory mapped catalog cache
+ */
+struct CatalogColumn {
+  const double* data;
+  size_t size;
+
+  const double* begin() const { return data; }
+  const double* end() const { return data + size; }
+  const double& operator[](size_t i) const { return data[i]; }
+  bool empty() const { return size == 0; }
+};
+
+/**
+ * @class CatalogCache
+ * @brief Columnar binary copy of a catalog, memory mapped when read
+ *
+ * The file starts with a header of one page (signature, version, number of
+ * rows and columns, catalog type, size and offset of each column) followed by
+ * the columns stored as contiguous native doubles, each starting on a page
+ * boundary. The columns are in the order of CatalogData::readShearCatalog.
+ * Mapping the file is almost free and concurrent jobs share its page cache.
+ */
+class CatalogCache {
+
+public:
+
+  /**
+   * @brief maximum number of columns in a cache file
+   */
+  static const size_t maxColumns = 16;
+
+  /**
+   * @brief Constructor: maps the given cache file
+   * @param[in] <filename> name of the cache file
+   */
+  explicit CatalogCache(const std::string& filename);
+
+  /**
+   * @brief Destructor: unmaps the cache file
+   */
+  virtual ~CatalogCache();
+
+  CatalogCache(const CatalogCache&) = delete;
+  CatalogCache& operator=(const CatalogCache&) = delete;
+
+ /**
+  * @brief         writes catalog data in a cache file
+  * @param[in]     <filename> name of the cache file
+  * @param[in]     <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise,
+  *                the non-empty columns holding the same number of rows
+  * @param[in]     <catType> type of the shear catalog (e.g. LENSMC)
+ */
+  static void writeCache(const std::string& filename, const std::vector<std::vector<double> >& data,
+                         const std::string& catType);
+
+ /**
+  * @brief         checks whether the given file is a catalog cache
+ */
+  static bool isCatalogCache(const std::string& filename);
+
+ /**
+  * @brief    returns the number of rows of the catalog
+ */
+  size_t getNbRows() const;
+
+ /**
+  * @brief    returns the number of columns of the catalog
+ */
+  size_t getNbColumns() const;
+
+ /**
+  * @brief    returns the type of the shear catalog
+ */
+  std::string getCatalogType() const;
+
+ /**
+  * @brief    returns a view on the mapped column (no copy)
+  * @param[in] <index> index of the column
+ */
+  CatalogColumn getColumn(size_t index) const;
+
+ /**
+  * @brief    copies the columns in vectors, for the methods working on std::vector
+  * @param[in] <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+  * @param[in] <columns> bit mask of the columns to copy (bit i for column i), the others are left empty
+ */
+  void getData(std::vector<std::vector<double> >& data, unsigned int columns = ~0u) const;
+
+private:
+  /**
+   * @brief    The address and size of the mapping
+   */
+  void* m_mapping;
+  size_t m_mappingSize;
+  /**
+   * @brief    The columns in the mapping
+   */
+  std::vector<CatalogColumn> m_columns;
+  std::string m_catType;
+  size_t m_nbRows;
+
+};  // End of CatalogCache class
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
+#endif
@@ -25,10 +25,12 @@
 #define _CATALOGDATA_H
 
 #include <vector>
+#include <functional>
 #include <cstdio>
 #include <iostream>
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
 #include "LE3_2D_MASS_WL_UTILITIES/DmInput.h"
+#include "LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h"
 #include <boost/filesystem.hpp>
 #include "ElementsKernel/Logging.h"
 
@@ -69,6 +71,13 @@ public:
   * @param[in]     <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
  */
   void getCatalogData(fs::path& workdir, fs::path& InCatalog, std::vector<std::vector<double> >& data);
+
+ /**
+  * @brief         read the XML catalog product and store the name and type of its FITS catalog
+  * @param[in]     <workdir> <boost::filesystem::path> work directory
+  * @param[in]     <InCatalog> <boost::filesystem::path> Input XML product name
+ */
+  void readCatalogProduct(fs::path& workdir, fs::path& InCatalog);
   //std::vector<std::vector<double> > getCatalogData(fs::path& workdir, fs::path& InCatalog);
 
  /**
@@ -89,10 +98,32 @@ public:
  /**
   * @brief         method to read the shear catalog and return data
   * @param[in]     <filename> It's the filename of the catalog
-  * @param[in]     <Cat_data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+  * @param[in]     <Cat_data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise,
+  *                the columns not selected by setColumns being empty
  */
   void readShearCatalog(const std::string& filename, std::vector<std::vector<double> >& Cat_Data);
 
+ /**
+  * @brief         method to read the shear catalog into a column-wise catalog, in double or float
+  *                precision; the columns not selected by setColumns and the optional columns
+  *                (kappa, correction) missing from the file are absent from the catalog
+  * @param[in]     <filename> It's the filename of the catalog
+  * @param[in]     <catalog> <ShearCatalog> catalog read
+ */
+  void readShearCatalog(const std::string& filename, ShearCatalog<double>& catalog);
+  void readShearCatalog(const std::string& filename, ShearCatalog<float>& catalog);
+
+ /**
+  * @brief         method to read the shear catalog by chunks of at most chunkRows rows
+  * @param[in]     <filename> It's the filename of the catalog
+  * @param[in]     <chunkRows> maximum number of rows per chunk
+  * @param[in]     <processChunk> function called on each chunk with its data (same columns as
+  *                readShearCatalog) and the index of its first row
+  * @return        the number of rows in the catalog
+ */
+  long readShearCatalogChunks(const std::string& filename, long chunkRows,
+                  const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk);
+
  /**
   * @brief    The parameter which returns the type of input shear catalog used
  */
@@ -103,6 +134,17 @@ public:
  */
   std::string getCatalogFitsName();
 
+ /**
+  * @brief    Select the columns (ShearColumns flags) read from the shear catalog, the columns not
+  *           selected are not read and left empty in the catalog data
+ */
+  void setColumns(unsigned int columns);
+
+ /**
+  * @brief    The parameter which returns the columns read from the shear catalog
+ */
+  unsigned int getColumns();
+
 private:
  /**
   * @brief    The parameter which stores the type of input shear catalog used
@@ -112,6 +154,10 @@ private:
   * @brief    The parameter which stores the input catalog name
  */
   std::string m_inputCatalog;
+ /**
+  * @brief    The parameter which stores the columns read from the shear catalog
+ */
+  unsigned int m_columns;
 
 };  // End of CatalogData class
 } /* namespace TwoDMass */
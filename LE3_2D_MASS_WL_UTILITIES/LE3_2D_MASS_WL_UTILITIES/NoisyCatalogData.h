@@ -25,6 +25,7 @@
 #define _NOISYCATALOGDATA_H
 
 #include "ElementsKernel/Logging.h"
+#include "LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h"
 #include <vector>
 #include <cstdlib>
 #include <iostream>
@@ -59,6 +60,15 @@ public:
  */
  std::vector<std::vector<double> > create_noisy_data(std::vector<std::vector<double> > inputData);
 
+ /**
+  * @brief         method to create noisy catalog data without copying the catalog
+  * @param[in]     <inputData> view on the catalog
+  * @param[in]     <noisyShear> catalog holding the randomised g1 and g2 columns, reused between calls
+  * @return        view on the input catalog with its shear replaced by the randomised one
+ */
+ template <typename T>
+ ShearCatalogView<T> create_noisy_data(const ShearCatalogView<T>& inputData, ShearCatalog<T>& noisyShear);
+
 private:
 
 };  // End of NoisyCatalogData class
@@ -33,6 +33,7 @@
 
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
 #include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogCache.h"
 #include "ElementsKernel/ProgramHeaders.h"
 
 namespace Euclid {
@@ -66,20 +67,74 @@ public:
  /**
   * @brief         method returns the shear catalog data
   * @param[in]     <workdir> It's the working directory
-  * @param[in]     <catalogName> It's the filename of the catalog
-  * @param[in]     <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+  * @param[in]     <catalogName> It's the filename of the catalog (fits or catalog cache) or of its product (xml)
+  * @param[in]     <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise,
+  *                only the columns selected by setColumns being filled
  */
   void readShearCatalog(fs::path& workdir, fs::path& catalogName, std::vector < std::vector < double> >& data);
 
+ /**
+  * @brief         method returns the shear catalog as a column-wise catalog in double or float precision,
+  *                only the columns selected by setColumns and present in the file being allocated
+  * @param[in]     <workdir> It's the working directory
+  * @param[in]     <catalogName> It's the filename of the catalog (fits or catalog cache) or of its product (xml)
+  * @param[in]     <catalog> <ShearCatalog> catalog read
+ */
+  void readShearCatalog(fs::path& workdir, fs::path& catalogName, ShearCatalog<double>& catalog);
+  void readShearCatalog(fs::path& workdir, fs::path& catalogName, ShearCatalog<float>& catalog);
+
+ /**
+  * @brief         converts the shear catalog once into a memory mappable catalog cache,
+  *                always with all its columns
+  * @param[in]     <workdir> It's the working directory
+  * @param[in]     <catalogName> It's the filename of the catalog (fits) or of its product (xml)
+  * @param[in]     <cacheName> It's the filename of the catalog cache to write
+ */
+  void writeCatalogCache(fs::path& workdir, fs::path& catalogName, const std::string& cacheName);
+
+ /**
+  * @brief         method reads the shear catalog by chunks of rows, with bounded memory
+  * @param[in]     <workdir> It's the working directory
+  * @param[in]     <catalogName> It's the filename of the catalog cache, catalog (fits) or of its product (xml)
+  * @param[in]     <chunkRows> maximum number of rows per chunk
+  * @param[in]     <processChunk> function called on each chunk with its data in vectors column-wise
+  *                and the index of its first row
+  * @return        the number of rows in the catalog
+ */
+  long readShearCatalogChunks(fs::path& workdir, fs::path& catalogName, long chunkRows,
+                  const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk);
+
  /**
   * @brief    The parameter which returns the type of input shear catalog used
  */
   std::string getCatalogReadType();
+
+ /**
+  * @brief    Select the columns (ShearColumns flags) read from the shear catalog, the columns not
+  *           selected are left empty in the catalog data
+ */
+  void setColumns(unsigned int columns);
 private:
+ /**
+  * @brief    reads the shear catalog (catalog cache, fits or xml product) into a column-wise catalog
+ */
+  template <typename T>
+  void readCatalogColumns(fs::path& workdir, fs::path& catalogName, ShearCatalog<T>& catalog);
+
+ /**
+  * @brief    reads the mapped columns of a catalog cache by chunks of rows, as readShearCatalogChunks
+ */
+  long readCacheChunks(const CatalogCache& cache, long chunkRows,
+                       const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk);
+
  /**
   * @brief    The parameter which stores the type of input shear catalog used
  */
   std::string m_catalogType;
+ /**
+  * @brief    The parameter which stores the columns read from the shear catalog
+ */
+  unsigned int m_columns;
 
 };  // End of ReadCatalog class
 
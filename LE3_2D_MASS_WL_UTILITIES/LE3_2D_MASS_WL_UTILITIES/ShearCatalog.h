@@ -0,0 +1,272 @@
+/**
+ * @file LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _SHEARCATALOG_H
+#define _SHEARCATALOG_H
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+/**
+ * @brief  Columns of the shear catalog data as bit flags, the data vectors being in the order
+ *         ra, dec, kappa, g1, g2, z, weight, correction
+ */
+enum ShearColumns : unsigned int {
+  RA_COLUMN = 1u << 0,
+  DEC_COLUMN = 1u << 1,
+  KAPPA_COLUMN = 1u << 2,
+  G1_COLUMN = 1u << 3,
+  G2_COLUMN = 1u << 4,
+  Z_COLUMN = 1u << 5,
+  WEIGHT_COLUMN = 1u << 6,
+  CORRECTION_COLUMN = 1u << 7,
+  ALL_COLUMNS = 0xFFu
+};
+
+/**
+ * @brief  Allocator returning memory aligned on a cache line, so that the
+ *         catalog columns can be processed by vectorised loops
+ */
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+  typedef T value_type;
+  template <typename U> struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+  AlignedAllocator() = default;
+  template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  T* allocate(size_t n) {
+    void* p = nullptr;
+    if (posix_memalign(&p, Alignment, n*sizeof(T) > 0 ? n*sizeof(T) : Alignment) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+  void deallocate(T* p, size_t) { free(p); }
+
+  template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+  template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+/**
+ * @class ShearCatalogView
+ * @brief read-only view on a range of rows of a ShearCatalog, without copy
+ *
+ * The columns are plain pointers, null for the columns absent from the
+ * catalog: the row accessors then return the default value of the column
+ * (0 for kappa, 1 for weight and correction).
+ */
+template <typename T>
+class ShearCatalogView {
+
+public:
+  static const size_t nbColumns = 8;
+
+  ShearCatalogView(): m_size(0) { m_columns.fill(nullptr); }
+  ShearCatalogView(const std::array<const T*, nbColumns>& columns, size_t size):
+    m_columns(columns), m_size(size) {}
+
+  /**
+   * @brief    number of rows of the view
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * @brief    first element of the column (ShearColumns flag), nullptr if the column is absent
+   */
+  const T* data(ShearColumns column) const { return m_columns[columnIndex(column)]; }
+
+  T ra(size_t i) const { return m_columns[0][i]; }
+  T dec(size_t i) const { return m_columns[1][i]; }
+  T kappa(size_t i) const { return m_columns[2] ? m_columns[2][i] : T(0); }
+  T g1(size_t i) const { return m_columns[3][i]; }
+  T g2(size_t i) const { return m_columns[4][i]; }
+  T z(size_t i) const { return m_columns[5][i]; }
+  T weight(size_t i) const { return m_columns[6] ? m_columns[6][i] : T(1); }
+  T correction(size_t i) const { return m_columns[7] ? m_columns[7][i] : T(1); }
+
+  /**
+   * @brief    view on the rows [first, first+count) of this view
+   */
+  ShearCatalogView slice(size_t first, size_t count) const {
+    std::array<const T*, nbColumns> columns;
+    for (size_t i = 0; i < nbColumns; i++) {
+      columns[i] = m_columns[i] ? m_columns[i] + first : nullptr;
+    }
+    return ShearCatalogView(columns, count);
+  }
+
+  /**
+   * @brief    same view with the shear columns replaced, e.g. by noisy realisations
+   */
+  ShearCatalogView withShear(const T* g1, const T* g2) const {
+    ShearCatalogView view(*this);
+    view.m_columns[3] = g1;
+    view.m_columns[4] = g2;
+    return view;
+  }
+
+  /**
+   * @brief    index of a column (ShearColumns flag) in the column order
+   */
+  static size_t columnIndex(ShearColumns column) {
+    size_t index = 0;
+    while (index < nbColumns && (column & (1u << index)) == 0) {
+      index++;
+    }
+    return index;
+  }
+
+private:
+  std::array<const T*, nbColumns> m_columns;
+  size_t m_size;
+};
+
+/**
+ * @brief  view without copy on the data of CatalogData::readShearCatalog, its empty columns being absent
+ * @param[in] <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+ */
+inline ShearCatalogView<double> makeShearCatalogView(const std::vector<std::vector<double> >& data) {
+  std::array<const double*, ShearCatalogView<double>::nbColumns> columns;
+  columns.fill(nullptr);
+  size_t size = 0;
+  for (size_t i = 0; i < columns.size() && i < data.size(); i++) {
+    if (data[i].empty() == false) {
+      columns[i] = data[i].data();
+      size = data[i].size();
+    }
+  }
+  return ShearCatalogView<double>(columns, size);
+}
+
+/**
+ * @class ShearCatalog
+ * @brief Shear catalog stored column-wise (structure of arrays)
+ *
+ * Each column is contiguous and aligned on a cache line, in double or float
+ * precision. The optional columns (kappa, weight, correction) are not
+ * allocated when the survey does not provide them. Subsets of contiguous
+ * rows are accessed through views without copying the columns.
+ */
+template <typename T>
+class ShearCatalog {
+
+public:
+  typedef std::vector<T, AlignedAllocator<T> > Column;
+  typedef ShearCatalogView<T> View;
+  static const size_t nbColumns = View::nbColumns;
+
+  /**
+   * @brief    Empty catalog
+   */
+  ShearCatalog();
+
+  /**
+   * @brief    Catalog of nbRows rows with the given columns (ShearColumns flags), initialised to 0
+   */
+  ShearCatalog(size_t nbRows, unsigned int columns);
+
+  /**
+   * @brief    Catalog converted from the data of CatalogData::readShearCatalog, its empty columns being absent
+   * @param[in] <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+   */
+  explicit ShearCatalog(const std::vector<std::vector<double> >& data);
+
+  virtual ~ShearCatalog() = default;
+
+  /**
+   * @brief    number of rows
+   */
+  size_t size() const;
+
+  /**
+   * @brief    changes the number of rows of all the present columns
+   */
+  void resize(size_t nbRows);
+
+  /**
+   * @brief    the present columns as ShearColumns flags
+   */
+  unsigned int getColumns() const;
+
+  /**
+   * @brief    true if the column (ShearColumns flag) is present
+   */
+  bool hasColumn(ShearColumns column) const;
+
+  /**
+   * @brief    allocates an absent column, filled with value
+   */
+  void addColumn(ShearColumns column, T value = T(0));
+
+  /**
+   * @brief    releases the memory of a column
+   */
+  void removeColumn(ShearColumns column);
+
+  /**
+   * @brief    access to a present column, throws if the column is absent
+   */
+  Column& column(ShearColumns column);
+  const Column& column(ShearColumns column) const;
+
+  /**
+   * @brief    view on all the rows
+   */
+  View view() const;
+
+  /**
+   * @brief    view on the rows [first, first+count)
+   */
+  View view(size_t first, size_t count) const;
+
+  /**
+   * @brief    copy of the selected rows, in the given order
+   * @param[in] <rows> indices of the rows to copy
+   */
+  ShearCatalog select(const std::vector<size_t>& rows) const;
+
+  /**
+   * @brief    converts to the data of CatalogData::readShearCatalog, the absent columns being empty
+   * @param[in] <data> <std::vector<std::vector<double> > > data of catalog in vectors column-wise
+   */
+  void getData(std::vector<std::vector<double> >& data) const;
+
+private:
+  std::array<Column, nbColumns> m_columns;
+  unsigned int m_presentColumns;
+  size_t m_nbRows;
+};
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
+#endif
@@ -161,10 +161,22 @@ namespace Euclid {
  */
   std::string getColName(std::vector<std::string>& colname, std::string substring);
 
+  /**
+  @brief  This method reads the healpix maps of a Fits BinTable, in float32 or float64 and with implicit
+          (full sky) or explicit (partial sky, INDXSCHM=EXPLICIT with a PIXEL column) indexing, the pixels
+          absent from a partial sky map being 0
+  @param  <filename> name of the map in fits format
+  @param  <colnames> column names of the maps (output), without the PIXEL column of the explicit indexing
+  @retun  the maps in the order of the columns
+  */
+  std::vector<Healpix_Map<double> > readHealpixMaps(const std::string& filename, std::vector<std::string>& colnames);
+
   /**
   @brief  This method read input fitsfile that contain Healpix Map information
+          (shear, convergence or visibility mask, see readHealpixMaps for the supported layouts)
   @param  <Map> name of the input fits file
-  @retun  <mapE, mapB> map in healpix format
+  @retun  <mapE, mapB> map in healpix format: GAMMA1/GAMMA2 or KAPPA_E/KAPPA_B, or for a visibility mask
+          the pixel indices and the WEIGHT column
   */
   std::pair<Healpix_Map<double>, Healpix_Map<double> > readHealpixMap(const std::string &Map);
 
@@ -195,6 +207,10 @@ namespace Euclid {
                                    0x3D, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
                                    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
                                    0x20, 0x20, 0x20, 0x20, 0x20, 0x54};
+ /**
+  *@brief  catalog cache file signature (see CatalogCache) to detect file type
+ */
+ const std::vector<char> signCatalogCache = {0x4C, 0x45, 0x33, 0x57, 0x4C, 0x43, 0x41, 0x54};
  /**
   *@brief  normalisation for different scale map
  */
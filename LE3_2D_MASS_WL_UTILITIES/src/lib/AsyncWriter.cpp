@@ -0,0 +1,122 @@
+/**
+ * @file src/lib/AsyncWriter.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h"
+#include "ElementsKernel/Logging.h"
+#include <utility>
+
+static Elements::Logging logger = Elements::Logging::getLogger("AsyncWriter");
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+AsyncWriter::AsyncWriter(size_t maxPending):
+  m_maxPending(maxPending > 0 ? maxPending : 1), m_busy(false), m_stop(false) {
+  m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_taskReady.notify_all();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  if (m_error) {
+    try {
+      std::rethrow_exception(m_error);
+    } catch (const std::exception& e) {
+      logger.error() << "Product not written: " << e.what();
+    } catch (...) {
+      logger.error() << "Product not written: unknown error";
+    }
+  }
+}
+
+void AsyncWriter::submit(std::function<void()> task) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_taskDone.wait(lock, [this] { return m_tasks.size() < m_maxPending || m_error; });
+  rethrowError();
+  m_tasks.push_back(std::move(task));
+  lock.unlock();
+  m_taskReady.notify_one();
+}
+
+void AsyncWriter::wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_taskDone.wait(lock, [this] { return (m_tasks.empty() && !m_busy) || m_error; });
+  rethrowError();
+}
+
+size_t AsyncWriter::getMaxPending() const {
+  return m_maxPending;
+}
+
+void AsyncWriter::rethrowError() {
+  if (m_error) {
+    std::exception_ptr error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncWriter::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_taskReady.wait(lock, [this] { return !m_tasks.empty() || m_stop; });
+    if (m_tasks.empty()) {
+      break;
+    }
+    std::function<void()> task = std::move(m_tasks.front());
+    m_tasks.pop_front();
+    m_busy = true;
+    lock.unlock();
+    // Frees the slot of the task in the queue for the producer
+    m_taskDone.notify_all();
+    std::exception_ptr error;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // The buffers owned by the task are released before the next one is run
+    task = nullptr;
+    lock.lock();
+    m_busy = false;
+    if (error) {
+      if (!m_error) {
+        m_error = error;
+      }
+      m_tasks.clear();
+    }
+    m_taskDone.notify_all();
+  }
+}
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
@@ -0,0 +1,193 @@
+/**
+ * @file src/lib/CatalogCache.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogCache.h"
+#include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "ElementsKernel/Exception.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static Elements::Logging logger = Elements::Logging::getLogger("CatalogCache");
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+namespace {
+ const uint32_t cacheVersion = 1;
+ // Header and columns start on page boundaries so that the columns are SIMD aligned once mapped
+ const uint64_t cachePageSize = 4096;
+
+ struct CatalogCacheHeader {
+  char signature[8];
+  uint32_t version;
+  uint32_t nbColumns;
+  uint64_t nbRows;
+  char catType[32];
+  uint64_t columnSize[CatalogCache::maxColumns];
+  uint64_t columnOffset[CatalogCache::maxColumns];
+ };
+ static_assert(sizeof(CatalogCacheHeader) <= cachePageSize, "catalog cache header larger than a page");
+
+ uint64_t alignToPage(uint64_t offset) {
+  return (offset + cachePageSize - 1)/cachePageSize*cachePageSize;
+ }
+}
+
+CatalogCache::CatalogCache(const std::string& filename): m_mapping(nullptr), m_mappingSize(0), m_nbRows(0) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Elements::Exception() << "Catalog cache " << filename << " cannot be opened";
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || size_t(fileStat.st_size) < sizeof(CatalogCacheHeader)) {
+    close(fd);
+    throw Elements::Exception() << "Catalog cache " << filename << " is truncated";
+  }
+  m_mappingSize = fileStat.st_size;
+  m_mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m_mapping == MAP_FAILED) {
+    m_mapping = nullptr;
+    throw Elements::Exception() << "Catalog cache " << filename << " cannot be mapped";
+  }
+
+  const CatalogCacheHeader* header = static_cast<const CatalogCacheHeader*>(m_mapping);
+  bool valid = std::equal(signCatalogCache.begin(), signCatalogCache.end(), header->signature)
+               && header->version == cacheVersion && header->nbColumns <= maxColumns;
+  // every non-empty column holds exactly one value per row and lies inside the file
+  for (uint32_t i = 0; valid && i < header->nbColumns; i++) {
+    valid = (header->columnSize[i] == 0 || header->columnSize[i] == header->nbRows)
+            && header->columnOffset[i] <= m_mappingSize
+            && header->columnSize[i] <= (m_mappingSize - header->columnOffset[i])/sizeof(double);
+  }
+  if (valid == false) {
+    munmap(m_mapping, m_mappingSize);
+    m_mapping = nullptr;
+    throw Elements::Exception() << "File " << filename << " is not a valid catalog cache";
+  }
+
+  m_nbRows = header->nbRows;
+  m_catType = std::string(header->catType, strnlen(header->catType, sizeof(header->catType)));
+  const char* base = static_cast<const char*>(m_mapping);
+  for (uint32_t i = 0; i < header->nbColumns; i++) {
+    m_columns.push_back(CatalogColumn{reinterpret_cast<const double*>(base + header->columnOffset[i]),
+                                      size_t(header->columnSize[i])});
+  }
+  logger.info() << "Mapped catalog cache " << filename << " with " << m_nbRows << " rows";
+}
+
+CatalogCache::~CatalogCache() {
+  if (m_mapping != nullptr) {
+    munmap(m_mapping, m_mappingSize);
+  }
+}
+
+void CatalogCache::writeCache(const std::string& filename, const std::vector<std::vector<double> >& data,
+                              const std::string& catType) {
+  if (data.size() > maxColumns) {
+    throw Elements::Exception() << "Too many columns (" << data.size() << ") for a catalog cache";
+  }
+  CatalogCacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::copy(signCatalogCache.begin(), signCatalogCache.end(), header.signature);
+  header.version = cacheVersion;
+  header.nbColumns = data.size();
+  header.nbRows = 0;
+  for (size_t i = 0; i < data.size(); i++) {
+    if (data[i].empty() == false && header.nbRows == 0) {
+      header.nbRows = data[i].size();
+    }
+    if (data[i].empty() == false && data[i].size() != header.nbRows) {
+      throw Elements::Exception() << "Column " << i << " of the catalog has " << data[i].size()
+                                  << " values instead of " << header.nbRows;
+    }
+  }
+  std::strncpy(header.catType, catType.c_str(), sizeof(header.catType) - 1);
+  uint64_t offset = cachePageSize;
+  for (size_t i = 0; i < data.size(); i++) {
+    header.columnSize[i] = data[i].size();
+    header.columnOffset[i] = offset;
+    offset = alignToPage(offset + data[i].size()*sizeof(double));
+  }
+
+  std::ofstream file(filename, std::ofstream::binary | std::ofstream::trunc);
+  if (!file) {
+    throw Elements::Exception() << "Catalog cache " << filename << " cannot be created";
+  }
+  const std::vector<char> padding(cachePageSize, 0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(padding.data(), cachePageSize - sizeof(header));
+  for (size_t i = 0; i < data.size(); i++) {
+    uint64_t columnBytes = data[i].size()*sizeof(double);
+    file.write(reinterpret_cast<const char*>(data[i].data()), columnBytes);
+    file.write(padding.data(), alignToPage(columnBytes) - columnBytes);
+  }
+  if (!file) {
+    throw Elements::Exception() << "Catalog cache " << filename << " cannot be written";
+  }
+  logger.info() << "Catalog cache " << filename << " written with " << header.nbRows << " rows";
+}
+
+bool CatalogCache::isCatalogCache(const std::string& filename) {
+  return checkFileType(fs::path(filename), signCatalogCache);
+}
+
+size_t CatalogCache::getNbRows() const {
+  return m_nbRows;
+}
+
+size_t CatalogCache::getNbColumns() const {
+  return m_columns.size();
+}
+
+std::string CatalogCache::getCatalogType() const {
+  return m_catType;
+}
+
+CatalogColumn CatalogCache::getColumn(size_t index) const {
+  if (index >= m_columns.size()) {
+    throw Elements::Exception() << "Column " << index << " is not in the catalog cache";
+  }
+  return m_columns[index];
+}
+
+void CatalogCache::getData(std::vector<std::vector<double> >& data, unsigned int columns) const {
+  for (size_t i = 0; i < m_columns.size(); i++) {
+    if (columns & (1u << i)) {
+      data.emplace_back(m_columns[i].begin(), m_columns[i].end());
+    } else {
+      data.emplace_back();
+    }
+  }
+}
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
@@ -22,6 +22,9 @@
  */
 
 #include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
+#include "ElementsKernel/Exception.h"
+#include <fitsio.h>
+#include <algorithm>
 
 using namespace Euclid;
 using namespace FitsIO;
@@ -32,12 +35,114 @@ namespace Euclid {
  namespace WeakLensing {
   namespace TwoDMass {
 
-CatalogData::CatalogData(): m_catType("LENSMC") {}
-CatalogData::CatalogData(std::string catType): m_catType(catType) {}
+namespace {
+ // Opens the shear table of the catalog and finds the selected columns, colnum being 0 for the
+ // columns not selected and for the optional columns (kappa, correction) missing from the table
+ long openShearTable(const std::string& filename, const std::vector<std::string>& colname,
+                     unsigned int columns, fitsfile** fptr, int colnum[8]) {
+    int status = 0;
+    fits_open_file(fptr, filename.c_str(), READONLY, &status);
+    if (status != 0) {
+      throw Elements::Exception() << "Input catalog " << filename << " cannot be opened";
+    }
+
+    // Columns in the order of readShearCatalog, kappa and correction are optional
+    const std::string names[8] = {getColName(colname, "RA"), getColName(colname, "DEC"), "KAPPA",
+                                  getColName(colname, "G1"), getColName(colname, "G2"),
+                                  getColName(colname, "PHZ_MEDIAN"), getColName(colname, "WEIGHT"),
+                                  getColName(colname, "CORRECTION")};
+    int hduType = 0;
+    long nRows = 0;
+    fits_movabs_hdu(*fptr, 2, &hduType, &status);
+    fits_get_num_rows(*fptr, &nRows, &status);
+    for (int i = 0; i < 8; i++) {
+      colnum[i] = 0;
+      if ((columns & (1u << i)) == 0 || status != 0) {
+        continue;
+      }
+      int colStatus = 0;
+      fits_get_colnum(*fptr, CASESEN, const_cast<char*>(names[i].c_str()), &colnum[i], &colStatus);
+      if (colStatus != 0) {
+        colnum[i] = 0;
+        if (i != 2 && i != 7) {
+          fits_close_file(*fptr, &status);
+          throw Elements::Exception() << "Column " << names[i] << " not found in input catalog " << filename;
+        }
+      }
+    }
+    if (status != 0) {
+      status = 0;
+      fits_close_file(*fptr, &status);
+      throw Elements::Exception() << "No catalog table found in input catalog " << filename;
+    }
+    return nRows;
+ }
+
+ int fitsDataType(const float*) {
+   return TFLOAT;
+ }
+
+ int fitsDataType(const double*) {
+   return TDOUBLE;
+ }
+
+ // Reads the selected columns straight into the aligned columns of the catalog, in its precision
+ template <typename T>
+ void readShearTable(const std::string& filename, const std::string& catType, unsigned int columns,
+                     ShearCatalog<T>& catalog) {
+    fitsfile *fptr = nullptr;
+    int colnum[8];
+    long nRows = openShearTable(filename, getcolumnNames (catType), columns, &fptr, colnum);
+    unsigned int present = 0;
+    for (int i = 0; i < 8; i++) {
+      if (colnum[i] != 0) {
+        present |= 1u << i;
+      }
+    }
+    int status = 0;
+    try {
+      catalog = ShearCatalog<T>(nRows, present);
+      for (int i = 0; i < 8 && status == 0; i++) {
+        if (colnum[i] != 0 && nRows > 0) {
+          int anyNull = 0;
+          T* values = catalog.column(ShearColumns(1u << i)).data();
+          fits_read_col(fptr, fitsDataType(values), colnum[i], 1, 1, nRows, nullptr, values, &anyNull, &status);
+        }
+      }
+    } catch (...) {
+      status = 0;
+      fits_close_file(fptr, &status);
+      throw;
+    }
+    int closeStatus = 0;
+    fits_close_file(fptr, &closeStatus);
+    if (status != 0) {
+      throw Elements::Exception() << "Columns cannot be read from input catalog " << filename;
+    }
+ }
+}
+
+CatalogData::CatalogData(): m_catType("LENSMC"), m_columns(ALL_COLUMNS) {}
+CatalogData::CatalogData(std::string catType): m_catType(catType), m_columns(ALL_COLUMNS) {}
 
 //std::vector<std::vector<double> > CatalogData::getCatalogData(fs::path& workdir, fs::path& InCatalog) {
 void CatalogData::getCatalogData(fs::path& workdir, fs::path& InCatalog, std::vector<std::vector<double> >& data) {
+   readCatalogProduct(workdir, InCatalog);
+   if (false == m_inputCatalog.empty()) {
+     readCatalog(m_inputCatalog, data);
+     if (m_catType == "CLUSTER") {
+       logger.info("Done reading Input Cluster Catalog");
+     } else {
+       logger.info() << "Shear selection type: " << m_catType;
+       logger.info("Done reading Input Shear Catalog");
+     }
+   }
+ //return data;
+}
+
+void CatalogData::readCatalogProduct(fs::path& workdir, fs::path& InCatalog) {
    fs::path datadir {workdir / "data"};
+   m_inputCatalog.clear();
    // Case 1: When input catalog file is in XML format (fetch catalog filename from xml file)
    if (false == checkFileType(workdir /InCatalog, Euclid::WeakLensing::TwoDMass::signFITS)) {
     if (true == checkFileType(workdir /InCatalog, Euclid::WeakLensing::TwoDMass::signXML)) {
@@ -50,41 +155,26 @@ void CatalogData::getCatalogData(fs::path& workdir, fs::path& InCatalog, std::ve
        // Get fits Catalog filename
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
        m_catType = in_xml.getMethodType();
-       readCatalog(m_inputCatalog, data);
-       logger.info() << "Shear selection type: " << m_catType;
-       logger.info("Done reading Input Shear Catalog");
      } else if (true == fileHasField((workdir /InCatalog).native(), "DpdTwoDMassMomentsMLCatalog")) {
        logger.info() << "catalogue type: FITS: galaxies with MomentsML shear values";
        DmInput in_xml = DmInput::readMomentsMLCatalogXMLFile (workdir / InCatalog);
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
        m_catType = in_xml.getMethodType();
-       readCatalog(m_inputCatalog, data);
-       logger.info() << "Shear selection type: " << m_catType;
-       logger.info("Done reading Input Shear Catalog");
      } else if (true == fileHasField((workdir /InCatalog).native(), "DpdTwoDMassKSBCatalog")) {
        logger.info() << "catalogue type: FITS: galaxies with KSB shear values";
        DmInput in_xml = DmInput::readKSBCatalogXMLFile (workdir / InCatalog);
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
        m_catType = in_xml.getMethodType();
-       readCatalog(m_inputCatalog, data);
-       logger.info() << "Shear selection type: " << m_catType;
-       logger.info("Done reading Input Shear Catalog");
      } else if (true == fileHasField((workdir /InCatalog).native(), "DpdTwoDMassRegaussCatalog")) {
        logger.info() << "catalogue type: FITS: galaxies with Regauss shear values";
        DmInput in_xml = DmInput::readRegaussCatalogXMLFile (workdir / InCatalog);
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
        m_catType = in_xml.getMethodType();
-       readCatalog(m_inputCatalog, data);
-       logger.info() << "Shear selection type: " << m_catType;
-       logger.info("Done reading Input Shear Catalog");
      } else if (true == fileHasField((workdir /InCatalog).native(), "DpdWLLE2Catalog")) {
        logger.info() << "catalogue type: FITS: galaxies with shear values";
        DmInput in_xml = DmInput::readLE2CatalogXMLFile (workdir / InCatalog);
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
        m_catType = (in_xml.getMethodType());
-       readCatalog(m_inputCatalog, data);
-       logger.info() << "Shear selection type: " << m_catType;
-       logger.info("Done reading Input Shear Catalog");
      } else if (true == fileHasField((workdir /InCatalog).native(), "DpdTwoDMassClusterCatalog")) {
        logger.info() << "catalogue type: FITS: galaxies clusters";
        m_catType = "CLUSTER";
@@ -92,13 +182,9 @@ void CatalogData::getCatalogData(fs::path& workdir, fs::path& InCatalog, std::ve
        DmInput in_xml = DmInput::readClusterCatalogXMLFile(workdir /InCatalog);
        // Get fits Catalog filename
        m_inputCatalog = (datadir /  in_xml.getFitsCatalogFilename()).string();
-       //data = readCatalog(m_inputCatalog);
-       readCatalog(m_inputCatalog, data);
-       logger.info("Done reading Input Cluster Catalog");
      }
     }
    }
- //return data;
 }
 
 void CatalogData::readClusterCatalog(const std::string& filename, std::vector<std::vector<double> >& Cat_Data) {
@@ -136,43 +222,92 @@ void CatalogData::readShearCatalog(const std::string& filename, std::vector<std:
       ext.renameColumn(getColName(incolname, "redshift"), getColName(colname, "PHZ_MEDIAN"));
       ext.renameColumn(getColName(incolname, "mask", "weight"), getColName(colname, "WEIGHT"));
     }*/
-    std::vector<std::string> upColname = ext.readColumnNames();
-    const auto gamma1 = ext.readColumn<double>(getColName(colname, "G1"));
-    const auto gamma2 = ext.readColumn<double>(getColName(colname, "G2"));
-    const auto weight = ext.readColumn<double>(getColName(colname, "WEIGHT"));
-    const auto phz_median = ext.readColumn<double>(getColName(colname, "PHZ_MEDIAN"));
-    const auto ra = ext.readColumn<double>(getColName(colname, "RA"));
-    const auto dec = ext.readColumn<double>(getColName(colname, "DEC"));
-//    logger.info() << "First value of SHE_LENSMC_UPDATED_RA = " << ra.vector()[0];
+    // Only the selected columns are read, the others are left empty so that the indices do not change
+    auto readSelected = [&](unsigned int column, const std::string& name) {
+      std::vector<double> values;
+      if (m_columns & column) {
+        auto col = ext.readColumn<double>(name);
+        values = std::move(col.vector());
+      }
+      return values;
+    };
+    auto fillSelected = [&](unsigned int column, double value) {
+      std::vector<double> values;
+      if (m_columns & column) {
+        values.assign(ext.readRowCount(), value);
+      }
+      return values;
+    };
 
-    Cat_Data.push_back(ra.vector());
-    Cat_Data.push_back(dec.vector());
+    Cat_Data.push_back(readSelected(RA_COLUMN, getColName(colname, "RA")));
+    Cat_Data.push_back(readSelected(DEC_COLUMN, getColName(colname, "DEC")));
     if (ext.hasColumn("KAPPA")) {
-      const auto kappa = ext.readColumn<double>("KAPPA");
-      Cat_Data.push_back(kappa.vector());
+      Cat_Data.push_back(readSelected(KAPPA_COLUMN, "KAPPA"));
     } else {
-      std::vector <double> kappa;
-      for (size_t it = 0; it < ra.vector().size(); it++) {
-        kappa.push_back(0.);
-      }
-      Cat_Data.push_back(kappa);
+      Cat_Data.push_back(fillSelected(KAPPA_COLUMN, 0.));
     }
-
-    Cat_Data.push_back(gamma1.vector());
-    Cat_Data.push_back(gamma2.vector());
-    Cat_Data.push_back(phz_median.vector());
-    Cat_Data.push_back(weight.vector());
-
+    Cat_Data.push_back(readSelected(G1_COLUMN, getColName(colname, "G1")));
+    Cat_Data.push_back(readSelected(G2_COLUMN, getColName(colname, "G2")));
+    Cat_Data.push_back(readSelected(Z_COLUMN, getColName(colname, "PHZ_MEDIAN")));
+    Cat_Data.push_back(readSelected(WEIGHT_COLUMN, getColName(colname, "WEIGHT")));
     if (ext.hasColumn(getColName(colname, "CORRECTION"))) {
-      const auto phz_correction = ext.readColumn<double>(getColName(colname, "CORRECTION"));
-      Cat_Data.push_back(phz_correction.vector());
+      Cat_Data.push_back(readSelected(CORRECTION_COLUMN, getColName(colname, "CORRECTION")));
     } else {
-      std::vector <double> phz_correction;
-      for (size_t it = 0; it < ra.vector().size(); it++) {
-        phz_correction.push_back(1.);
+      Cat_Data.push_back(fillSelected(CORRECTION_COLUMN, 1.));
+    }
+}
+
+void CatalogData::readShearCatalog(const std::string& filename, ShearCatalog<double>& catalog) {
+    readShearTable(filename, m_catType, m_columns, catalog);
+}
+
+void CatalogData::readShearCatalog(const std::string& filename, ShearCatalog<float>& catalog) {
+    readShearTable(filename, m_catType, m_columns, catalog);
+}
+
+long CatalogData::readShearCatalogChunks(const std::string& filename, long chunkRows,
+                  const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk) {
+    if (chunkRows <= 0) {
+      throw Elements::Exception() << "Invalid number of rows per chunk: " << chunkRows;
+    }
+    fitsfile *fptr = nullptr;
+    int colnum[8];
+    long nRows = openShearTable(filename, getcolumnNames (m_catType), m_columns, &fptr, colnum);
+    const double defaultValues[8] = {0., 0., 0., 0., 0., 0., 0., 1.};
+    int status = 0;
+
+    // The chunk buffers are reused: memory stays bounded by chunkRows whatever the catalog size,
+    // the columns not selected are left empty
+    std::vector<std::vector<double> > chunk(8);
+    try {
+      for (long firstRow = 0; firstRow < nRows; firstRow += chunkRows) {
+        long nbRows = std::min(chunkRows, nRows - firstRow);
+        for (int i = 0; i < 8; i++) {
+          if ((m_columns & (1u << i)) == 0) {
+            continue;
+          }
+          chunk[i].resize(nbRows);
+          if (colnum[i] == 0) {
+            std::fill(chunk[i].begin(), chunk[i].end(), defaultValues[i]);
+          } else {
+            int anyNull = 0;
+            fits_read_col(fptr, TDOUBLE, colnum[i], firstRow + 1, 1, nbRows, nullptr,
+                          chunk[i].data(), &anyNull, &status);
+          }
+        }
+        if (status != 0) {
+          throw Elements::Exception() << "Rows " << firstRow << " to " << firstRow + nbRows - 1
+                                      << " cannot be read from input catalog " << filename;
+        }
+        processChunk(chunk, firstRow);
       }
-      Cat_Data.push_back(phz_correction);
+    } catch (...) {
+      status = 0;
+      fits_close_file(fptr, &status);
+      throw;
     }
+    fits_close_file(fptr, &status);
+    return nRows;
 }
 
 //std::vector<std::vector<double> > CatalogData::readCatalog(const std::string& filename) {
@@ -201,6 +336,14 @@ std::string CatalogData::getCatalogFitsName() {
   return m_inputCatalog;
 }
 
+void CatalogData::setColumns(unsigned int columns) {
+  m_columns = columns;
+}
+
+unsigned int CatalogData::getColumns() {
+  return m_columns;
+}
+
 } /* namespace TwoDMass */
 } /* namespace WeakLensing */
 } /* namespace Euclid */
@@ -62,6 +62,35 @@ namespace Euclid {
    return Output;
   }
 
+  template <typename T>
+  ShearCatalogView<T> NoisyCatalogData::create_noisy_data(const ShearCatalogView<T>& inputData,
+                                                          ShearCatalog<T>& noisyShear){
+   size_t galCount = inputData.size();
+   if (noisyShear.size() != galCount || noisyShear.getColumns() != (G1_COLUMN | G2_COLUMN)) {
+     noisyShear = ShearCatalog<T>(galCount, G1_COLUMN | G2_COLUMN);
+   }
+   const T* gamma1 = inputData.data(G1_COLUMN);
+   const T* gamma2 = inputData.data(G2_COLUMN);
+   T* gamma1_n = noisyShear.column(G1_COLUMN).data();
+   T* gamma2_n = noisyShear.column(G2_COLUMN).data();
+
+   // Same draws as the vector version, so that both give the same realisations
+   for (size_t i = 0; i < galCount; i++){
+    float theta, radius, temp;
+    temp = pow(gamma1[i], 2) + pow(gamma2[i], 2);
+    radius = sqrt(temp);
+    theta = M_PI * ((double) rand() / (RAND_MAX));
+    gamma1_n[i] = radius*cos(2*theta);
+    gamma2_n[i] = radius*sin(2*theta);
+   }
+   return inputData.withShear(gamma1_n, gamma2_n);
+  }
+
+  template ShearCatalogView<float> NoisyCatalogData::create_noisy_data(const ShearCatalogView<float>&,
+                                                                      ShearCatalog<float>&);
+  template ShearCatalogView<double> NoisyCatalogData::create_noisy_data(const ShearCatalogView<double>&,
+                                                                       ShearCatalog<double>&);
+
   } /* namespace TwoDMass */
  } /* namespace WeakLensing */
 } /* namespace Euclid */
@@ -22,6 +22,7 @@
  */
 
 #include "LE3_2D_MASS_WL_UTILITIES/ReadCatalog.h"
+#include <algorithm>
 
 namespace fs = boost::filesystem;
 using namespace Euclid::WeakLensing::TwoDMass;
@@ -32,8 +33,8 @@ namespace Euclid {
  namespace WeakLensing {
   namespace TwoDMass {
 
-ReadCatalog::ReadCatalog(): m_catalogType("LENSMC") {}
-ReadCatalog::ReadCatalog(std::string catType): m_catalogType(catType) {}
+ReadCatalog::ReadCatalog(): m_catalogType("LENSMC"), m_columns(ALL_COLUMNS) {}
+ReadCatalog::ReadCatalog(std::string catType): m_catalogType(catType), m_columns(ALL_COLUMNS) {}
 
 void ReadCatalog::readShearCatalog(fs::path& workdir, fs::path& catalogName,
                                  std::vector < std::vector < double> >& data) {
@@ -45,6 +46,16 @@ void ReadCatalog::readShearCatalog(fs::path& workdir, fs::path& catalogName,
    std::string inputCatalog;
    //std::vector<std::vector<double> > data;
    CatalogData galdata;
+   galdata.setColumns(m_columns);
+   // Catalog cache written by writeCatalogCache: mapped instead of parsed
+   if (true == fs::is_regular_file(datadir/catalogName) &&
+       true == CatalogCache::isCatalogCache((datadir/catalogName).string())) {
+     logger.info("Input Shear Catalog is a catalog cache..");
+     CatalogCache cache((datadir/catalogName).string());
+     cache.getData(data, m_columns);
+     m_catalogType = cache.getCatalogType();
+     return;
+   }
 // check whether input shear catalog file is in fits format(standalone) / XML(pipeline) and then fetch Catalogfile name
    if (true == checkFileType(datadir /catalogName, Euclid::WeakLensing::TwoDMass::signFITS)) {
     if (false == fs::exists(datadir/catalogName)) {
@@ -66,10 +77,139 @@ void ReadCatalog::readShearCatalog(fs::path& workdir, fs::path& catalogName,
  //return data;
 }
 
+void ReadCatalog::readShearCatalog(fs::path& workdir, fs::path& catalogName, ShearCatalog<double>& catalog) {
+   readCatalogColumns(workdir, catalogName, catalog);
+}
+
+void ReadCatalog::readShearCatalog(fs::path& workdir, fs::path& catalogName, ShearCatalog<float>& catalog) {
+   readCatalogColumns(workdir, catalogName, catalog);
+}
+
+template <typename T>
+void ReadCatalog::readCatalogColumns(fs::path& workdir, fs::path& catalogName, ShearCatalog<T>& catalog) {
+   if (true == catalogName.string().empty()) {
+     throw Elements::Exception() << "Input catalogue file name is not found . . . ";
+   }
+   fs::path datadir {workdir / "data"};
+   CatalogData galdata(m_catalogType);
+   galdata.setColumns(m_columns);
+   if (true == fs::is_regular_file(datadir/catalogName) &&
+       true == CatalogCache::isCatalogCache((datadir/catalogName).string())) {
+     logger.info("Input Shear Catalog is a catalog cache..");
+     CatalogCache cache((datadir/catalogName).string());
+     catalog = ShearCatalog<T>(cache.getNbRows(), 0);
+     for (size_t i = 0; i < cache.getNbColumns() && i < ShearCatalog<T>::nbColumns; i++) {
+       CatalogColumn column = cache.getColumn(i);
+       ShearColumns flag = ShearColumns(1u << i);
+       if ((m_columns & flag) && column.empty() == false) {
+         catalog.addColumn(flag);
+         std::copy(column.begin(), column.end(), catalog.column(flag).begin());
+       }
+     }
+     m_catalogType = cache.getCatalogType();
+     return;
+   }
+   std::string inputCatalog;
+   if (true == checkFileType(datadir /catalogName, Euclid::WeakLensing::TwoDMass::signFITS)) {
+     if (false == fs::exists(datadir/catalogName)) {
+       throw Elements::Exception() << "Input data product " << datadir/catalogName << " not found";
+     }
+     inputCatalog = (datadir /catalogName).string();
+   } else {
+     if (false == fs::exists(workdir/catalogName)) {
+       throw Elements::Exception() << "Input data product " << workdir/catalogName << " not found";
+     }
+     galdata.readCatalogProduct(workdir, catalogName);
+     inputCatalog = galdata.getCatalogFitsName();
+   }
+   m_catalogType = galdata.getCatalogType();
+   logger.info() << "Reading Input Shear Catalog " << inputCatalog << " of shear type " << m_catalogType;
+   galdata.readShearCatalog(inputCatalog, catalog);
+   logger.info() << "Done reading " << catalog.size() << " rows of Input Shear Catalog";
+}
+
+long ReadCatalog::readShearCatalogChunks(fs::path& workdir, fs::path& catalogName, long chunkRows,
+                  const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk) {
+   if (true == catalogName.string().empty()) {
+     throw Elements::Exception() << "Input catalogue file name is not found . . . ";
+   }
+   fs::path datadir {workdir / "data"};
+   if (true == fs::is_regular_file(datadir/catalogName) &&
+       true == CatalogCache::isCatalogCache((datadir/catalogName).string())) {
+     logger.info("Input Shear Catalog is a catalog cache..");
+     CatalogCache cache((datadir/catalogName).string());
+     m_catalogType = cache.getCatalogType();
+     return readCacheChunks(cache, chunkRows, processChunk);
+   }
+   std::string inputCatalog;
+   CatalogData galdata(m_catalogType);
+   galdata.setColumns(m_columns);
+   if (true == checkFileType(datadir /catalogName, Euclid::WeakLensing::TwoDMass::signFITS)) {
+     if (false == fs::exists(datadir/catalogName)) {
+       throw Elements::Exception() << "Input data product " << datadir/catalogName << " not found";
+     }
+     inputCatalog = (datadir /catalogName).string();
+   } else {
+     if (false == fs::exists(workdir/catalogName)) {
+       throw Elements::Exception() << "Input data product " << workdir/catalogName << " not found";
+     }
+     galdata.readCatalogProduct(workdir, catalogName);
+     inputCatalog = galdata.getCatalogFitsName();
+   }
+   m_catalogType = galdata.getCatalogType();
+   logger.info() << "Reading Input Shear Catalog " << inputCatalog << " by chunks of " << chunkRows << " rows";
+   long nRows = galdata.readShearCatalogChunks(inputCatalog, chunkRows, processChunk);
+   logger.info() << "Done reading " << nRows << " rows of Input Shear Catalog";
+   return nRows;
+}
+
+long ReadCatalog::readCacheChunks(const CatalogCache& cache, long chunkRows,
+                  const std::function<void(std::vector<std::vector<double> >&, long)>& processChunk) {
+   if (chunkRows <= 0) {
+     throw Elements::Exception() << "Invalid number of rows per chunk: " << chunkRows;
+   }
+   // same chunks as CatalogData::readShearCatalogChunks: the columns not selected are left empty and
+   // the columns missing from the cache get their default values
+   const long nRows = long(cache.getNbRows());
+   const double defaultValues[8] = {0., 0., 0., 0., 0., 0., 0., 1.};
+   std::vector<std::vector<double> > chunk(8);
+   for (long firstRow = 0; firstRow < nRows; firstRow += chunkRows) {
+     long nbRows = std::min(chunkRows, nRows - firstRow);
+     for (size_t i = 0; i < chunk.size(); i++) {
+       if ((m_columns & (1u << i)) == 0) {
+         continue;
+       }
+       chunk[i].resize(nbRows);
+       CatalogColumn column = i < cache.getNbColumns() ? cache.getColumn(i) : CatalogColumn{nullptr, 0};
+       if (column.empty()) {
+         std::fill(chunk[i].begin(), chunk[i].end(), defaultValues[i]);
+       } else {
+         std::copy(column.begin() + firstRow, column.begin() + firstRow + nbRows, chunk[i].begin());
+       }
+     }
+     processChunk(chunk, firstRow);
+   }
+   logger.info() << "Done reading " << nRows << " rows of Input Shear Catalog";
+   return nRows;
+}
+
+void ReadCatalog::writeCatalogCache(fs::path& workdir, fs::path& catalogName, const std::string& cacheName) {
+   std::vector<std::vector<double> > data;
+   unsigned int columns = m_columns;
+   m_columns = ALL_COLUMNS;
+   readShearCatalog(workdir, catalogName, data);
+   m_columns = columns;
+   CatalogCache::writeCache(cacheName, data, m_catalogType);
+}
+
 std::string ReadCatalog::getCatalogReadType() {
   return m_catalogType;
 }
 
+void ReadCatalog::setColumns(unsigned int columns) {
+  m_columns = columns;
+}
+
 } /* namespace TwoDMass */
 } /* namespace WeakLensing */
 } /* namespace Euclid */
@@ -0,0 +1,165 @@
+/**
+ * @file src/lib/ShearCatalog.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h"
+#include "ElementsKernel/Exception.h"
+#include <algorithm>
+
+namespace Euclid {
+ namespace WeakLensing {
+  namespace TwoDMass {
+
+template <typename T>
+ShearCatalog<T>::ShearCatalog(): m_presentColumns(0), m_nbRows(0) {}
+
+template <typename T>
+ShearCatalog<T>::ShearCatalog(size_t nbRows, unsigned int columns): m_presentColumns(0), m_nbRows(nbRows) {
+  for (size_t i = 0; i < nbColumns; i++) {
+    if (columns & (1u << i)) {
+      addColumn(ShearColumns(1u << i));
+    }
+  }
+}
+
+template <typename T>
+ShearCatalog<T>::ShearCatalog(const std::vector<std::vector<double> >& data): m_presentColumns(0), m_nbRows(0) {
+  for (size_t i = 0; i < nbColumns && i < data.size(); i++) {
+    if (data[i].empty() == false) {
+      if (m_presentColumns != 0 && data[i].size() != m_nbRows) {
+        throw Elements::Exception() << "Catalog columns of different sizes: "
+                                    << data[i].size() << " and " << m_nbRows;
+      }
+      m_nbRows = data[i].size();
+      m_columns[i].assign(data[i].begin(), data[i].end());
+      m_presentColumns |= 1u << i;
+    }
+  }
+}
+
+template <typename T>
+size_t ShearCatalog<T>::size() const {
+  return m_nbRows;
+}
+
+template <typename T>
+void ShearCatalog<T>::resize(size_t nbRows) {
+  for (size_t i = 0; i < nbColumns; i++) {
+    if (m_presentColumns & (1u << i)) {
+      m_columns[i].resize(nbRows);
+    }
+  }
+  m_nbRows = nbRows;
+}
+
+template <typename T>
+unsigned int ShearCatalog<T>::getColumns() const {
+  return m_presentColumns;
+}
+
+template <typename T>
+bool ShearCatalog<T>::hasColumn(ShearColumns column) const {
+  return (m_presentColumns & column) != 0;
+}
+
+template <typename T>
+void ShearCatalog<T>::addColumn(ShearColumns column, T value) {
+  size_t index = View::columnIndex(column);
+  if (index >= nbColumns) {
+    throw Elements::Exception() << "Unknown shear catalog column " << (unsigned int)column;
+  }
+  m_columns[index].assign(m_nbRows, value);
+  m_presentColumns |= column;
+}
+
+template <typename T>
+void ShearCatalog<T>::removeColumn(ShearColumns column) {
+  size_t index = View::columnIndex(column);
+  if (index < nbColumns) {
+    Column().swap(m_columns[index]);
+    m_presentColumns &= ~column;
+  }
+}
+
+template <typename T>
+typename ShearCatalog<T>::Column& ShearCatalog<T>::column(ShearColumns column) {
+  if (hasColumn(column) == false) {
+    throw Elements::Exception() << "Shear catalog column " << (unsigned int)column << " is absent";
+  }
+  return m_columns[View::columnIndex(column)];
+}
+
+template <typename T>
+const typename ShearCatalog<T>::Column& ShearCatalog<T>::column(ShearColumns column) const {
+  if (hasColumn(column) == false) {
+    throw Elements::Exception() << "Shear catalog column " << (unsigned int)column << " is absent";
+  }
+  return m_columns[View::columnIndex(column)];
+}
+
+template <typename T>
+typename ShearCatalog<T>::View ShearCatalog<T>::view() const {
+  return view(0, m_nbRows);
+}
+
+template <typename T>
+typename ShearCatalog<T>::View ShearCatalog<T>::view(size_t first, size_t count) const {
+  if (first + count > m_nbRows) {
+    throw Elements::Exception() << "Rows " << first << " to " << first + count
+                                << " out of a catalog of " << m_nbRows << " rows";
+  }
+  std::array<const T*, nbColumns> columns;
+  for (size_t i = 0; i < nbColumns; i++) {
+    columns[i] = (m_presentColumns & (1u << i)) ? m_columns[i].data() + first : nullptr;
+  }
+  return View(columns, count);
+}
+
+template <typename T>
+ShearCatalog<T> ShearCatalog<T>::select(const std::vector<size_t>& rows) const {
+  ShearCatalog<T> selection(rows.size(), m_presentColumns);
+  for (size_t i = 0; i < nbColumns; i++) {
+    if (m_presentColumns & (1u << i)) {
+      const T* in = m_columns[i].data();
+      T* out = selection.m_columns[i].data();
+      for (size_t row = 0; row < rows.size(); row++) {
+        out[row] = in[rows[row]];
+      }
+    }
+  }
+  return selection;
+}
+
+template <typename T>
+void ShearCatalog<T>::getData(std::vector<std::vector<double> >& data) const {
+  data.resize(nbColumns);
+  for (size_t i = 0; i < nbColumns; i++) {
+    data[i].assign(m_columns[i].begin(), m_columns[i].end());
+  }
+}
+
+template class ShearCatalog<float>;
+template class ShearCatalog<double>;
+
+} /* namespace TwoDMass */
+} /* namespace WeakLensing */
+} /* namespace Euclid */
@@ -22,8 +22,10 @@
  */
 
 #include "LE3_2D_MASS_WL_UTILITIES/Utils.h"
+#include "ElementsKernel/Exception.h"
 #include <deque>
 #include <iostream>
+#include <algorithm>
 
 using ST_DM_Schema::getDmSchemaFilePath;
 static Elements::Logging logger = Elements::Logging::getLogger("Utils");
@@ -214,35 +216,72 @@ std::string getColName(std::vector<std::string>& colname, std::string substring)
   return name;
 }
 
-std::pair<Healpix_Map<double>, Healpix_Map<double> > readHealpixMap(const std::string &Map) {
-  arr<double> myarrE;
-  arr<double> myarrB;
-
-  MefFile fitsFile(Map, MefFile::Permission::Read);
+std::vector<Healpix_Map<double> > readHealpixMaps(const std::string& filename, std::vector<std::string>& colnames) {
+  MefFile fitsFile(filename, MefFile::Permission::Read);
   const auto &ext = fitsFile.access<BintableHdu>(1);
-  const auto records = ext.parseAllRecords<boost::any>();
-  const auto Ttype1 = records.as<std::string>("TTYPE1");
-  const auto Ttype2 = records.as<std::string>("TTYPE2");
-  //read ordering from header
-  std::string ordering = records.as<std::string>("ORDERING");
-  //logger.info() << "ordering of map: " << std::string(ordering);
-  if (((Ttype1.value).compare("GAMMA1") == 0) || ((Ttype1.value).compare("KAPPA_E") == 0) ||
-       ((Ttype1.value).compare("PIXEL") == 0)) {
-   const auto mE = fitsFile.access<BintableHdu>(1).readColumn<double>(Ttype1);
-   myarrE.copyFrom(mE.vector());
+  const int nside = ext.parseRecord<int>("NSIDE").value;
+  const std::string ordering = ext.parseRecord<std::string>("ORDERING").value;
+  bool partialSky = false;
+  try {
+    partialSky = (ext.parseRecord<std::string>("INDXSCHM").value.compare("EXPLICIT") == 0);
+  } catch (const std::exception&) {
+    // maps without indexing scheme are full sky
   }
-  if (((Ttype2.value).compare("GAMMA2") == 0) || ((Ttype2.value).compare("KAPPA_B") == 0) ||
-       ((Ttype2.value).compare("WEIGHT") == 0)) {
-   const auto mB = fitsFile.access<BintableHdu>(1).readColumn<double>(Ttype2);
-   myarrB.copyFrom(mB.vector());
+
+  colnames = ext.readColumnNames();
+  std::vector<int> pixels;
+  if (partialSky) {
+    pixels = ext.readColumn<int>("PIXEL").vector();
+    colnames.erase(std::remove(colnames.begin(), colnames.end(), std::string("PIXEL")), colnames.end());
   }
 
-  Healpix_Map<double> mapE, mapB;
-  //mapE.Set(myarrE, RING);
-  //mapB.Set(myarrB, RING);
-  mapE.Set(myarrE, ordering=="RING" ? RING : NEST);
-  mapB.Set(myarrB, ordering=="RING" ? RING : NEST);
+  std::vector<Healpix_Map<double> > maps;
+  for (const std::string& colname : colnames) {
+    // float32 columns are converted on reading
+    const std::vector<double> values = ext.readColumn<double>(colname).vector();
+    Healpix_Map<double> map(nside, ordering == "NESTED" || ordering == "NEST" ? NEST : RING, SET_NSIDE);
+    if (partialSky) {
+      map.fill(0.);
+      for (size_t i = 0; i < pixels.size() && i < values.size(); i++) {
+        map[pixels[i]] = values[i];
+      }
+    } else {
+      if (values.size() != size_t(map.Npix())) {
+        throw Elements::Exception() << "Column " << colname << " of " << filename << " has " << values.size()
+                                    << " values for " << map.Npix() << " pixels";
+      }
+      for (size_t i = 0; i < values.size(); i++) {
+        map[int(i)] = values[i];
+      }
+    }
+    maps.push_back(std::move(map));
+  }
+  return maps;
+}
+
+std::pair<Healpix_Map<double>, Healpix_Map<double> > readHealpixMap(const std::string &Map) {
+  std::vector<std::string> colnames;
+  std::vector<Healpix_Map<double> > maps = readHealpixMaps(Map, colnames);
+  if (maps.empty()) {
+    throw Elements::Exception() << "No map in " << Map;
+  }
 
+  Healpix_Map<double> mapE, mapB;
+  for (size_t i = 0; i < colnames.size(); i++) {
+    if (colnames[i] == "GAMMA1" || colnames[i] == "KAPPA_E" || colnames[i] == "PIXEL") {
+      mapE = maps[i];
+    }
+    if (colnames[i] == "GAMMA2" || colnames[i] == "KAPPA_B" || colnames[i] == "WEIGHT") {
+      mapB = maps[i];
+    }
+  }
+  if (mapE.Npix() == 0 && mapB.Npix() != 0) {
+    // visibility mask with explicit indexing: the pixel indices of the full sky layout
+    mapE = Healpix_Map<double>(maps[0].Nside(), maps[0].Scheme(), SET_NSIDE);
+    for (int it = 0; it < mapE.Npix(); it++) {
+      mapE[it] = it;
+    }
+  }
   return std::pair<Healpix_Map<double>, Healpix_Map<double> > (mapE, mapB);
 }
 
@@ -0,0 +1,127 @@
+/**
+ * @file tests/src/AsyncWriter_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_UTILITIES/AsyncWriter.h"
+#include "ElementsKernel/Logging.h"
+#include "ElementsKernel/Exception.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+using namespace Euclid::WeakLensing::TwoDMass;
+
+static Elements::Logging logger = Elements::Logging::getLogger("AsyncWriter_test");
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (AsyncWriter_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Order_test ) {
+  std::vector<int> written;
+  AsyncWriter writer(3);
+  BOOST_CHECK_EQUAL(writer.getMaxPending(), 3);
+  for (int i = 0; i < 50; i++) {
+    // The task owns its buffer, the producer keeps computing
+    std::shared_ptr<std::vector<double> > buffer(new std::vector<double>(1000, i));
+    writer.submit([&written, buffer] {
+      written.push_back(static_cast<int>((*buffer)[999]));
+    });
+  }
+  writer.wait();
+  BOOST_CHECK_EQUAL(written.size(), 50);
+  for (int i = 0; i < 50; i++) {
+    BOOST_CHECK_EQUAL(written[i], i);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Bounded_test ) {
+  std::atomic<int> started(0);
+  std::atomic<bool> release(false);
+  AsyncWriter writer(1);
+  auto task = [&started, &release] {
+    started++;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+  writer.submit(task);
+  while (started == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // One task running and one waiting: the next submission blocks until the first one ends
+  writer.submit(task);
+  std::atomic<bool> submitted(false);
+  std::thread producer([&writer, &task, &submitted] {
+    writer.submit(task);
+    submitted = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK(submitted == false);
+  release = true;
+  producer.join();
+  writer.wait();
+  BOOST_CHECK(submitted == true);
+  BOOST_CHECK_EQUAL(started, 3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Error_test ) {
+  int nbRun = 0;
+  AsyncWriter writer;
+  writer.submit([] { throw Elements::Exception() << "write failed"; });
+  BOOST_CHECK_THROW(writer.wait(), Elements::Exception);
+  // The error is reported once, the writer keeps running
+  writer.submit([&nbRun] { nbRun++; });
+  writer.wait();
+  BOOST_CHECK_EQUAL(nbRun, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( Destructor_test ) {
+  int nbRun = 0;
+  {
+    AsyncWriter writer(4);
+    for (int i = 0; i < 4; i++) {
+      writer.submit([&nbRun] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        nbRun++;
+      });
+    }
+  }
+  // The pending tasks are run before the writer is destroyed
+  BOOST_CHECK_EQUAL(nbRun, 4);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,141 @@
+/**
+ * @file tests/src/CatalogCache_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_UTILITIES/CatalogCache.h"
+#include "ElementsKernel/Logging.h"
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Temporary.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace Euclid::WeakLensing::TwoDMass;
+
+static Elements::Logging logger = Elements::Logging::getLogger("CatalogCache_test");
+
+//-----------------------------------------------------------------------------
+
+struct CatalogCacheFixture {
+  CatalogCacheFixture()
+  {
+   // Assign arbiratary values to required fields
+   testCatData.resize(8);
+   for (int i = 0; i<= 36; i++) {
+    for (int j = 0; j<= 18; j++) {
+     testCatData[0].push_back(10. * i);
+     testCatData[1].push_back(10. * j);
+     testCatData[2].push_back(0.);
+     testCatData[3].push_back(i/90.);
+     testCatData[4].push_back(j/90.);
+     testCatData[5].push_back(0.5 * j);
+     testCatData[6].push_back(1.);
+     testCatData[7].push_back(1.);
+    }
+   }
+   cacheFilename = (tempDir.path() / "CatalogCache_test.cat").string();
+  }
+  ~CatalogCacheFixture ()
+  { }
+  Elements::TempDir tempDir;
+  std::string cacheFilename;
+  std::vector <std::vector <double> > testCatData;
+};
+
+//-----------------------------------------------------------------------------
+BOOST_FIXTURE_TEST_SUITE (CatalogCache_test, CatalogCacheFixture)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( writeReadCache_test ) {
+  CatalogCache::writeCache(cacheFilename, testCatData, "LENSMC");
+  BOOST_CHECK(CatalogCache::isCatalogCache(cacheFilename));
+
+  CatalogCache cache(cacheFilename);
+  BOOST_CHECK_EQUAL(cache.getNbRows(), testCatData[0].size());
+  BOOST_CHECK_EQUAL(cache.getNbColumns(), testCatData.size());
+  BOOST_CHECK_EQUAL(cache.getCatalogType(), "LENSMC");
+
+  for (size_t col = 0; col < testCatData.size(); col++) {
+    CatalogColumn column = cache.getColumn(col);
+    // Columns are mapped on page boundaries
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(column.data) % 64, 0u);
+    BOOST_CHECK_EQUAL_COLLECTIONS(column.begin(), column.end(), testCatData[col].begin(), testCatData[col].end());
+  }
+  BOOST_CHECK_THROW(cache.getColumn(testCatData.size()), Elements::Exception);
+
+  std::vector<std::vector<double> > data;
+  cache.getData(data);
+  BOOST_CHECK(data == testCatData);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( emptyColumn_test ) {
+  // Catalogs without weights have an empty weight column
+  testCatData[6].clear();
+  CatalogCache::writeCache(cacheFilename, testCatData, "KSB");
+  CatalogCache cache(cacheFilename);
+  BOOST_CHECK(cache.getColumn(6).empty());
+  BOOST_CHECK_EQUAL(cache.getColumn(7).size, testCatData[7].size());
+  BOOST_CHECK_EQUAL(cache.getCatalogType(), "KSB");
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( invalidCache_test ) {
+  std::string otherFilename = (tempDir.path() / "NotACache.txt").string();
+  std::ofstream other(otherFilename);
+  other << "this is not a catalog cache";
+  other.close();
+  BOOST_CHECK(CatalogCache::isCatalogCache(otherFilename) == false);
+  BOOST_CHECK_THROW(CatalogCache cache(otherFilename), Elements::Exception);
+  BOOST_CHECK_THROW(CatalogCache cache((tempDir.path() / "missing.cat").string()), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( columnSize_test ) {
+  // Non-empty columns must all hold the same number of rows
+  std::vector <std::vector <double> > shortData(testCatData);
+  shortData[3].pop_back();
+  BOOST_CHECK_THROW(CatalogCache::writeCache(cacheFilename, shortData, "LENSMC"), Elements::Exception);
+
+  // A cache announcing more rows than its columns hold is rejected: nbRows is the 64-bit field
+  // following the signature, the version and the number of columns
+  CatalogCache::writeCache(cacheFilename, testCatData, "LENSMC");
+  std::fstream file(cacheFilename, std::ios::in | std::ios::out | std::ios::binary);
+  const uint64_t nbRows = testCatData[0].size() + 1;
+  file.seekp(8 + 2*sizeof(uint32_t));
+  file.write(reinterpret_cast<const char*>(&nbRows), sizeof(nbRows));
+  file.close();
+  BOOST_CHECK(CatalogCache::isCatalogCache(cacheFilename));
+  BOOST_CHECK_THROW(CatalogCache cache(cacheFilename), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -25,6 +25,7 @@
 #include "ElementsKernel/Logging.h"
 #include "LE3_2D_MASS_WL_UTILITIES/CatalogData.h"
 #include "ElementsKernel/Auxiliary.h"
+#include "ElementsKernel/Exception.h"
 
 #include "ElementsServices/DataSync.h"
 
@@ -240,6 +241,85 @@ BOOST_AUTO_TEST_CASE( readShearCatalog_test ) {
 
 }
 //-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( readShearCatalogChunks_test ) {
+  logger.info() <<"-- CatalogData: readShearCatalogChunks_test";
+  std::vector<std::vector<double>> testCatData;
+  CatalogData cd;
+  cd.readShearCatalog(file_le2Cat.native(), testCatData);
+
+  // Read again by chunks of 7 rows and check the rows are the same
+  const long chunkRows = 7;
+  std::vector<std::vector<double>> chunkedCatData(testCatData.size());
+  long nextRow = 0;
+  long nRows = cd.readShearCatalogChunks(file_le2Cat.native(), chunkRows,
+                     [&](std::vector<std::vector<double> >& chunk, long firstRow) {
+    BOOST_CHECK_EQUAL(firstRow, nextRow);
+    BOOST_CHECK(long(chunk[0].size()) <= chunkRows);
+    for (size_t col = 0; col < chunk.size(); col++) {
+      chunkedCatData[col].insert(chunkedCatData[col].end(), chunk[col].begin(), chunk[col].end());
+    }
+    nextRow += chunk[0].size();
+  });
+
+  BOOST_CHECK_EQUAL(nRows, long(testCatData[0].size()));
+  BOOST_CHECK_EQUAL(nextRow, nRows);
+  for (size_t col = 0; col < testCatData.size(); col++) {
+    BOOST_CHECK_EQUAL_COLLECTIONS(chunkedCatData[col].begin(), chunkedCatData[col].end(),
+                                  testCatData[col].begin(), testCatData[col].end());
+  }
+  BOOST_CHECK_THROW(cd.readShearCatalogChunks(file_le2Cat.native(), 0,
+                    [](std::vector<std::vector<double> >&, long) {}), Elements::Exception);
+}
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( readShearCatalogColumns_test ) {
+  logger.info() <<"-- CatalogData: readShearCatalogColumns_test";
+  std::vector<std::vector<double>> testCatData;
+  CatalogData cd;
+  BOOST_CHECK_EQUAL(cd.getColumns(), (unsigned int)ALL_COLUMNS);
+  cd.readShearCatalog(file_le2Cat.native(), testCatData);
+
+  // Read only ra, dec, g1 and g2: the other columns must be left empty, the read ones unchanged
+  const unsigned int columns = RA_COLUMN | DEC_COLUMN | G1_COLUMN | G2_COLUMN;
+  std::vector<std::vector<double>> projectedCatData;
+  cd.setColumns(columns);
+  cd.readShearCatalog(file_le2Cat.native(), projectedCatData);
+  BOOST_CHECK_EQUAL(projectedCatData.size(), testCatData.size());
+  for (size_t col = 0; col < testCatData.size(); col++) {
+    if (columns & (1u << col)) {
+      BOOST_CHECK_EQUAL_COLLECTIONS(projectedCatData[col].begin(), projectedCatData[col].end(),
+                                    testCatData[col].begin(), testCatData[col].end());
+    } else {
+      BOOST_CHECK(projectedCatData[col].empty());
+    }
+  }
+
+  // Same by chunks
+  cd.readShearCatalogChunks(file_le2Cat.native(), 7, [&](std::vector<std::vector<double> >& chunk, long) {
+    BOOST_CHECK(chunk[2].empty() && chunk[5].empty() && chunk[6].empty() && chunk[7].empty());
+    BOOST_CHECK(chunk[0].size() == chunk[3].size());
+  });
+}
+//-----------------------------------------------------------------------------
+BOOST_AUTO_TEST_CASE( readShearCatalogTyped_test ) {
+  logger.info() <<"-- CatalogData: readShearCatalogTyped_test";
+  std::vector<std::vector<double>> testCatData;
+  CatalogData cd;
+  cd.readShearCatalog(file_le2Cat.native(), testCatData);
+
+  // Column-wise catalog in double and float precision
+  ShearCatalog<double> catalog;
+  cd.readShearCatalog(file_le2Cat.native(), catalog);
+  BOOST_CHECK_EQUAL(catalog.size(), testCatData[0].size());
+  ShearCatalog<float> floatCatalog;
+  cd.readShearCatalog(file_le2Cat.native(), floatCatalog);
+  BOOST_CHECK_EQUAL(floatCatalog.getColumns(), catalog.getColumns());
+  for (size_t i = 0; i < catalog.size(); i++) {
+    BOOST_CHECK_EQUAL(catalog.view().g1(i), testCatData[3][i]);
+    BOOST_CHECK_EQUAL(catalog.view().kappa(i), testCatData[2][i]);
+    BOOST_CHECK_EQUAL(floatCatalog.view().ra(i), float(testCatData[0][i]));
+  }
+}
+//-----------------------------------------------------------------------------
 BOOST_AUTO_TEST_CASE( readClusterCatalog_test ) {
   logger.info() <<"-- CatalogData: readClusterCatalog_test";
   try
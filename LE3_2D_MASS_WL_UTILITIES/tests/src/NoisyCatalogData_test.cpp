@@ -102,4 +102,29 @@ BOOST_AUTO_TEST_CASE( createNoisyData_test ) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE( createNoisyDataView_test ) {
+  logger.info() << "-- NoisyCatalogData: createNoisyDataView";
+  NoisyCatalogData nData;
+  ShearCatalogView<double> catView = makeShearCatalogView(testCatData);
+
+  // Same seed: the view version gives the same realisation as the vector version
+  srand(42);
+  std::vector<std::vector<double> > testNoisyData = nData.create_noisy_data(testCatData);
+  srand(42);
+  ShearCatalog<double> noisyShear;
+  ShearCatalogView<double> noisyView = nData.create_noisy_data(catView, noisyShear);
+
+  BOOST_CHECK_EQUAL(noisyView.size(), testCatData[0].size());
+  BOOST_CHECK_EQUAL(noisyShear.getColumns(), (unsigned int)(G1_COLUMN | G2_COLUMN));
+  // the other columns are shared with the input catalog, not copied
+  BOOST_CHECK(noisyView.data(RA_COLUMN) == testCatData[0].data());
+  BOOST_CHECK(noisyView.data(G1_COLUMN) == noisyShear.column(G1_COLUMN).data());
+  for (size_t i = 0; i < noisyView.size(); i++) {
+    BOOST_CHECK_EQUAL(noisyView.g1(i), testNoisyData[3][i]);
+    BOOST_CHECK_EQUAL(noisyView.g2(i), testNoisyData[4][i]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
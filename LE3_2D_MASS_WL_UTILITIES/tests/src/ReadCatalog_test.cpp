@@ -25,6 +25,7 @@
 #include "ElementsKernel/Logging.h"
 #include "LE3_2D_MASS_WL_UTILITIES/ReadCatalog.h"
 #include "ElementsKernel/Auxiliary.h"
+#include "ElementsKernel/Temporary.h"
 #include "ElementsServices/DataSync.h"
 
 #include <ios>
@@ -186,6 +187,47 @@ BOOST_AUTO_TEST_CASE( getCatalogReadType_test ) {
 }
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE( readShearCatalogChunksCache_test ) {
+  logger.info() << "-- ReadCatalog: readShearCatalogChunksCache_test";
+  // catalog cache of 10 rows without weights in workdir/data
+  Elements::TempDir workdir;
+  fs::create_directories(workdir.path() / "data");
+  fs::path cacheName("catalog.cache");
+  std::vector<std::vector<double> > catData(8);
+  for (size_t i = 0; i < 10; i++) {
+    for (size_t col = 0; col < catData.size(); col++) {
+      catData[col].push_back(double(10*col + i));
+    }
+  }
+  catData[6].clear();
+  CatalogCache::writeCache((workdir.path() / "data" / cacheName).string(), catData, "KSB");
+
+  // chunks of 4 rows of the positions, shear and weights: the weights missing from the cache are 0
+  ReadCatalog read;
+  read.setColumns(RA_COLUMN | DEC_COLUMN | G1_COLUMN | G2_COLUMN | WEIGHT_COLUMN);
+  std::vector<std::vector<double> > chunkData(8);
+  std::vector<long> firstRows;
+  fs::path workdirPath = workdir.path();
+  long nRows = read.readShearCatalogChunks(workdirPath, cacheName, 4,
+                          [&](std::vector<std::vector<double> >& chunk, long firstRow) {
+    BOOST_CHECK(chunk[0].size() <= 4);
+    BOOST_CHECK(chunk[5].empty());
+    for (size_t col = 0; col < chunk.size(); col++) {
+      chunkData[col].insert(chunkData[col].end(), chunk[col].begin(), chunk[col].end());
+    }
+    firstRows.push_back(firstRow);
+  });
+  BOOST_CHECK_EQUAL(nRows, 10);
+  BOOST_CHECK(firstRows == std::vector<long>({0, 4, 8}));
+  BOOST_CHECK_EQUAL(read.getCatalogReadType(), "KSB");
+  for (size_t col : {0, 1, 3, 4}) {
+    BOOST_CHECK(chunkData[col] == catData[col]);
+  }
+  BOOST_CHECK(chunkData[6] == std::vector<double>(10, 0.));
+  BOOST_CHECK(chunkData[2].empty() && chunkData[7].empty());
+}
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_CASE( readShearCatalogXMLException_test ) {
   logger.info() << "-- ReadCatalog: readShearCatalogXMLException_test";
     // Retrieve fits file directory location and filemane
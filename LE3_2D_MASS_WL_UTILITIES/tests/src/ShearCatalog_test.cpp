@@ -0,0 +1,145 @@
+/**
+ * @file tests/src/ShearCatalog_test.cpp
+ * @date 10/18/26
+ * @author user
+ *
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "LE3_2D_MASS_WL_UTILITIES/ShearCatalog.h"
+#include "ElementsKernel/Logging.h"
+#include "ElementsKernel/Exception.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace Euclid::WeakLensing::TwoDMass;
+
+static Elements::Logging logger = Elements::Logging::getLogger("ShearCatalog_test");
+
+//-----------------------------------------------------------------------------
+
+struct ShearCatalogFixture {
+  ShearCatalogFixture()
+  {
+   // Assign arbiratary values to required fields, without kappa and correction
+   testCatData.resize(8);
+   for (int i = 0; i<= 36; i++) {
+    for (int j = 0; j<= 18; j++) {
+     testCatData[0].push_back(10. * i);
+     testCatData[1].push_back(10. * j);
+     testCatData[3].push_back(i/90.);
+     testCatData[4].push_back(j/90.);
+     testCatData[5].push_back(0.5 * j);
+     testCatData[6].push_back(2.);
+    }
+   }
+  }
+  ~ShearCatalogFixture ()
+  { }
+  std::vector<std::vector<double> > testCatData;
+};
+
+//-----------------------------------------------------------------------------
+BOOST_FIXTURE_TEST_SUITE (ShearCatalog_test, ShearCatalogFixture)
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( fromVectors_test ) {
+  logger.info() << "-- ShearCatalog: fromVectors_test";
+  ShearCatalog<double> catalog(testCatData);
+  BOOST_CHECK_EQUAL(catalog.size(), testCatData[0].size());
+  BOOST_CHECK_EQUAL(catalog.getColumns(), (unsigned int)(RA_COLUMN | DEC_COLUMN | G1_COLUMN | G2_COLUMN |
+                                                         Z_COLUMN | WEIGHT_COLUMN));
+  BOOST_CHECK(catalog.hasColumn(KAPPA_COLUMN) == false);
+  BOOST_CHECK_THROW(catalog.column(KAPPA_COLUMN), Elements::Exception);
+
+  // Absent columns cost nothing and read as their default values
+  ShearCatalog<double>::View view = catalog.view();
+  BOOST_CHECK(view.data(KAPPA_COLUMN) == nullptr);
+  BOOST_CHECK(view.data(CORRECTION_COLUMN) == nullptr);
+  for (size_t i = 0; i < view.size(); i++) {
+    BOOST_CHECK_EQUAL(view.ra(i), testCatData[0][i]);
+    BOOST_CHECK_EQUAL(view.g2(i), testCatData[4][i]);
+    BOOST_CHECK_EQUAL(view.weight(i), 2.);
+    BOOST_CHECK_EQUAL(view.kappa(i), 0.);
+    BOOST_CHECK_EQUAL(view.correction(i), 1.);
+  }
+
+  // Back to vectors, the absent columns being empty
+  std::vector<std::vector<double> > data;
+  catalog.getData(data);
+  BOOST_CHECK_EQUAL(data.size(), testCatData.size());
+  for (size_t col = 0; col < data.size(); col++) {
+    BOOST_CHECK_EQUAL_COLLECTIONS(data[col].begin(), data[col].end(),
+                                  testCatData[col].begin(), testCatData[col].end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( alignedFloat_test ) {
+  logger.info() << "-- ShearCatalog: alignedFloat_test";
+  ShearCatalog<float> catalog(testCatData);
+  for (size_t i = 0; i < ShearCatalog<float>::nbColumns; i++) {
+    ShearColumns column = ShearColumns(1u << i);
+    if (catalog.hasColumn(column)) {
+      BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(catalog.column(column).data()) % 64, 0u);
+    }
+  }
+  BOOST_CHECK_CLOSE(catalog.view().g1(100), float(testCatData[3][100]), 1e-5);
+
+  catalog.addColumn(CORRECTION_COLUMN, 1.f);
+  BOOST_CHECK(catalog.hasColumn(CORRECTION_COLUMN));
+  BOOST_CHECK_EQUAL(catalog.column(CORRECTION_COLUMN).size(), catalog.size());
+  catalog.removeColumn(CORRECTION_COLUMN);
+  BOOST_CHECK(catalog.view().data(CORRECTION_COLUMN) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( viewSelect_test ) {
+  logger.info() << "-- ShearCatalog: viewSelect_test";
+  ShearCatalog<double> catalog(testCatData);
+
+  // Views on contiguous rows point into the catalog
+  ShearCatalog<double>::View view = catalog.view(100, 50);
+  BOOST_CHECK_EQUAL(view.size(), 50u);
+  BOOST_CHECK(view.data(Z_COLUMN) == catalog.column(Z_COLUMN).data() + 100);
+  ShearCatalog<double>::View slice = view.slice(10, 5);
+  BOOST_CHECK_EQUAL(slice.dec(0), testCatData[1][110]);
+  BOOST_CHECK_THROW(catalog.view(catalog.size() - 1, 2), Elements::Exception);
+
+  // Selected rows are gathered in the given order
+  std::vector<size_t> rows = {5, 3, 600};
+  ShearCatalog<double> selection = catalog.select(rows);
+  BOOST_CHECK_EQUAL(selection.size(), rows.size());
+  BOOST_CHECK_EQUAL(selection.getColumns(), catalog.getColumns());
+  for (size_t i = 0; i < rows.size(); i++) {
+    BOOST_CHECK_EQUAL(selection.view().g1(i), testCatData[3][rows[i]]);
+    BOOST_CHECK_EQUAL(selection.view().z(i), testCatData[5][rows[i]]);
+  }
+
+  // The legacy vectors are viewed without copy
+  ShearCatalogView<double> vectorView = makeShearCatalogView(testCatData);
+  BOOST_CHECK_EQUAL(vectorView.size(), catalog.size());
+  BOOST_CHECK(vectorView.data(G1_COLUMN) == testCatData[3].data());
+  BOOST_CHECK(vectorView.data(KAPPA_COLUMN) == nullptr);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()